@@ -0,0 +1,335 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using System.Reactive.Linq;
+using System.Reactive.Subjects;
+using System.Text;
+using System.Threading;
+using DmdExt.Common;
+using LibDmd;
+using LibDmd.Common;
+using LibDmd.Converter;
+using LibDmd.Converter.Vni;
+using LibDmd.DmdDevice;
+using LibDmd.Frame;
+using LibDmd.Input;
+using LibDmd.Input.FileSystem;
+using LibDmd.Input.Passthrough;
+using LibDmd.Output;
+using NLog;
+
+namespace DmdExt.Bench
+{
+	/// <summary>
+	/// Feeds frames through a render graph with destinations that don't
+	/// display anything, and measures how fast that goes.
+	/// </summary>
+	///
+	/// <remarks>
+	/// Frames are loaded into memory before measuring, and the graph runs on
+	/// the calling thread, so the numbers only include the render graph, the
+	/// colorizer and the frame conversions. No window or device is needed.
+	///
+	/// Colorizers that normally get frames from a 60Hz clock, like VNI, are
+	/// clocked once per fed frame instead, so their output is measured too.
+	/// </remarks>
+	class BenchCommand
+	{
+		private readonly IConfiguration _config;
+		private readonly BenchOptions _options;
+
+		private static readonly Logger Logger = LogManager.GetCurrentClassLogger();
+
+		public BenchCommand(IConfiguration config, BenchOptions options)
+		{
+			_config = config;
+			_options = options;
+			Analytics.Instance.Disable(false);
+		}
+
+		/// <summary>
+		/// Runs the benchmark and prints the results.
+		/// </summary>
+		/// <returns>Exit code</returns>
+		public int Run()
+		{
+			AppDomain.MonitoringIsEnabled = true;
+
+			var frames = LoadFrames(out var gameName);
+			if (frames.Count == 0) {
+				Logger.Error("No frames to feed.");
+				return 1;
+			}
+
+			var destinations = _options.Outputs.Split(',').Select(name => BenchDestination.Create(name, _options.Hd)).ToList();
+			var lastFrameFormat = new BehaviorSubject<FrameFormat>(FrameFormat.Gray2);
+			ISource source;
+			Action<DmdFrame> feed;
+			if (frames[0].BitLength == 2) {
+				var gray2Source = new PassthroughGray2Source(lastFrameFormat, "Bench Source");
+				source = gray2Source;
+				feed = gray2Source.NextFrame;
+			} else {
+				var gray4Source = new PassthroughGray4Source(lastFrameFormat, "Bench Source");
+				source = gray4Source;
+				feed = gray4Source.NextFrame;
+			}
+
+			var converter = LoadColorizer(gameName);
+			var graph = new RenderGraph(new UndisposedReferences(), true) {
+				Name = "Bench",
+				Source = source,
+				Destinations = destinations.Cast<IDestination>().ToList(),
+				Converter = converter,
+				ScalerMode = _config.Global.ScalerMode,
+			};
+
+			// otherwise the converter would only store the frame and render it later on its own clock.
+			if (converter != null && converter.NeedsDuplicateFrames) {
+				converter.StopClock();
+				var feedSource = feed;
+				feed = frame => {
+					feedSource(frame);
+					converter.Tick();
+				};
+			}
+
+			var total = new LatencyRecorder();
+			BenchResult result;
+			graph.StartRendering(() => { }, e => Logger.Error(e, "Error rendering frame: {0}", e.Message));
+			try {
+				Feed(frames, _options.Warmup, feed, destinations, total);
+
+				total.Reset(_options.Frames);
+				destinations.ForEach(d => d.Latency.Reset(_options.Frames));
+				GC.Collect();
+				GC.WaitForPendingFinalizers();
+				GC.Collect();
+				Profiler.Reset();
+
+				var allocatedBefore = AppDomain.CurrentDomain.MonitoringTotalAllocatedMemorySize;
+				var collectionsBefore = Enumerable.Range(0, 3).Select(GC.CollectionCount).ToArray();
+				var elapsed = Feed(frames, _options.Frames, feed, destinations, total);
+				var allocated = AppDomain.CurrentDomain.MonitoringTotalAllocatedMemorySize - allocatedBefore;
+				var collections = Enumerable.Range(0, 3).Select(gen => GC.CollectionCount(gen) - collectionsBefore[gen]).ToArray();
+
+				result = new BenchResult {
+					Frames = _options.Frames,
+					Elapsed = elapsed,
+					BytesPerFrame = (double)allocated / _options.Frames,
+					Collections = collections,
+					Total = total,
+					Destinations = destinations,
+				};
+
+			} finally {
+				graph.Dispose();
+			}
+
+			var output = _options.Json ? ToJson(result, gameName) : ToText(result);
+			Console.WriteLine(output);
+			if (_options.OutputFile != null) {
+				File.WriteAllText(_options.OutputFile, output);
+			}
+			return 0;
+		}
+
+		/// <summary>
+		/// Feeds a number of frames, looping through the loaded ones.
+		/// </summary>
+		/// <returns>How long it took</returns>
+		private TimeSpan Feed(List<DmdFrame> frames, int count, Action<DmdFrame> feed, List<BenchDestination> destinations, LatencyRecorder total)
+		{
+			var interval = _options.Hz > 0 ? Stopwatch.Frequency / _options.Hz : 0;
+			var started = Stopwatch.GetTimestamp();
+			for (var i = 0; i < count; i++) {
+				if (interval > 0) {
+					WaitUntil(started + i * interval);
+				}
+				var frameStarted = Stopwatch.GetTimestamp();
+				foreach (var dest in destinations) {
+					dest.FrameStarted = frameStarted;
+				}
+				feed(frames[i % frames.Count]);
+				total.Add(Stopwatch.GetTimestamp() - frameStarted);
+			}
+			return TimeSpan.FromSeconds((double)(Stopwatch.GetTimestamp() - started) / Stopwatch.Frequency);
+		}
+
+		private static void WaitUntil(long timestamp)
+		{
+			while (true) {
+				var remaining = timestamp - Stopwatch.GetTimestamp();
+				if (remaining <= 0) {
+					return;
+				}
+				if (remaining * 1000 / Stopwatch.Frequency > 2) {
+					Thread.Sleep(1);
+				} else {
+					Thread.SpinWait(50);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Loads the frames to feed into memory, either from a dump or generated.
+		/// </summary>
+		private List<DmdFrame> LoadFrames(out string gameName)
+		{
+			var count = _options.Frames + _options.Warmup;
+			if (_options.FileName == null) {
+				gameName = null;
+				var random = new Random(42);
+				var frames = new List<DmdFrame>();
+				for (var i = 0; i < Math.Min(count, 100); i++) {
+					var data = new byte[128 * 32];
+					for (var j = 0; j < data.Length; j++) {
+						data[j] = (byte)random.Next(1 << _options.BitLength);
+					}
+					frames.Add(new DmdFrame(new Dimensions(128, 32), data, _options.BitLength));
+				}
+				Logger.Info("Generated {0} random {1}-bit frames.", frames.Count, _options.BitLength);
+				return frames;
+			}
+
+			if (!File.Exists(_options.FileName)) {
+				throw new FileNotFoundException($"File {_options.FileName} does not exist.");
+			}
+
+			if (DumpReader.IsDump(_options.FileName)) {
+				using (var reader = new DumpReader(_options.FileName)) {
+					gameName = reader.GameName;
+
+					// feed the bit length most frames have, since the source only provides one.
+					var bitLength = Enumerable.Range(0, reader.Count)
+						.GroupBy(reader.GetBitLength)
+						.OrderByDescending(g => g.Count())
+						.Select(g => g.Key)
+						.FirstOrDefault();
+					var frames = new List<DmdFrame>();
+					for (var i = 0; i < reader.Count && frames.Count < count; i++) {
+						if (reader.GetBitLength(i) == bitLength) {
+							frames.Add(reader.ReadFrame(i, new DmdFrame()));
+						}
+					}
+					Logger.Info("Loaded {0} {1}-bit frames from {2}.", frames.Count, bitLength, _options.FileName);
+					return frames;
+				}
+			}
+
+			var dumpSource = new DumpSource(_options.FileName, default, false);
+			string dumpGameName = null;
+			using (dumpSource.GetGameName().Subscribe(name => dumpGameName = name)) {
+				var frames = dumpSource.GetGray2Frames(false, false)
+					.Take(count)
+					.Select(frame => frame.CloneFrame())
+					.ToList()
+					.Wait()
+					.ToList();
+				gameName = dumpGameName;
+				Logger.Info("Loaded {0} frames from {1}.", frames.Count, _options.FileName);
+				return frames;
+			}
+		}
+
+		private AbstractConverter LoadColorizer(string gameName)
+		{
+			if (_options.Colorizer == BenchColorizer.None) {
+				return null;
+			}
+			var name = _options.Game ?? gameName;
+			if (name == null) {
+				throw new InvalidOptionException("Colorizing needs a game name, use --game.");
+			}
+
+			var loader = _options.AltColorPath != null ? new ColorizationLoader(_options.AltColorPath) : new ColorizationLoader();
+			var colorizer = _options.Colorizer == BenchColorizer.Serum
+				? loader.LoadSerum(name, _config.Global.ScalerMode)
+				: loader.LoadVniColorizer(name, _config.Global.ScalerMode, _config.Global.VniKey);
+			if (colorizer == null) {
+				throw new InvalidOptionException($"Could not load {_options.Colorizer} colorization for {name}.");
+			}
+			return colorizer;
+		}
+
+		private string ToText(BenchResult result)
+		{
+			var sb = new StringBuilder();
+			sb.AppendLine($"Rendered {result.Frames} frames in {result.Elapsed.TotalMilliseconds:0.0}ms ({result.FramesPerSecond:0.0} fps).");
+			sb.AppendLine($"{"Latency (ms)",-22}{"avg",9}{"p50",9}{"p90",9}{"p99",9}{"max",9}");
+			AppendLatency(sb, "Total", result.Total);
+			foreach (var dest in result.Destinations) {
+				AppendLatency(sb, dest.Name, dest.Latency);
+			}
+			if (Profiler.Enabled) {
+				sb.AppendLine($"{"Stages (ms)",-40}{"avg",9}{"p50",9}{"p99",9}{"max",9}");
+				foreach (var stage in Profiler.Snapshot()) {
+					sb.AppendLine($"{stage.Name,-40}{stage.MeanMs,9:0.000}{stage.PercentileMs(50),9:0.000}{stage.PercentileMs(99),9:0.000}{stage.MaxMs,9:0.000}");
+				}
+			}
+			sb.AppendLine($"Allocated {result.BytesPerFrame:0} bytes per frame.");
+			sb.Append($"Garbage collections: gen0 {result.Collections[0]}, gen1 {result.Collections[1]}, gen2 {result.Collections[2]}.");
+			return sb.ToString();
+		}
+
+		private static void AppendLatency(StringBuilder sb, string name, LatencyRecorder latency)
+		{
+			if (latency.Count == 0) {
+				sb.AppendLine($"{name,-22}{"no frames",9}");
+				return;
+			}
+			sb.AppendLine($"{name,-22}{latency.Average(),9:0.000}{latency.Percentile(50),9:0.000}{latency.Percentile(90),9:0.000}{latency.Percentile(99),9:0.000}{latency.Percentile(100),9:0.000}");
+		}
+
+		private string ToJson(BenchResult result, string gameName)
+		{
+			var c = CultureInfo.InvariantCulture;
+			var sb = new StringBuilder();
+			sb.Append("{");
+			sb.Append($"\"source\":{JsonString(_options.FileName ?? $"generated:gray{_options.BitLength}")},");
+			sb.Append($"\"game\":{JsonString(_options.Game ?? gameName)},");
+			sb.Append($"\"colorizer\":{JsonString(_options.Colorizer.ToString().ToLowerInvariant())},");
+			sb.Append($"\"scalerMode\":{JsonString(_config.Global.ScalerMode.ToString().ToLowerInvariant())},");
+			sb.Append($"\"hd\":{(_options.Hd ? "true" : "false")},");
+			sb.Append(string.Format(c, "\"hz\":{0},", _options.Hz));
+			sb.Append(string.Format(c, "\"frames\":{0},", result.Frames));
+			sb.Append(string.Format(c, "\"elapsedMs\":{0:0.###},", result.Elapsed.TotalMilliseconds));
+			sb.Append(string.Format(c, "\"fps\":{0:0.###},", result.FramesPerSecond));
+			sb.Append(string.Format(c, "\"bytesPerFrame\":{0:0.#},", result.BytesPerFrame));
+			sb.Append(string.Format(c, "\"gc\":[{0},{1},{2}],", result.Collections[0], result.Collections[1], result.Collections[2]));
+			sb.Append("\"latency\":{");
+			sb.Append($"{JsonString("total")}:{JsonLatency(result.Total)}");
+			foreach (var dest in result.Destinations) {
+				sb.Append($",{JsonString(dest.Name)}:{JsonLatency(dest.Latency)}");
+			}
+			sb.Append("}}");
+			return sb.ToString();
+		}
+
+		private static string JsonLatency(LatencyRecorder latency)
+		{
+			return string.Format(CultureInfo.InvariantCulture, "{{\"count\":{0},\"avg\":{1:0.####},\"p50\":{2:0.####},\"p90\":{3:0.####},\"p99\":{4:0.####},\"max\":{5:0.####}}}",
+				latency.Count, latency.Average(), latency.Percentile(50), latency.Percentile(90), latency.Percentile(99), latency.Percentile(100));
+		}
+
+		private static string JsonString(string value)
+		{
+			return value == null ? "null" : "\"" + value.Replace("\\", "\\\\").Replace("\"", "\\\"") + "\"";
+		}
+
+		private class BenchResult
+		{
+			public int Frames;
+			public TimeSpan Elapsed;
+			public double BytesPerFrame;
+			public int[] Collections;
+			public LatencyRecorder Total;
+			public List<BenchDestination> Destinations;
+
+			public double FramesPerSecond => Frames / Elapsed.TotalSeconds;
+		}
+	}
+}
@@ -0,0 +1,147 @@
+﻿using System.Diagnostics;
+using System.IO;
+using System.Windows.Media;
+using DmdExt.Common;
+using LibDmd;
+using LibDmd.Frame;
+using LibDmd.Output;
+using LibDmd.Output.FileOutput;
+
+namespace DmdExt.Bench
+{
+	/// <summary>
+	/// A destination that doesn't display anything but records when frames
+	/// arrive, so the bench can measure how long the render graph took to
+	/// get them there.
+	/// </summary>
+	abstract class BenchDestination : IFixedSizeDestination
+	{
+		public abstract string Name { get; }
+		public bool IsAvailable => true;
+		public bool NeedsDuplicateFrames => true;
+		public bool NeedsIdentificationFrames => false;
+
+		public Dimensions FixedSize { get; }
+		public bool DmdAllowHdScaling { get; }
+
+		/// <summary>
+		/// Timestamp of when the current frame was fed to the source.
+		/// </summary>
+		public long FrameStarted;
+
+		/// <summary>
+		/// Ticks between feeding and rendering, per measured frame.
+		/// </summary>
+		public readonly LatencyRecorder Latency = new LatencyRecorder();
+
+		protected BenchDestination(bool hd)
+		{
+			FixedSize = hd ? new Dimensions(256, 64) : new Dimensions(128, 32);
+			DmdAllowHdScaling = hd;
+		}
+
+		protected void Received()
+		{
+			Latency.Add(Stopwatch.GetTimestamp() - FrameStarted);
+		}
+
+		public void ClearDisplay() { }
+		public void SetColor(Color color) { }
+		public void ClearColor() { }
+		public void SetPalette(Color[] colors) { }
+		public void ClearPalette() { }
+		public virtual void Dispose() { }
+
+		/// <summary>
+		/// Creates a destination by name, as given on the command line.
+		/// </summary>
+		public static BenchDestination Create(string name, bool hd)
+		{
+			switch (name.Trim().ToLowerInvariant()) {
+				case "gray2": return new BenchGray2Destination(hd);
+				case "gray4": return new BenchGray4Destination(hd);
+				case "rgb24": return new BenchRgb24Destination(hd);
+				case "rgb565": return new BenchRgb565Destination(hd);
+				case "coloredgray4": return new BenchColoredGray4Destination(hd);
+				case "coloredgray6": return new BenchColoredGray6Destination(hd);
+				case "record": return new BenchRecordingDestination(hd);
+				default: throw new InvalidOptionException($"Unknown output \"{name}\".");
+			}
+		}
+	}
+
+	class BenchGray2Destination : BenchDestination, IGray2Destination
+	{
+		public override string Name => "Bench[Gray2]";
+		public BenchGray2Destination(bool hd) : base(hd) { }
+		public void RenderGray2(DmdFrame frame) => Received();
+	}
+
+	class BenchGray4Destination : BenchDestination, IGray4Destination
+	{
+		public override string Name => "Bench[Gray4]";
+		public BenchGray4Destination(bool hd) : base(hd) { }
+		public void RenderGray4(DmdFrame frame) => Received();
+	}
+
+	class BenchRgb24Destination : BenchDestination, IRgb24Destination
+	{
+		public override string Name => "Bench[RGB24]";
+		public BenchRgb24Destination(bool hd) : base(hd) { }
+		public void RenderRgb24(DmdFrame frame) => Received();
+	}
+
+	class BenchRgb565Destination : BenchDestination, IRgb565Destination
+	{
+		public override string Name => "Bench[RGB565]";
+		public BenchRgb565Destination(bool hd) : base(hd) { }
+		public void RenderRgb565(DmdFrame frame) => Received();
+	}
+
+	class BenchColoredGray4Destination : BenchDestination, IColoredGray4Destination
+	{
+		public override string Name => "Bench[ColoredGray4]";
+		public BenchColoredGray4Destination(bool hd) : base(hd) { }
+		public void RenderColoredGray4(ColoredFrame frame) => Received();
+		public void RenderRgb24(DmdFrame frame) => Received();
+	}
+
+	class BenchColoredGray6Destination : BenchDestination, IColoredGray6Destination
+	{
+		public override string Name => "Bench[ColoredGray6]";
+		public BenchColoredGray6Destination(bool hd) : base(hd) { }
+		public void RenderColoredGray6(ColoredFrame frame) => Received();
+		public void RenderRgb24(DmdFrame frame) => Received();
+	}
+
+	/// <summary>
+	/// Writes frames into a binary dump in the temp folder, which is deleted afterwards.
+	/// </summary>
+	class BenchRecordingDestination : BenchDestination, IGray2Destination, IGray4Destination
+	{
+		public override string Name => "Bench[Record]";
+
+		private readonly string _path = Path.GetTempFileName();
+		private readonly DumpWriter _writer;
+
+		public BenchRecordingDestination(bool hd) : base(hd)
+		{
+			_writer = new DumpWriter(_path, "bench", true);
+		}
+
+		public void RenderGray2(DmdFrame frame) => Record(frame);
+		public void RenderGray4(DmdFrame frame) => Record(frame);
+
+		private void Record(DmdFrame frame)
+		{
+			_writer.Write(frame);
+			Received();
+		}
+
+		public override void Dispose()
+		{
+			_writer.Dispose();
+			File.Delete(_path);
+		}
+	}
+}
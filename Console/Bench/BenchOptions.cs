@@ -0,0 +1,66 @@
+﻿using CommandLine;
+using DmdExt.Common;
+
+namespace DmdExt.Bench
+{
+	class BenchOptions : BaseOptions
+	{
+		[Option('f', "file", HelpText = "Frame dump to feed (TXT or DMDREC). If not set, random frames are generated.")]
+		public string FileName { get; set; }
+
+		[Option("format", HelpText = "Bit length of generated frames. One of: [ 2, 4 ]. Default: 4.")]
+		public int BitLength { get; set; } = 4;
+
+		[Option("frames", HelpText = "Number of frames to measure. Default: 5000.")]
+		public int Frames { get; set; } = 5000;
+
+		[Option("warmup", HelpText = "Number of frames to render before measuring. Default: 200.")]
+		public int Warmup { get; set; } = 200;
+
+		[Option("hz", HelpText = "Frames per second to feed. 0 feeds as fast as possible. Default: 0.")]
+		public int Hz { get; set; } = 0;
+
+		[Option("colorizer", HelpText = "Colorizer to run frames through. One of: [ none, vni, serum ]. Default: none.")]
+		public BenchColorizer Colorizer { get; set; } = BenchColorizer.None;
+
+		[Option("altcolor", HelpText = "Folder containing the colorization folders. Default: VPM's altcolor folder.")]
+		public string AltColorPath { get; set; }
+
+		[Option("game", HelpText = "Game name of the colorization. Default: the game name of the dump.")]
+		public string Game { get; set; }
+
+		[Option("outputs", HelpText = "Comma-separated destinations to render to. Any of: [ gray2, gray4, rgb24, rgb565, coloredgray4, coloredgray6, record ]. Default: rgb24.")]
+		public string Outputs { get; set; } = "rgb24";
+
+		[Option("hd", HelpText = "If set, destinations are 256x64 and allow HD scaling. Default: false.")]
+		public bool Hd { get; set; }
+
+		[Option("json", HelpText = "If set, print results as JSON.")]
+		public bool Json { get; set; }
+
+		[Option("out", HelpText = "Also write the results to this file.")]
+		public string OutputFile { get; set; }
+
+		[ParserState]
+		public IParserState LastParserState { get; set; }
+
+		public new void Validate()
+		{
+			base.Validate();
+			if (BitLength != 2 && BitLength != 4) {
+				throw new InvalidOptionException("Argument --format must be 2 or 4.");
+			}
+			if (Frames <= 0) {
+				throw new InvalidOptionException("Argument --frames must be larger than 0.");
+			}
+			if (Hz < 0) {
+				throw new InvalidOptionException("Argument --hz must not be negative.");
+			}
+		}
+	}
+
+	public enum BenchColorizer
+	{
+		None, Vni, Serum
+	}
+}
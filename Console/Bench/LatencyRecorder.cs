@@ -0,0 +1,64 @@
+﻿using System;
+using System.Diagnostics;
+
+namespace DmdExt.Bench
+{
+	/// <summary>
+	/// Collects latencies into a preallocated buffer, so recording them
+	/// doesn't allocate while measuring.
+	/// </summary>
+	class LatencyRecorder
+	{
+		public int Count { get; private set; }
+
+		private long[] _ticks = new long[0];
+
+		/// <summary>
+		/// Discards all samples and makes room for the given number of new ones.
+		/// </summary>
+		public void Reset(int capacity)
+		{
+			if (_ticks.Length < capacity) {
+				_ticks = new long[capacity];
+			}
+			Count = 0;
+		}
+
+		public void Add(long ticks)
+		{
+			if (Count < _ticks.Length) {
+				_ticks[Count++] = ticks;
+			}
+		}
+
+		/// <summary>
+		/// Returns the latency below which the given share of samples are, in milliseconds.
+		/// </summary>
+		/// <param name="percentile">Between 0 and 100</param>
+		public double Percentile(double percentile)
+		{
+			if (Count == 0) {
+				return 0;
+			}
+			var sorted = new long[Count];
+			Array.Copy(_ticks, sorted, Count);
+			Array.Sort(sorted);
+			var index = (int)Math.Ceiling(percentile / 100 * Count) - 1;
+			return TicksToMs(sorted[Math.Max(0, Math.Min(Count - 1, index))]);
+		}
+
+		public double Average()
+		{
+			if (Count == 0) {
+				return 0;
+			}
+			double total = 0;
+			for (var i = 0; i < Count; i++) {
+				total += _ticks[i];
+			}
+			return TicksToMs(total / Count);
+		}
+
+		private static double TicksToMs(double ticks) => ticks * 1000 / Stopwatch.Frequency;
+	}
+}
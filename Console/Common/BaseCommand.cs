@@ -219,7 +219,7 @@ namespace DmdExt.Common
 			if (config.RawOutput.Enabled) {
 				try {
 					Logger.Info("Added raw output renderer (a.k.a. frame dumper).");
-					var rawOutput = new RawOutput();
+					var rawOutput = new RawOutput(config.RawOutput.Format, config.RawOutput.Compress);
 					renderers.Add(rawOutput);
 					reportingTags.Add("Out:RawOutput");
 					Analytics.Instance.AddDestination(rawOutput);
@@ -3,6 +3,7 @@ using CommandLine;
 using LibDmd.Common;
 using LibDmd.DmdDevice;
 using LibDmd.Input;
+using LibDmd.Output.FileOutput;
 using LibDmd.Output.Virtual.AlphaNumeric;
 using LibDmd.Output.Virtual.Dmd;
 using LibDmd.Output.ZeDMD;
@@ -110,6 +111,9 @@ namespace DmdExt.Common
 		[Option("dump-frames", HelpText = "If set, dump raw frames into a file.")]
 		public bool RawOutputEnabled { get; set; }
 
+		[Option("dump-format", HelpText = "Format of dumped frames. \"binary\" is compressed and can be played from any position. [ text, binary ]. Default: \"text\".")]
+		public RawOutputFormat RawOutputFormat { get; set; } = RawOutputFormat.Text;
+
 		[Option("use-ini", HelpText = "If set, use options from DmdDevice.ini.")]
 		public string DmdDeviceIni { get; set; } = null;
 
@@ -139,6 +143,18 @@ namespace DmdExt.Common
 		[Option("skip-analytics", HelpText = "If set, don't send anonymous usage data to the developer. Default: false.")]
 		public bool SkipAnalytics { get; set; } = false;
 
+		[Option("profile", HelpText = "If set, periodically log how long each step of the render pipeline takes. Default: false.")]
+		public bool Profile { get; set; } = false;
+
+		[Option("profile-interval", HelpText = "Seconds between two profiler reports. Default: 10.")]
+		public int ProfileInterval { get; set; } = 10;
+
+		[Option("profile-file", HelpText = "If set, write profiler reports to this file instead of the log.")]
+		public string ProfileFile { get; set; } = null;
+
+		[Option("render-threads", HelpText = "If set, the colorizer and each display run on their own thread instead of the thread pool. Default: false.")]
+		public bool RenderThreads { get; set; } = false;
+
 		[Option("--pac-key", HelpText = "Key to decrypt PAC files, in hex.")]
 		public string PacKey { get; set; } = null;
 
@@ -264,6 +280,10 @@ namespace DmdExt.Common
 		public ScalerMode VniScalerMode => _options.ScalingMode;
 		public string VniKey => _options.PacKey;
 		public bool SkipAnalytics => _options.SkipAnalytics;
+		public bool Profiler => _options.Profile;
+		public int ProfilerInterval => _options.ProfileInterval;
+		public string ProfilerFile => _options.ProfileFile;
+		public bool RenderThreads => _options.RenderThreads;
 		public PluginConfig[] Plugins => _options.Plugin == null
 			? new PluginConfig[]{}
 			: new []{ new PluginConfig(_options.Plugin, _options.PluginPassthrough, _options.ScalingMode ) };
@@ -545,5 +565,7 @@ namespace DmdExt.Common
 		}
 
 		public bool Enabled => _options.RawOutputEnabled;
+		public RawOutputFormat Format => _options.RawOutputFormat;
+		public bool Compress => true;
 	}
 }
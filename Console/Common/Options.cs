@@ -3,6 +3,7 @@ using System.Linq;
 using System.Reflection;
 using CommandLine;
 using CommandLine.Text;
+using DmdExt.Bench;
 using DmdExt.Mirror;
 using DmdExt.Play;
 using DmdExt.Server;
@@ -24,12 +25,16 @@ namespace DmdExt.Common
 		[VerbOption("server", HelpText = "Starts a websocket server to receive frames on.")]
 		public ServerOptions Server { get; set; }
 
+		[VerbOption("bench", HelpText = "Measures how fast frames go through the render graph, without any device.")]
+		public BenchOptions Bench { get; set; }
+
 		public Options()
 		{
 			Mirror = new MirrorOptions();
 			Play = new PlayOptions();
 			Test = new TestOptions();
 			Server = new ServerOptions();
+			Bench = new BenchOptions();
 		}
 
 		public void Validate()
@@ -38,6 +43,7 @@ namespace DmdExt.Common
 			Play.Validate();
 			Test.Validate();
 			Server.Validate();
+			Bench.Validate();
 		}
 
 		[HelpVerbOption]
@@ -52,6 +58,8 @@ namespace DmdExt.Common
 					return AutoBuild(Test, "dmdext test [--destination=<destination>]", Test.LastParserState);
 				case "server":
 					return AutoBuild(Test, "dmdext server [--ip=<ip address>] [--port=<port>] [--path=<path>]", Server.LastParserState);
+				case "bench":
+					return AutoBuild(Bench, "dmdext bench [--file=<dump path>] [--colorizer=<colorizer>] [--outputs=<outputs>] [--json]", Bench.LastParserState);
 				default:
 					return AutoBuild(this, "dmdext <command> [<options>]", null, false);
 			}
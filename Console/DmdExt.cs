@@ -8,6 +8,7 @@ using System.Reflection;
 using System.Runtime.InteropServices;
 using System.Windows;
 using CommandLine;
+using DmdExt.Bench;
 using DmdExt.Common;
 using DmdExt.Mirror;
 using DmdExt.Play;
@@ -123,6 +124,10 @@ namespace DmdExt
 					Analytics.Instance.Disable(false);
 				}
 
+				if (config.Global.Profiler) {
+					Profiler.StartReporting(TimeSpan.FromSeconds(config.Global.ProfilerInterval), config.Global.ProfilerFile);
+				}
+
 				//BaseOptions baseOptions;
 				switch (invokedVerb) {
 					case "mirror":
@@ -141,6 +146,11 @@ namespace DmdExt
 						_command = new ServerCommand(config, (ServerOptions)cmdLineOptions);
 						break;
 
+					case "bench":
+						// runs without devices or windows, so no need for the rest.
+						Environment.Exit(new BenchCommand(config, (BenchOptions)cmdLineOptions).Run());
+						break;
+
 					default:
 						throw new ArgumentOutOfRangeException();
 				}
@@ -52,7 +52,8 @@ namespace DmdExt.Mirror
 				FlipHorizontally = _config.Global.FlipHorizontally,
 				FlipVertically = _config.Global.FlipVertically,
 				IdleAfter = _options.IdleAfter,
-				IdlePlay = _options.IdlePlay
+				IdlePlay = _options.IdlePlay,
+				DedicatedThreads = _config.Global.RenderThreads
 			};
 			graph.SetColor(_config.Global.DmdColor);
 			var palette = GetStaticPalette();
@@ -35,6 +35,8 @@ namespace DmdExt.Play
 		{
 			// define source
 			object source;
+			var additionalSources = new List<ISource>();
+			var dumpStart = TimeSpan.FromSeconds(_options.StartTime);
 			switch (Path.GetExtension(_options.FileName.ToLower())) {
 				case ".png":
 				case ".jpg":
@@ -50,25 +52,42 @@ namespace DmdExt.Play
 					break;
 
 				case ".txt":
-					source = new DumpSource(_options.FileName);
+					source = new DumpSource(_options.FileName, dumpStart, !_options.Fast);
+					break;
+
+				case ".dmdrec":
+					HashSet<int> bitLengths;
+					using (var reader = new DumpReader(_options.FileName)) {
+						bitLengths = reader.GetBitLengths();
+					}
+					source = bitLengths.Contains(4) && !bitLengths.Contains(2)
+						? (object)new DumpGray4Source(_options.FileName, dumpStart, !_options.Fast)
+						: new DumpSource(_options.FileName, dumpStart, !_options.Fast);
+
+					// if both are recorded, 4-bit frames need their own graph.
+					if (bitLengths.Contains(4) && bitLengths.Contains(2)) {
+						additionalSources.Add(new DumpGray4Source(_options.FileName, dumpStart, !_options.Fast));
+					}
 					break;
 
 				default:
 					throw new UnknownFormatException("Unknown format " + Path.GetExtension(_options.FileName.ToLower()) +
-						". Known formats: png, jpg, gif, bin, txt.");
+						". Known formats: png, jpg, gif, bin, txt, dmdrec.");
 			}
 
 			// define renderers
 			var renderers = GetRenderers(_config, reportingTags);
-			if (source is ISource frameSource) {
+			if (source is ISource) {
 				// chain them up
-				graphs.Add(new RenderGraph(new UndisposedReferences()) {
-					Source = frameSource,
-					Destinations = renderers,
-					Resize = _config.Global.Resize,
-					FlipHorizontally = _config.Global.FlipHorizontally,
-					FlipVertically = _config.Global.FlipVertically,
-				});
+				foreach (var frameSource in additionalSources.Prepend((ISource)source)) {
+					graphs.Add(new RenderGraph(new UndisposedReferences()) {
+						Source = frameSource,
+						Destinations = renderers,
+						Resize = _config.Global.Resize,
+						FlipHorizontally = _config.Global.FlipHorizontally,
+						FlipVertically = _config.Global.FlipVertically,
+					});
+				}
 
 			} else {
 				// not an ISource, so it must be a IRawSource.
@@ -5,9 +5,15 @@ namespace DmdExt.Play
 {
 	class PlayOptions : BaseOptions
 	{
-		[Option('f', "file", Required = true, HelpText = "Path to the file to play. Currently supported file types: PNG, JPG, BIN (raw).")]
+		[Option('f', "file", Required = true, HelpText = "Path to the file to play. Currently supported file types: PNG, JPG, GIF, BIN (raw), TXT and DMDREC (frame dumps).")]
 		public string FileName { get; set; }
 
+		[Option("start", HelpText = "For frame dumps, where to start playing, in seconds from the first frame. Default: 0.")]
+		public double StartTime { get; set; } = 0;
+
+		[Option("fast", HelpText = "For frame dumps, play as fast as possible instead of at recorded speed. Default: false.")]
+		public bool Fast { get; set; }
+
 		[ParserState]
 		public IParserState LastParserState { get; set; }
 	}
@@ -0,0 +1,190 @@
+﻿using System;
+using System.Diagnostics;
+using System.Windows.Media;
+using FluentAssertions;
+using LibDmd.Common;
+using LibDmd.Frame;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class ColorConversionTests : TestBase
+	{
+		private static readonly Dimensions Dim = new Dimensions(128, 32);
+
+		[TestCase(2)]
+		[TestCase(4)]
+		[TestCase(6)]
+		public void Should_Colorize_Like_Pixel_By_Pixel(int bitLength)
+		{
+			var frame = FrameGenerator.Random(Dim.Width, Dim.Height, bitLength).Data;
+			var palette = FrameGenerator.RandomPalette(bitLength);
+
+			ColorUtil.ColorizeRgb(Dim, frame, palette, 3).Should().Equal(Reference.ColorizeRgb24(frame, palette));
+			ColorUtil.ColorizeRgb(Dim, frame, palette, 2).Should().Equal(Reference.ColorizeRgb565(frame, palette));
+		}
+
+		[TestCase]
+		public void Should_Clamp_Pixels_Outside_Of_Palette()
+		{
+			var palette = new[] { Colors.Black, Colors.Red };
+
+			ColorUtil.ColorizeRgb(new Dimensions(3, 1), new byte[] { 0, 1, 7 }, palette, 3)
+				.Should().Equal(0, 0, 0, 255, 0, 0, 255, 0, 0);
+		}
+
+		[TestCase]
+		public void Should_Convert_Between_Rgb24_And_Rgb565()
+		{
+			var rgb24 = RandomBytes(Dim.Surface * 3);
+
+			var rgb565 = ColorUtil.ConvertRgb24ToRgb565(Dim, rgb24);
+
+			rgb565.Should().Equal(Reference.ConvertRgb24ToRgb565(rgb24));
+			ColorUtil.ConvertRgb565ToRgb24(Dim, rgb565).Should().Equal(Reference.ConvertRgb565ToRgb24(rgb565));
+		}
+
+		[TestCase(4)]
+		[TestCase(16)]
+		public void Should_Convert_To_Gray_Like_Luminosity(int numColors)
+		{
+			var rgb24 = RandomBytes(Dim.Surface * 3);
+			var rgb565 = RandomBytes(Dim.Surface * 2);
+
+			ImageUtil.ConvertToGray(Dim, rgb24, numColors).Should().Equal(Reference.ConvertToGray(rgb24, numColors));
+			ImageUtil.ConvertRgb565ToGray(Dim, rgb565, numColors).Should().Equal(Reference.ConvertToGray(Reference.ConvertRgb565ToRgb24(rgb565), numColors));
+		}
+
+		[TestCase]
+		public void Should_Convert_Rgb24_To_Bgr32()
+		{
+			var rgb24 = RandomBytes(Dim.Surface * 3);
+			var bgr32 = new byte[Dim.Surface * 4];
+
+			ImageUtil.ConvertRgb24ToBgr32(Dim, rgb24, bgr32);
+
+			bgr32.Should().Equal(Reference.ConvertRgb24ToBgr32(rgb24));
+		}
+
+		[Test, Explicit("Benchmark, prints a table of timings.")]
+		public void Benchmark_Against_Pixel_By_Pixel()
+		{
+			var gray4 = FrameGenerator.Random(Dim.Width, Dim.Height, 4).Data;
+			var palette = FrameGenerator.RandomPalette(4);
+			var rgb24 = RandomBytes(Dim.Surface * 3);
+			var rgb565 = RandomBytes(Dim.Surface * 2);
+			var bgr32 = new byte[Dim.Surface * 4];
+
+			Print($"{"128x32",-24} {"pixel by pixel",14} {"LibDmd",10}");
+			Compare("ColorizeRgb (RGB24)", () => Reference.ColorizeRgb24(gray4, palette), () => ColorUtil.ColorizeRgb(Dim, gray4, palette, 3));
+			Compare("ColorizeRgb (RGB565)", () => Reference.ColorizeRgb565(gray4, palette), () => ColorUtil.ColorizeRgb(Dim, gray4, palette, 2));
+			Compare("ConvertRgb24ToRgb565", () => Reference.ConvertRgb24ToRgb565(rgb24), () => ColorUtil.ConvertRgb24ToRgb565(Dim, rgb24));
+			Compare("ConvertRgb565ToRgb24", () => Reference.ConvertRgb565ToRgb24(rgb565), () => ColorUtil.ConvertRgb565ToRgb24(Dim, rgb565));
+			Compare("ConvertToGray (16)", () => Reference.ConvertToGray(rgb24, 16), () => ImageUtil.ConvertToGray(Dim, rgb24, 16));
+			Compare("ConvertRgb24ToBgr32", () => Reference.ConvertRgb24ToBgr32(rgb24), () => ImageUtil.ConvertRgb24ToBgr32(Dim, rgb24, bgr32));
+		}
+
+		private static void Compare(string name, Action reference, Action kernel)
+		{
+			var referenceTime = Measure(reference);
+			var kernelTime = Measure(kernel);
+			Print($"{name,-24} {referenceTime,12:0.0}us {kernelTime,8:0.0}us  ({referenceTime / kernelTime:0.0}x)");
+		}
+
+		private static double Measure(Action action)
+		{
+			for (var i = 0; i < 100; i++) {
+				action();
+			}
+			var runs = 0;
+			var stopwatch = Stopwatch.StartNew();
+			while (stopwatch.ElapsedMilliseconds < 500) {
+				action();
+				runs++;
+			}
+			return stopwatch.Elapsed.TotalMilliseconds * 1000 / runs;
+		}
+
+		private static byte[] RandomBytes(int length)
+		{
+			var data = new byte[length];
+			new Random(length).NextBytes(data);
+			return data;
+		}
+
+		/// <summary>
+		/// Straight-forward per-pixel conversions, built on the public single-color helpers.
+		/// </summary>
+		private static class Reference
+		{
+			public static byte[] ColorizeRgb24(byte[] frame, Color[] palette)
+			{
+				var data = new byte[frame.Length * 3];
+				for (var i = 0; i < frame.Length; i++) {
+					var color = palette[Math.Min(frame[i], palette.Length - 1)];
+					data[i * 3] = color.R;
+					data[i * 3 + 1] = color.G;
+					data[i * 3 + 2] = color.B;
+				}
+				return data;
+			}
+
+			public static byte[] ColorizeRgb565(byte[] frame, Color[] palette)
+			{
+				var data = new byte[frame.Length * 2];
+				for (var i = 0; i < frame.Length; i++) {
+					var color = palette[Math.Min(frame[i], palette.Length - 1)];
+					var (high, low) = ColorUtil.Rgb24ToRgb565(color.R, color.G, color.B);
+					data[i * 2] = low;
+					data[i * 2 + 1] = high;
+				}
+				return data;
+			}
+
+			public static byte[] ConvertRgb24ToRgb565(byte[] rgb24)
+			{
+				var data = new byte[rgb24.Length / 3 * 2];
+				for (var i = 0; i < rgb24.Length / 3; i++) {
+					var (high, low) = ColorUtil.Rgb24ToRgb565(rgb24[i * 3], rgb24[i * 3 + 1], rgb24[i * 3 + 2]);
+					data[i * 2] = low;
+					data[i * 2 + 1] = high;
+				}
+				return data;
+			}
+
+			public static byte[] ConvertRgb565ToRgb24(byte[] rgb565)
+			{
+				var data = new byte[rgb565.Length / 2 * 3];
+				for (var i = 0; i < rgb565.Length / 2; i++) {
+					var (r, g, b) = ColorUtil.Rgb565ToRgb888(rgb565, i * 2);
+					data[i * 3] = r;
+					data[i * 3 + 1] = g;
+					data[i * 3 + 2] = b;
+				}
+				return data;
+			}
+
+			public static byte[] ConvertToGray(byte[] rgb24, int numColors)
+			{
+				var data = new byte[rgb24.Length / 3];
+				for (var i = 0; i < data.Length; i++) {
+					ColorUtil.RgbToHsl(rgb24[i * 3], rgb24[i * 3 + 1], rgb24[i * 3 + 2], out _, out _, out var luminosity);
+					data[i] = (byte)Math.Round(luminosity * (numColors - 1));
+				}
+				return data;
+			}
+
+			public static byte[] ConvertRgb24ToBgr32(byte[] rgb24)
+			{
+				var data = new byte[rgb24.Length / 3 * 4];
+				for (var i = 0; i < rgb24.Length / 3; i++) {
+					data[i * 4] = rgb24[i * 3 + 2];
+					data[i * 4 + 1] = rgb24[i * 3 + 1];
+					data[i * 4 + 2] = rgb24[i * 3];
+				}
+				return data;
+			}
+		}
+	}
+}
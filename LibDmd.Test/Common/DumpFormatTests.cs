@@ -0,0 +1,96 @@
+﻿using System.IO;
+using System.Threading;
+using FluentAssertions;
+using LibDmd.Frame;
+using LibDmd.Input.FileSystem;
+using LibDmd.Output.FileOutput;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class DumpFormatTests : TestBase
+	{
+		private string _path;
+
+		[SetUp]
+		public void Setup()
+		{
+			_path = Path.GetTempFileName();
+		}
+
+		[TearDown]
+		public void Teardown()
+		{
+			File.Delete(_path);
+		}
+
+		[TestCase(false)]
+		[TestCase(true)]
+		public void Should_Read_Written_Frames(bool compress)
+		{
+			var frames = new[] {
+				FrameGenerator.Random(128, 32, 2),
+				FrameGenerator.Random(128, 32, 4),
+				new DmdFrame(192, 64, 4),
+			};
+			WriteDump(frames, compress);
+
+			using (var reader = new DumpReader(_path)) {
+				reader.GameName.Should().Be("test");
+				reader.Count.Should().Be(frames.Length);
+				reader.GetBitLengths().Should().BeEquivalentTo(new[] { 2, 4 });
+				for (var i = 0; i < frames.Length; i++) {
+					var frame = reader.ReadFrame(i, new DmdFrame());
+					frame.Dimensions.Should().Be(frames[i].Dimensions);
+					frame.BitLength.Should().Be(frames[i].BitLength);
+					frame.Data.Should().Equal(frames[i].Data);
+				}
+			}
+		}
+
+		[TestCase]
+		public void Should_Seek_To_Timestamp()
+		{
+			WriteDump(new[] { FrameGenerator.Random(128, 32, 2), FrameGenerator.Random(128, 32, 2) }, true, 50);
+
+			using (var reader = new DumpReader(_path)) {
+				reader.IndexOf(0).Should().Be(0);
+				reader.IndexOf(reader.GetTimestamp(1)).Should().Be(1);
+				reader.IndexOf(reader.Duration + 1).Should().Be(reader.Count);
+			}
+		}
+
+		[TestCase]
+		public void Should_Recover_Frames_Without_Index()
+		{
+			var frames = new[] { FrameGenerator.Random(128, 32, 2), FrameGenerator.Random(128, 32, 4) };
+			WriteDump(frames, true);
+
+			// cut off the index and half of the last frame.
+			long indexOffset;
+			using (var reader = new BinaryReader(File.OpenRead(_path))) {
+				reader.BaseStream.Seek(-16, SeekOrigin.End);
+				indexOffset = reader.ReadInt64();
+			}
+			using (var stream = File.OpenWrite(_path)) {
+				stream.SetLength(indexOffset - 10);
+			}
+
+			using (var reader = new DumpReader(_path)) {
+				reader.Count.Should().Be(1);
+				reader.ReadFrame(0, new DmdFrame()).Data.Should().Equal(frames[0].Data);
+			}
+		}
+
+		private void WriteDump(DmdFrame[] frames, bool compress, int delay = 0)
+		{
+			using (var writer = new DumpWriter(_path, "test", compress)) {
+				foreach (var frame in frames) {
+					writer.Write(frame);
+					Thread.Sleep(delay);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,75 @@
+﻿using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+using FluentAssertions;
+using LibDmd.Common;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class FrameRingTests : TestBase
+	{
+		[TestCase]
+		public void Should_Read_Frames_In_Order()
+		{
+			var ring = new FrameRing<int>(4, 2);
+			var frame = new byte[] { 1, 2, 3 };
+			var raw = new byte[] { 4, 5 };
+			var frameHandle = GCHandle.Alloc(frame, GCHandleType.Pinned);
+			var rawHandle = GCHandle.Alloc(raw, GCHandleType.Pinned);
+			try {
+				ring.TryWrite(1, frameHandle.AddrOfPinnedObject(), 3).Should().BeTrue();
+				ring.TryWrite(2, frameHandle.AddrOfPinnedObject(), 3, rawHandle.AddrOfPinnedObject(), 2).Should().BeTrue();
+
+			} finally {
+				frameHandle.Free();
+				rawHandle.Free();
+			}
+
+			var read = new List<(int, byte[])>();
+			while (ring.TryRead((header, data, length) => read.Add((header, data.Take(length).ToArray())))) { }
+
+			read.Should().HaveCount(2);
+			read[0].Item1.Should().Be(1);
+			read[0].Item2.Should().Equal(1, 2, 3);
+			read[1].Item1.Should().Be(2);
+			read[1].Item2.Should().Equal(1, 2, 3, 4, 5);
+			ring.Count.Should().Be(0);
+		}
+
+		[TestCase]
+		public void Should_Keep_Latest_Frame_When_Full()
+		{
+			var ring = new FrameRing<int>(2, 1);
+			var frame = new byte[] { 1 };
+			var handle = GCHandle.Alloc(frame, GCHandleType.Pinned);
+			try {
+				for (var i = 0; i < 5; i++) {
+					ring.TryWrite(i, handle.AddrOfPinnedObject(), 1);
+				}
+
+			} finally {
+				handle.Free();
+			}
+
+			var headers = new List<int>();
+			while (ring.TryRead((header, data, length) => headers.Add(header))) { }
+
+			headers.Should().Equal(0, 1, 4);
+			ring.Written.Should().Be(5);
+			ring.Overruns.Should().Be(2);
+			ring.MaxCount.Should().Be(2);
+		}
+
+		[TestCase]
+		public void Should_Not_Lose_Wake_Up_Before_Waiting()
+		{
+			var ring = new FrameRing<int>(2, 1);
+			ring.Wake();
+
+			ring.WaitForData(1000).Should().BeTrue();
+			ring.WaitForData(0).Should().BeFalse();
+		}
+	}
+}
@@ -0,0 +1,106 @@
+﻿using System.Text;
+using FluentAssertions;
+using LibDmd.Common;
+using LibDmd.Frame;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class FrameUtilTests : TestBase
+	{
+		[TestCase("", 0xef46db3751d8e999)]
+		[TestCase("abc", 0x44bc2cf5ad770999)]
+		[TestCase("Nobody inspects the spammish repetition", 0xfbcea83c8a378bf1)]
+		public void Should_Hash_Like_XxHash64(string input, ulong expected)
+		{
+			FrameUtil.Hash(Encoding.ASCII.GetBytes(input)).Should().Be(expected);
+		}
+
+		[TestCase(128, 32, 2)]
+		[TestCase(128, 32, 4)]
+		[TestCase(128, 32, 6)]
+		[TestCase(192, 64, 4)]
+		[TestCase(256, 64, 2)]
+		[TestCase(256, 64, 8)]
+		public void Should_Split_And_Join_Bit_Planes(int width, int height, int bitLength)
+		{
+			var dim = new Dimensions(width, height);
+			var frame = FrameGenerator.Random(width, height, bitLength);
+
+			var planes = FrameUtil.Split(dim, bitLength, frame.Data);
+
+			planes.Should().HaveCount(bitLength);
+			FrameUtil.Join(dim, planes).Should().Equal(frame.Data);
+		}
+
+		[TestCase]
+		public void Should_Put_Leftmost_Pixel_Into_Lowest_Bit()
+		{
+			var dim = new Dimensions(16, 1);
+			var frame = new byte[] { 1, 2, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2 };
+
+			var planes = FrameUtil.Split(dim, 2, frame);
+
+			planes[0].Should().Equal(0b00000101, 0b00000000);
+			planes[1].Should().Equal(0b00000110, 0b10000000);
+		}
+
+		[TestCase]
+		public void Should_Reuse_Destination_Planes()
+		{
+			var dim = new Dimensions(128, 32);
+			var destPlanes = new[] { new byte[512], new byte[512], new byte[512], new byte[512] };
+			var frame = FrameGenerator.Random(128, 32, 4);
+
+			var planes = FrameUtil.Split(dim, 4, frame.Data, destPlanes);
+
+			planes.Should().BeSameAs(destPlanes);
+			FrameUtil.Join(dim, planes).Should().Equal(frame.Data);
+		}
+
+		[TestCase(128, 32, 4)]
+		[TestCase(256, 64, 2)]
+		public void Should_Scale_Planes_Up_And_Down(int width, int height, int bitLength)
+		{
+			var dim = new Dimensions(width, height);
+			var frame = FrameGenerator.Random(width, height, bitLength);
+			var planes = FrameUtil.Split(dim, bitLength, frame.Data);
+
+			var scaledPlanes = FrameUtil.ScaleDouble(dim, planes);
+
+			FrameUtil.Join(dim * 2, scaledPlanes).Should().Equal(FrameUtil.ScaleDouble(dim, frame.Data, 1));
+			FrameUtil.ScaleDown(dim, scaledPlanes).Should().BeEquivalentTo(planes, options => options.WithStrictOrdering());
+		}
+
+		[TestCase(1)]
+		[TestCase(2)]
+		[TestCase(3)]
+		public void Should_Round_Corners_With_Scale2X(int bytesPerPixel)
+		{
+			// two diagonal pixels, touching each other at the corner
+			var dim = new Dimensions(4, 4);
+			var frame = new byte[16 * bytesPerPixel];
+			for (var k = 0; k < bytesPerPixel; k++) {
+				frame[5 * bytesPerPixel + k] = 1;
+				frame[10 * bytesPerPixel + k] = 1;
+			}
+
+			var scaled = FrameUtil.Scale2X(dim, frame, bytesPerPixel);
+
+			var expected = new byte[] {
+				0, 0, 0, 0, 0, 0, 0, 0,
+				0, 0, 0, 0, 0, 0, 0, 0,
+				0, 0, 1, 1, 0, 0, 0, 0,
+				0, 0, 1, 1, 1, 0, 0, 0,
+				0, 0, 0, 1, 1, 1, 0, 0,
+				0, 0, 0, 0, 1, 1, 0, 0,
+				0, 0, 0, 0, 0, 0, 0, 0,
+				0, 0, 0, 0, 0, 0, 0, 0,
+			};
+			for (var i = 0; i < expected.Length; i++) {
+				scaled[i * bytesPerPixel].Should().Be(expected[i], $"pixel {i % 8}/{i / 8} should be {expected[i]}");
+			}
+		}
+	}
+}
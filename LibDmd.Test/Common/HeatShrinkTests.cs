@@ -0,0 +1,96 @@
+﻿using System;
+using System.IO;
+using FluentAssertions;
+using LibDmd.Common.HeatShrink;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class HeatShrinkTests : TestBase
+	{
+		[TestCase]
+		public void Should_Decode_Same_As_Stream_Decoder()
+		{
+			var random = new Random(22);
+			for (var n = 0; n < 500; n++) {
+				var data = RandomData(random, random.Next(0, 5000));
+				var compressed = Encode(data);
+
+				var decoded = new byte[data.Length];
+				HeatShrinkDecoder.Decode(compressed, decoded, 10, 5).Should().Be(data.Length);
+
+				decoded.Should().Equal(data);
+				DecodeStream(compressed).Should().Equal(data);
+			}
+		}
+
+		[TestCase]
+		public void Should_Stop_When_Output_Is_Full()
+		{
+			var data = RandomData(new Random(1), 2048);
+			var decoded = new byte[1000];
+
+			HeatShrinkDecoder.Decode(Encode(data), decoded, 10, 5).Should().Be(1000);
+			decoded.Should().Equal(new ArraySegment<byte>(data, 0, 1000));
+		}
+
+		[TestCase]
+		public void Should_Stop_When_Input_Is_Exhausted()
+		{
+			var data = RandomData(new Random(2), 2048);
+			var compressed = Encode(data);
+			var decoded = new byte[data.Length];
+
+			var length = HeatShrinkDecoder.Decode(new ReadOnlySpan<byte>(compressed, 0, compressed.Length / 2), decoded, 10, 5);
+
+			length.Should().BeLessThan(data.Length);
+			new ArraySegment<byte>(decoded, 0, length).Should().Equal(new ArraySegment<byte>(data, 0, length));
+		}
+
+		/// <summary>
+		/// Random bytes with repetitions, like bit planes.
+		/// </summary>
+		private static byte[] RandomData(Random random, int length)
+		{
+			var data = new byte[length];
+			var i = 0;
+			while (i < length) {
+				var run = Math.Min(random.Next(1, 40), length - i);
+				if (i > 0 && random.Next(2) == 0) {
+					var from = random.Next(Math.Max(0, i - 1024), i);
+					for (var j = 0; j < run; j++) {
+						data[i + j] = data[from + j];
+					}
+				} else if (random.Next(2) == 0) {
+					var value = (byte)random.Next(256);
+					for (var j = 0; j < run; j++) {
+						data[i + j] = value;
+					}
+				} else {
+					for (var j = 0; j < run; j++) {
+						data[i + j] = (byte)random.Next(256);
+					}
+				}
+				i += run;
+			}
+			return data;
+		}
+
+		private static byte[] Encode(byte[] data)
+		{
+			using (var output = new MemoryStream()) {
+				new HeatShrinkEncoder(10, 5).Encode(new MemoryStream(data), output);
+				return output.ToArray();
+			}
+		}
+
+		private static byte[] DecodeStream(byte[] compressed)
+		{
+			using (var output = new MemoryStream()) {
+				new HeatShrinkDecoder(10, 5, 1024).Decode(new MemoryStream(compressed), output);
+				return output.ToArray();
+			}
+		}
+	}
+}
@@ -0,0 +1,104 @@
+﻿using System.Collections.Generic;
+using System.Threading;
+using FluentAssertions;
+using LibDmd.Common;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class PipelineStageTests : TestBase
+	{
+		[TestCase]
+		public void Should_Run_In_Order()
+		{
+			var processed = new List<int>();
+			var stage = new PipelineStage("Test.Order", 4);
+			for (var i = 0; i < 1000; i++) {
+				var n = i;
+				stage.Post(() => processed.Add(n));
+			}
+			stage.Dispose();
+
+			processed.Should().HaveCount(1000);
+			processed.Should().BeInAscendingOrder();
+			stage.Processed.Should().Be(1000);
+		}
+
+		[TestCase]
+		public void Should_Wait_When_Full()
+		{
+			var running = new ManualResetEventSlim();
+			var release = new ManualResetEventSlim();
+			var stage = new PipelineStage("Test.Full", 2);
+			stage.Post(() => {
+				running.Set();
+				release.Wait();
+			});
+			running.Wait();
+			stage.Post(() => { });
+			stage.Post(() => { });
+
+			var posted = new ManualResetEventSlim();
+			new Thread(() => {
+				stage.Post(() => { });
+				posted.Set();
+			}).Start();
+
+			posted.Wait(100).Should().BeFalse();
+			release.Set();
+			posted.Wait(1000).Should().BeTrue();
+			stage.Dispose();
+
+			stage.Stalls.Should().Be(1);
+			stage.Processed.Should().Be(4);
+		}
+
+		[TestCase]
+		public void Should_Keep_Order_When_Posting_To_Itself()
+		{
+			var processed = new List<int>();
+			var running = new ManualResetEventSlim();
+			var release = new ManualResetEventSlim();
+			var posted = new ManualResetEventSlim();
+			var stage = new PipelineStage("Test.Self", 2);
+			stage.Post(() => {
+				running.Set();
+				release.Wait();
+				stage.Post(() => processed.Add(3));
+				posted.Set();
+			});
+			running.Wait();
+			stage.Post(() => processed.Add(1));
+			stage.Post(() => processed.Add(2));
+
+			release.Set();
+			posted.Wait(1000).Should().BeTrue();
+			stage.Dispose();
+
+			processed.Should().Equal(1, 2, 3);
+			stage.Stalls.Should().Be(0);
+		}
+
+		[TestCase]
+		public void Should_Report_Utilization()
+		{
+			var stage = new PipelineStage("Test.Utilization");
+			stage.Post(() => Thread.Sleep(50));
+			Thread.Sleep(100);
+			stage.Dispose();
+
+			stage.Utilization.Should().BeInRange(0.2, 0.8);
+		}
+
+		[TestCase]
+		public void Should_Ignore_Work_After_Dispose()
+		{
+			var stage = new PipelineStage("Test.Disposed");
+			stage.Dispose();
+			stage.Post(() => { });
+
+			stage.Processed.Should().Be(0);
+		}
+	}
+}
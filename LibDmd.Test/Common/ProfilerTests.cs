@@ -0,0 +1,94 @@
+﻿using System.Diagnostics;
+using System.Linq;
+using System.Threading.Tasks;
+using FluentAssertions;
+using LibDmd.Common;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class ProfilerTests : TestBase
+	{
+		private bool _enabled;
+
+		[SetUp]
+		public void Setup()
+		{
+			_enabled = Profiler.Enabled;
+			Profiler.Enabled = true;
+		}
+
+		[TearDown]
+		public void Teardown()
+		{
+			Profiler.Enabled = _enabled;
+		}
+
+		[TestCase]
+		public void Should_Sum_Up_All_Threads()
+		{
+			var probe = Profiler.GetProbe("Test.Threads");
+			probe.Reset();
+
+			Parallel.For(0, 4, _ => {
+				for (var i = 1; i <= 1000; i++) {
+					probe.Record(Ms(i / 1000.0));
+				}
+			});
+
+			var snapshot = probe.Snapshot();
+			snapshot.Count.Should().Be(4000);
+			snapshot.MaxMs.Should().BeApproximately(1, 0.001);
+			snapshot.MeanMs.Should().BeApproximately(0.5, 0.001);
+			snapshot.PercentileMs(50).Should().BeApproximately(0.5, 0.5 * 0.13);
+			snapshot.PercentileMs(99).Should().BeApproximately(0.99, 0.99 * 0.13);
+		}
+
+		[TestCase]
+		public void Should_Return_Values_Since_Previous_Snapshot()
+		{
+			var probe = Profiler.GetProbe("Test.Since");
+			probe.Reset();
+			for (var i = 0; i < 100; i++) {
+				probe.Record(Ms(1));
+			}
+			var previous = probe.Snapshot();
+			for (var i = 0; i < 10; i++) {
+				probe.Record(Ms(20));
+			}
+
+			var delta = probe.Snapshot().Since(previous);
+			delta.Count.Should().Be(10);
+			delta.MeanMs.Should().BeApproximately(20, 0.001);
+			delta.PercentileMs(50).Should().BeApproximately(20, 20 * 0.13);
+		}
+
+		[TestCase]
+		public void Should_Not_Record_When_Disabled()
+		{
+			var probe = Profiler.GetProbe("Test.Disabled");
+			probe.Reset();
+			Profiler.Enabled = false;
+
+			using (Profiler.Start("Test.Disabled")) { }
+			probe.Mark();
+			probe.Mark();
+
+			probe.Snapshot().Count.Should().Be(0);
+			Profiler.Snapshot().Select(s => s.Name).Should().NotContain("Test.Disabled");
+		}
+
+		[TestCase]
+		public void Should_Place_Values_In_Their_Bucket()
+		{
+			for (long value = 0; value < 10000; value++) {
+				var bucket = Probe.BucketOf(value);
+				Probe.LowestOf(bucket).Should().BeLessOrEqualTo(value);
+				Probe.LowestOf(bucket + 1).Should().BeGreaterThan(value);
+			}
+		}
+
+		private static long Ms(double ms) => (long)(ms * Stopwatch.Frequency / 1000);
+	}
+}
@@ -0,0 +1,137 @@
+﻿using System.Text;
+using System.Windows.Media;
+using FluentAssertions;
+using LibDmd.Output.Network;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class WebsocketSerializerTests : TestBase
+	{
+		[TestCase]
+		public void Should_Send_Original_Messages_Without_Hello()
+		{
+			var sender = new WebsocketSerializer();
+			var message = sender.SerializeGray(FrameGenerator.Random(128, 32, 4).Data, 4);
+
+			Encoding.ASCII.GetString(message, 0, 11).Should().Be("gray4Planes");
+		}
+
+		[TestCase]
+		public void Should_Read_Original_Messages()
+		{
+			var sender = new WebsocketSerializer { Pool = new MessagePool() };
+			var receiver = new WebsocketSerializer();
+			var action = new SocketAction();
+			var gray = FrameGenerator.Random(128, 32, 4);
+			var colored = FrameGenerator.RandomColored(128, 32, 4);
+
+			receiver.Unserialize(sender.SerializeGray(gray.Data, 4), action);
+			action.Frame.Should().Equal(gray.Data);
+
+			receiver.Unserialize(sender.SerializeColoredGray4(colored.BitPlanes, colored.Palette), action);
+			action.Frame.Should().Equal(colored.Data);
+			action.Palette.Should().Equal(colored.Palette);
+
+			receiver.Unserialize(sender.SerializeGameName("afm_113b"), action);
+			action.GameName.Should().Be("afm_113b");
+		}
+
+		[TestCase]
+		public void Should_Recycle_Buffers_When_Sent_Everywhere()
+		{
+			var pool = new MessagePool();
+			var message = new SocketMessage(pool.Rent(100), true, 2, pool);
+
+			message.Release();
+			pool.Rent(100).Should().NotBeSameAs(message.Data);
+			message.Release();
+			pool.Rent(100).Should().BeSameAs(message.Data);
+		}
+
+		[TestCase]
+		public void Should_Read_Hello()
+		{
+			var message = new WebsocketSerializer().SerializeHello(WebsocketSerializer.Version);
+
+			WebsocketSerializer.TryReadHello(message, out var version).Should().BeTrue();
+			version.Should().Be(WebsocketSerializer.Version);
+			WebsocketSerializer.TryReadHello(Encoding.ASCII.GetBytes("helloWorld\0"), out _).Should().BeFalse();
+		}
+
+		[TestCase]
+		public void Should_Send_Deltas()
+		{
+			var sender = new WebsocketSerializer { ProtocolVersion = WebsocketSerializer.Version };
+			var receiver = new WebsocketSerializer();
+			var action = new SocketAction();
+			var frame1 = FrameGenerator.Random(128, 32, 4).Data;
+			var frame2 = (byte[])frame1.Clone();
+			frame2[100] = (byte)((frame2[100] + 1) % 16);
+			frame2[2000] = (byte)((frame2[2000] + 1) % 16);
+
+			var message1 = sender.SerializeGray(frame1, 4);
+			var message2 = sender.SerializeGray(frame2, 4);
+			message2.Length.Should().BeLessThan(64);
+
+			receiver.Unserialize(message1, action);
+			action.Frame.Should().Equal(frame1);
+			receiver.Unserialize(message2, action);
+			action.Frame.Should().Equal(frame2);
+		}
+
+		[TestCase]
+		public void Should_Send_Palette_Only_When_Changed()
+		{
+			var sender = new WebsocketSerializer { ProtocolVersion = WebsocketSerializer.Version };
+			var receiver = new WebsocketSerializer();
+			var action = new SocketAction();
+			var frame1 = FrameGenerator.RandomColored(128, 32, 4);
+			var frame2 = FrameGenerator.RandomColored(128, 32, 4);
+
+			var messages = new[] {
+				sender.SerializeColoredGray4(frame1.BitPlanes, frame1.Palette),
+				sender.SerializeColoredGray4(frame1.BitPlanes, frame1.Palette),
+				sender.SerializeColoredGray4(frame2.BitPlanes, frame2.Palette),
+				sender.SerializeColoredGray4(frame1.BitPlanes, frame1.Palette),
+			};
+			messages[1].Length.Should().BeLessThan(frame1.Palette.Length * 4);
+
+			receiver.Unserialize(messages[0], action);
+			action.Frame.Should().Equal(frame1.Data);
+			action.Palette.Should().Equal(frame1.Palette);
+
+			receiver.Unserialize(messages[1], action);
+			action.Frame.Should().Equal(frame1.Data);
+			action.Palette.Should().Equal(frame1.Palette);
+
+			receiver.Unserialize(messages[2], action);
+			action.Frame.Should().Equal(frame2.Data);
+			action.Palette.Should().Equal(frame2.Palette);
+
+			receiver.Unserialize(messages[3], action);
+			action.Frame.Should().Equal(frame1.Data);
+			action.Palette.Should().Equal(frame1.Palette);
+		}
+
+		private class SocketAction : ISocketAction
+		{
+			public byte[] Frame;
+			public Color[] Palette;
+			public string GameName;
+
+			public void OnColor(Color color) { }
+			public void OnPalette(Color[] palette) { }
+			public void OnClearColor() { }
+			public void OnClearPalette() { }
+			public void OnGameName(string gameName) => GameName = gameName;
+			public void OnRgb24(uint timestamp, byte[] frame) => Frame = frame;
+			public void OnColoredGray6(uint timestamp, Color[] palette, byte[] data) => (Frame, Palette) = (data, palette);
+			public void OnColoredGray4(uint timestamp, Color[] palette, byte[] data) => (Frame, Palette) = (data, palette);
+			public void OnColoredGray2(uint timestamp, Color[] palette, byte[] data) => (Frame, Palette) = (data, palette);
+			public void OnGray4(uint timestamp, byte[] frame) => Frame = frame;
+			public void OnGray2(uint timestamp, byte[] frame) => Frame = frame;
+		}
+	}
+}
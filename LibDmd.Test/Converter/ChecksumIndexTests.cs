@@ -0,0 +1,48 @@
+﻿using System;
+using System.Collections.Generic;
+using FluentAssertions;
+using LibDmd.Converter.Vni;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class ChecksumIndexTests : TestBase
+	{
+		[TestCase(0)]
+		[TestCase(1)]
+		[TestCase(100)]
+		[TestCase(5000)]
+		public void Should_Find_All_Entries_And_Nothing_Else(int count)
+		{
+			var random = new Random(count);
+			var entries = new Dictionary<uint, string>();
+			while (entries.Count < count) {
+				var checksum = (uint)random.Next() ^ ((uint)random.Next() << 16);
+				entries[checksum] = checksum.ToString();
+			}
+
+			var index = new ChecksumIndex<string>(entries);
+
+			index.Count.Should().Be(count);
+			foreach (var entry in entries) {
+				index.TryGetValue(entry.Key, out var value).Should().BeTrue();
+				value.Should().Be(entry.Value);
+			}
+			for (var i = 0; i < 10000; i++) {
+				var checksum = (uint)random.Next() ^ ((uint)random.Next() << 16);
+				index.TryGetValue(checksum, out var value).Should().Be(entries.ContainsKey(checksum));
+			}
+		}
+
+		[TestCase]
+		public void Should_Be_Empty_Without_Entries()
+		{
+			var index = new ChecksumIndex<string>(null);
+
+			index.Count.Should().Be(0);
+			index.TryGetValue(0, out var value).Should().BeFalse();
+			value.Should().BeNull();
+		}
+	}
+}
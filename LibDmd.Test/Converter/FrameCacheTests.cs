@@ -0,0 +1,66 @@
+﻿using FluentAssertions;
+using LibDmd.Converter;
+using LibDmd.Frame;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class FrameCacheTests : TestBase
+	{
+		private static readonly Dimensions Dim = new Dimensions(128, 32);
+
+		[TestCase]
+		public void Should_Return_Cached_Output_For_Same_Input_And_State()
+		{
+			var cache = new FrameCache<string>(4);
+			var state = new object();
+			var planes = FrameGenerator.Random(128, 32, 4).BitPlanes;
+
+			cache.GetOrAdd(Dim, planes, state, () => "first").Should().Be("first");
+			cache.GetOrAdd(Dim, Copy(planes), state, () => "second").Should().Be("first");
+			cache.GetOrAdd(Dim, planes, new object(), () => "third").Should().Be("third");
+
+			cache.Hits.Should().Be(1);
+			cache.Misses.Should().Be(2);
+		}
+
+		[TestCase]
+		public void Should_Not_Change_When_Input_Is_Reused()
+		{
+			var cache = new FrameCache<string>(4);
+			var planes = FrameGenerator.Random(128, 32, 2).BitPlanes;
+
+			cache.GetOrAdd(Dim, planes, null, () => "first");
+			planes[1][100] ^= 0xff;
+
+			cache.GetOrAdd(Dim, planes, null, () => "second").Should().Be("second");
+		}
+
+		[TestCase]
+		public void Should_Evict_Least_Recently_Used()
+		{
+			var cache = new FrameCache<string>(2);
+			var a = FrameGenerator.Random(128, 32, 2).BitPlanes;
+			var b = FrameGenerator.Random(128, 32, 2).BitPlanes;
+			var c = FrameGenerator.Random(128, 32, 2).BitPlanes;
+
+			cache.GetOrAdd(Dim, a, null, () => "a");
+			cache.GetOrAdd(Dim, b, null, () => "b");
+			cache.GetOrAdd(Dim, a, null, () => "a2").Should().Be("a");
+			cache.GetOrAdd(Dim, c, null, () => "c");
+
+			cache.GetOrAdd(Dim, a, null, () => "a3").Should().Be("a");
+			cache.GetOrAdd(Dim, b, null, () => "b2").Should().Be("b2");
+		}
+
+		private static byte[][] Copy(byte[][] planes)
+		{
+			var copy = new byte[planes.Length][];
+			for (var i = 0; i < planes.Length; i++) {
+				copy[i] = (byte[])planes[i].Clone();
+			}
+			return copy;
+		}
+	}
+}
@@ -0,0 +1,49 @@
+﻿using System;
+using FluentAssertions;
+using LibDmd.Common;
+using LibDmd.Converter.Vni;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class PlaneChecksumsTests : TestBase
+	{
+		[TestCase(512, 0, false)]
+		[TestCase(512, 3, false)]
+		[TestCase(512, 3, true)]
+		[TestCase(2048, 5, true)]
+		[TestCase(13, 2, true)]
+		public void Should_Match_Byte_Wise_Checksums(int size, int numMasks, bool reverse)
+		{
+			var random = new Random(size + numMasks);
+			var plane = new byte[size];
+			var masks = new byte[numMasks][];
+			random.NextBytes(plane);
+			for (var i = 0; i < numMasks; i++) {
+				masks[i] = new byte[size];
+				random.NextBytes(masks[i]);
+			}
+
+			var checksums = new PlaneChecksums(masks).Compute(0, plane, reverse);
+
+			checksums.Should().HaveCount(numMasks + 1);
+			checksums[0].Should().Be(FrameUtil.Checksum(plane, reverse));
+			for (var i = 0; i < numMasks; i++) {
+				checksums[i + 1].Should().Be(FrameUtil.ChecksumWithMask(plane, masks[i], reverse));
+			}
+		}
+
+		[TestCase]
+		public void Should_Rehash_Changed_Plane()
+		{
+			var planeChecksums = new PlaneChecksums(null);
+			var plane = new byte[512];
+
+			planeChecksums.Compute(0, plane, false)[0].Should().Be(FrameUtil.Checksum(plane, false));
+			plane[100] = 0x42;
+			planeChecksums.Compute(0, plane, false)[0].Should().Be(FrameUtil.Checksum(plane, false));
+			planeChecksums.Compute(0, plane, true)[0].Should().Be(FrameUtil.Checksum(plane, true));
+		}
+	}
+}
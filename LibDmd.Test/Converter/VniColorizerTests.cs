@@ -0,0 +1,85 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using FluentAssertions;
+using LibDmd.Common;
+using LibDmd.Converter.Vni;
+using LibDmd.Frame;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class VniColorizerTests : TestBase
+	{
+		private static readonly Dimensions Dim = new Dimensions(128, 32);
+
+		[TestCase]
+		public void Should_Render_Animations_Through_Frame_Cache()
+		{
+			var random = new Random(23);
+			var animation = Enumerable.Range(0, 2).Select(_ => new byte[VniFileTests.PlaneSize]).ToArray();
+			foreach (var plane in animation) {
+				random.NextBytes(plane);
+			}
+			var vniData = VniFileTests.CreateVni(new[] { animation }, new[] { animation }, false, out var offsets);
+			var frame = FrameGenerator.Random(Dim.Width, Dim.Height, 2);
+			var checksum = new PlaneChecksums(null).Compute(0, frame.BitPlanes[0], false)[0];
+
+			var colorizer = new VniColorizer(new PalFile(CreatePal(checksum, (uint)offsets[0]), "test.pal"), new VniFile(vniData, "test.vni"));
+			var received = new List<byte[]>();
+			var subscription = colorizer.GetColoredGray2Frames().Subscribe(f => received.Add(f.Data));
+			try {
+				colorizer.StopClock();
+				colorizer.Convert(frame);
+
+				// the animation's frame is shown for 20ms, so the second tick renders it again.
+				colorizer.Tick();
+				colorizer.Tick();
+				colorizer.FrameCache.Hits.Should().Be(1);
+
+				var expected = FrameUtil.Join(Dim, animation.Select(p => p.Select(VniAnimationPlane.Reverse).ToArray()).ToArray());
+				received.Should().HaveCount(1);
+				received[0].Should().Equal(expected);
+				colorizer.FrameCache.Misses.Should().Be(1);
+
+			} finally {
+				subscription.Dispose();
+				colorizer.Dispose();
+			}
+		}
+
+		/// <summary>
+		/// Writes a PAL file with one palette and one mapping that replaces the frame with an animation.
+		/// </summary>
+		private static byte[] CreatePal(uint checksum, uint offset)
+		{
+			using (var ms = new MemoryStream())
+			using (var writer = new BinaryWriter(ms)) {
+				writer.Write((byte)1);
+				WriteBE(writer, 1, 2);
+				WriteBE(writer, 0, 2);
+				WriteBE(writer, 4, 2);
+				writer.Write((byte)1);
+				for (var i = 0; i < 4; i++) {
+					writer.Write(new[] { (byte)(i * 85), (byte)(i * 85), (byte)0 });
+				}
+				WriteBE(writer, 1, 2);
+				WriteBE(writer, (int)checksum, 4);
+				writer.Write((byte)SwitchMode.Replace);
+				WriteBE(writer, 0, 2);
+				WriteBE(writer, (int)offset, 4);
+				writer.Write((byte)0);
+				return ms.ToArray();
+			}
+		}
+
+		private static void WriteBE(BinaryWriter writer, int value, int length)
+		{
+			for (var i = length - 1; i >= 0; i--) {
+				writer.Write((byte)(value >> (i * 8)));
+			}
+		}
+	}
+}
@@ -0,0 +1,142 @@
+﻿using System;
+using System.IO;
+using System.Linq;
+using System.Text;
+using FluentAssertions;
+using LibDmd.Common.HeatShrink;
+using LibDmd.Converter.Vni;
+using LibDmd.Frame;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class VniFileTests : TestBase
+	{
+		internal const int PlaneSize = 512;
+		private static readonly Dimensions Dim = new Dimensions(128, 32);
+
+		[TestCase(false, false)]
+		[TestCase(true, false)]
+		[TestCase(true, true)]
+		public void Should_Decode_Animations_When_Played(bool mapped, bool compressed)
+		{
+			var random = new Random(6);
+			var planes = Enumerable.Range(0, 6).Select(_ => new byte[PlaneSize]).ToArray();
+			foreach (var plane in planes) {
+				random.NextBytes(plane);
+			}
+			var data = CreateVni(new[] { planes.Take(2).ToArray() }, new[] { planes.Skip(2).Take(2).ToArray(), planes.Skip(4).ToArray() }, compressed, out var offsets);
+			var path = Path.GetTempFileName();
+			File.WriteAllBytes(path, data);
+
+			var vni = mapped ? new VniFile(path) : new VniFile(data, "test.vni");
+			try {
+				vni.Dimensions.Should().Be(Dim);
+				var first = vni.Find((uint)offsets[0]);
+				var second = vni.Find((uint)offsets[1]);
+				first.NumFrames.Should().Be(1);
+				second.NumFrames.Should().Be(2);
+				first.IsDecoded.Should().BeFalse();
+				second.IsDecoded.Should().BeFalse();
+
+				byte[][] rendered = null;
+				second.Start(SwitchMode.Replace, (dim, p) => rendered = p);
+				second.NextFrame(Dim, new byte[2][]);
+
+				second.IsDecoded.Should().BeTrue();
+				first.IsDecoded.Should().BeFalse();
+				rendered[0].Should().Equal(planes[2].Select(VniAnimationPlane.Reverse));
+				rendered[1].Should().Equal(planes[3].Select(VniAnimationPlane.Reverse));
+
+			} finally {
+				vni.Dispose();
+				File.Delete(path);
+			}
+		}
+
+		[TestCase]
+		public void Should_Decode_Compressed_Frames_In_Parallel()
+		{
+			// enough compressed frames for VniFrameSeq to decompress them in parallel.
+			var random = new Random(22);
+			var frames = Enumerable.Range(0, 12).Select(_ => Enumerable.Range(0, 2).Select(__ => new byte[PlaneSize]).ToArray()).ToArray();
+			foreach (var plane in frames.SelectMany(f => f)) {
+				random.NextBytes(plane);
+			}
+			var data = CreateVni(new[] { frames[0] }, frames, true, out var offsets, 0);
+
+			using (var vni = new VniFile(data, "test.vni")) {
+				var animation = vni.Find((uint)offsets[1]);
+				animation.NumFrames.Should().Be(frames.Length);
+
+				// without delay, every call renders the next frame.
+				byte[][] rendered = null;
+				animation.Start(SwitchMode.Replace, (dim, p) => rendered = p);
+				foreach (var frame in frames) {
+					animation.NextFrame(Dim, new byte[2][]);
+					rendered.Should().HaveCount(frame.Length);
+					for (var i = 0; i < frame.Length; i++) {
+						rendered[i].Should().Equal(frame[i].Select(VniAnimationPlane.Reverse));
+					}
+				}
+			}
+		}
+
+		/// <summary>
+		/// Writes a v4 VNI file with 2-bit frames.
+		/// </summary>
+		internal static byte[] CreateVni(byte[][][] first, byte[][][] second, bool compressed, out long[] offsets, int delay = 20)
+		{
+			using (var ms = new MemoryStream())
+			using (var writer = new BinaryWriter(ms)) {
+				var animations = new[] { first, second };
+				writer.Write(Encoding.ASCII.GetBytes("VPIN"));
+				WriteBE(writer, 4, 2);
+				WriteBE(writer, animations.Length, 2);
+				WriteBE(writer, 0, 4 * animations.Length);
+
+				offsets = new long[animations.Length];
+				for (var i = 0; i < animations.Length; i++) {
+					offsets[i] = ms.Position;
+					var name = Encoding.ASCII.GetBytes($"anim{i}");
+					WriteBE(writer, name.Length, 2);
+					writer.Write(name);
+					WriteBE(writer, 0, 2 + 2 + 2 + 1 + 1 + 2 + 2 + 2 + 1 + 1); // cycles to fsk
+					WriteBE(writer, animations[i].Length, 2);
+					WriteBE(writer, 0, 2 + 2 + 1); // palette, colors, edit mode
+					WriteBE(writer, Dim.Width, 2);
+					WriteBE(writer, Dim.Height, 2);
+					foreach (var frame in animations[i]) {
+						WriteBE(writer, PlaneSize, 2);
+						WriteBE(writer, delay, 2);
+						WriteBE(writer, 0, 4); // hash
+						writer.Write((byte)frame.Length);
+						writer.Write(compressed ? (byte)1 : (byte)0);
+						var planes = new MemoryStream();
+						for (var j = 0; j < frame.Length; j++) {
+							planes.WriteByte((byte)j);
+							planes.Write(frame[j], 0, frame[j].Length);
+						}
+						if (compressed) {
+							var compressedPlanes = new MemoryStream();
+							planes.Position = 0;
+							new HeatShrinkEncoder(10, 5).Encode(planes, compressedPlanes);
+							planes = compressedPlanes;
+							WriteBE(writer, (int)planes.Length, 4);
+						}
+						writer.Write(planes.ToArray());
+					}
+				}
+				return ms.ToArray();
+			}
+		}
+
+		private static void WriteBE(BinaryWriter writer, int value, int length)
+		{
+			for (var i = length - 1; i >= 0; i--) {
+				writer.Write(i < 4 ? (byte)(value >> (i * 8)) : (byte)0);
+			}
+		}
+	}
+}
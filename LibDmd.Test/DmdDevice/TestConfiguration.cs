@@ -2,6 +2,7 @@
 using LibDmd.Common;
 using LibDmd.DmdDevice;
 using LibDmd.Input;
+using LibDmd.Output.FileOutput;
 using LibDmd.Output.Virtual.AlphaNumeric;
 using LibDmd.Output.Virtual.Dmd;
 
@@ -61,6 +62,10 @@ namespace LibDmd.Test
 		public ScalerMode ScalerMode { get; set; }
 		public ScalerMode VniScalerMode { get; set; }
 		public string VniKey { get; set; }
+		public bool Profiler { get; set; }
+		public int ProfilerInterval { get; set; }
+		public string ProfilerFile { get; set; }
+		public bool RenderThreads { get; set; }
 		public bool SkipAnalytics => true;
 		public PluginConfig[] Plugins { get; set; }
 	}
@@ -177,5 +182,7 @@ namespace LibDmd.Test
 	public class RawOutputConfig : IRawOutputConfig
 	{
 		public bool Enabled { get; set; }
+		public RawOutputFormat Format { get; set; } = RawOutputFormat.Text;
+		public bool Compress { get; set; } = true;
 	}
 }
@@ -0,0 +1,52 @@
+﻿using System.Threading.Tasks;
+using FluentAssertions;
+using LibDmd.Frame;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class FrameBufferPoolTests : TestBase
+	{
+		[TestCase(128 * 32)]
+		[TestCase(256 * 64 * 3)]
+		[TestCase(1234)]
+		public void Should_Reuse_Returned_Buffers(int length)
+		{
+			var buffer = FrameBufferPool.Rent(length);
+			buffer.Should().HaveCount(length);
+
+			FrameBufferPool.Return(buffer);
+
+			FrameBufferPool.Rent(length).Should().BeSameAs(buffer);
+		}
+
+		[TestCase]
+		public void Should_Not_Hand_Out_The_Same_Buffer_Twice()
+		{
+			var buffer1 = FrameBufferPool.Rent(4096);
+			var buffer2 = FrameBufferPool.Rent(4096);
+
+			buffer1.Should().NotBeSameAs(buffer2);
+		}
+
+		[TestCase]
+		public async Task Should_Share_Buffers_Between_Threads()
+		{
+			// fill up this thread's cache, so the rest goes to the shared queue.
+			var buffers = new byte[8][];
+			for (var i = 0; i < buffers.Length; i++) {
+				buffers[i] = FrameBufferPool.Rent(192 * 64 * 2);
+			}
+			foreach (var buffer in buffers) {
+				FrameBufferPool.Return(buffer);
+			}
+
+			var hits = FrameBufferPool.Hits;
+			var rented = await Task.Run(() => FrameBufferPool.Rent(192 * 64 * 2));
+
+			buffers.Should().Contain(rented);
+			FrameBufferPool.Hits.Should().Be(hits + 1);
+		}
+	}
+}
@@ -1,4 +1,5 @@
 ﻿using FluentAssertions;
+using LibDmd.Common;
 using LibDmd.Converter.Vni;
 using LibDmd.Frame;
 using NUnit.Framework;
@@ -89,6 +90,32 @@ namespace LibDmd.Test
 			// RemoveLogger();
 		}
 
+		[TestCase]
+		public void Should_Compare_Frames_By_Content()
+		{
+			var frame = FrameGenerator.Random(128, 32, 4);
+			var copy = new DmdFrame(frame.Dimensions, (byte[])frame.Data.Clone(), frame.BitLength);
+
+			(frame == copy).Should().Be(true);
+			frame.GetHashCode().Should().Be(copy.GetHashCode());
+			frame.Hash.Should().Be(copy.Hash);
+			frame.CloneFrame().Hash.Should().Be(frame.Hash);
+		}
+
+		[TestCase]
+		public void Should_Reset_Hash_When_Data_Changes()
+		{
+			var frame = FrameGenerator.Random(128, 32, 4);
+			var hash = frame.Hash;
+			var data = (byte[])frame.Data.Clone();
+			data[100] = (byte)((data[100] + 1) % 16);
+
+			frame.Update(data, 4);
+			frame.Hash.Should().NotBe(hash);
+			frame.Update(frame.Dimensions, FrameGenerator.Random(128, 32, 4).Data);
+			frame.Hash.Should().Be(FrameUtil.Hash(frame.Data));
+		}
+
 		//[TestCase]
 		public void DebugMMColorization()
 		{
@@ -0,0 +1,52 @@
+﻿using FluentAssertions;
+using LibDmd.Common;
+using LibDmd.Frame;
+using LibDmd.Test.Stubs;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class GrayToRgbPipelineTests : TestBase
+	{
+		[TestCase(3, ScalerMode.None, false, false, 256, 64)]
+		[TestCase(3, ScalerMode.None, true, true, 256, 64)]
+		[TestCase(3, ScalerMode.Doubler, false, false, 256, 64)]
+		[TestCase(3, ScalerMode.Doubler, true, false, 256, 64)]
+		[TestCase(3, ScalerMode.Scale2x, false, true, 256, 64)]
+		[TestCase(2, ScalerMode.None, true, false, 256, 64)]
+		[TestCase(2, ScalerMode.Doubler, false, true, 256, 64)]
+		[TestCase(2, ScalerMode.Scale2x, true, true, 256, 64)]
+		[TestCase(3, ScalerMode.None, false, false, 128, 32)]
+		[TestCase(3, ScalerMode.None, true, false, 128, 32)]
+		[TestCase(2, ScalerMode.None, false, true, 128, 32)]
+		[TestCase(3, ScalerMode.Doubler, true, true, 128, 32)]
+		[TestCase(3, ScalerMode.None, false, false, 0, 0)]
+		[TestCase(3, ScalerMode.None, true, true, 0, 0)]
+		[TestCase(2, ScalerMode.Scale2x, false, true, 0, 0)]
+		public void Should_Match_Separate_Steps(int bytesPerPixel, ScalerMode scalerMode, bool flipHorizontally, bool flipVertically, int destWidth, int destHeight)
+		{
+			var graph = new RenderGraph(new UndisposedReferences(), true) {
+				ScalerMode = scalerMode,
+				FlipHorizontally = flipHorizontally,
+				FlipVertically = flipVertically,
+			};
+			// 0x0 means no fixed-size destination.
+			var dest = destWidth > 0 ? new DestinationFixedRgb24(destWidth, destHeight) : null;
+			var palette = FrameGenerator.RandomPalette(4);
+			var frame = FrameGenerator.Random(128, 32, 4);
+
+			var pipeline = new GrayToRgbPipeline(graph, dest, null, bytesPerPixel);
+			var fusedFrame = pipeline.Process(frame.CloneFrame(), palette);
+
+			var scaledFrame = frame.CloneFrame().TransformHdScaling(dest, scalerMode);
+			var expectedFrame = bytesPerPixel == 3
+				? scaledFrame.ConvertGrayToRgb24(palette).TransformRgb24(graph, dest, null)
+				: scaledFrame.ConvertGrayToRgb565(palette).TransformRgb565(graph, dest, null);
+
+			fusedFrame.Dimensions.Should().Be(expectedFrame.Dimensions);
+			fusedFrame.BitLength.Should().Be(expectedFrame.BitLength);
+			fusedFrame.Data.Should().Equal(expectedFrame.Data);
+		}
+	}
+}
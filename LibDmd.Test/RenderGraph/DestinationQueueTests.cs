@@ -0,0 +1,78 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Reactive.Concurrency;
+using System.Reactive.Subjects;
+using System.Threading;
+using FluentAssertions;
+using LibDmd.Output;
+using NUnit.Framework;
+
+namespace LibDmd.Test
+{
+	[TestFixture]
+	public class DestinationQueueTests : TestBase
+	{
+		[TestCase]
+		public void Should_Drop_Stale_Frames_While_Destination_Is_Busy()
+		{
+			var queue = new DestinationQueue("test", Scheduler.Default);
+			var frames = new Subject<int>();
+			var rendered = new List<int>();
+			var busy = new ManualResetEventSlim();
+			var resume = new ManualResetEventSlim();
+			var done = new CountdownEvent(2);
+
+			queue.Coalesce(frames).Subscribe(frame => {
+				busy.Set();
+				resume.Wait();
+				rendered.Add(frame);
+				done.Signal();
+			});
+
+			frames.OnNext(1);
+			busy.Wait(1000).Should().BeTrue();
+			for (var i = 2; i <= 5; i++) {
+				frames.OnNext(i);
+			}
+			resume.Set();
+
+			done.Wait(1000).Should().BeTrue();
+			rendered.Should().Equal(1, 5);
+			queue.Received.Should().Be(5);
+			queue.Dropped.Should().Be(3);
+			queue.Rendered.Should().Be(2);
+		}
+
+		[TestCase]
+		public void Should_Complete_On_Worker_After_Pending_Frame()
+		{
+			var queue = new DestinationQueue("test", Scheduler.Default);
+			var frames = new Subject<int>();
+			var events = new List<string>();
+			var busy = new ManualResetEventSlim();
+			var resume = new ManualResetEventSlim();
+			var completed = new ManualResetEventSlim();
+			var rendering = 0;
+
+			queue.Coalesce(frames).Subscribe(frame => {
+				Interlocked.Increment(ref rendering);
+				busy.Set();
+				resume.Wait();
+				events.Add($"frame {frame}");
+				Interlocked.Decrement(ref rendering);
+			}, () => {
+				events.Add(rendering == 0 ? "completed" : "completed while rendering");
+				completed.Set();
+			});
+
+			frames.OnNext(1);
+			busy.Wait(1000).Should().BeTrue();
+			frames.OnNext(2);
+			frames.OnCompleted();
+			resume.Set();
+
+			completed.Wait(1000).Should().BeTrue();
+			events.Should().Equal("frame 1", "frame 2", "completed");
+		}
+	}
+}
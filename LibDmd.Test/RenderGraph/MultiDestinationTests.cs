@@ -59,5 +59,29 @@ namespace LibDmd.Test
 			receivedFrame2.BitLength.Should().Be(srcFrame.BitLength);
 			receivedFrame2.Dimensions.Should().Be(srcFrame.Dimensions);
 		}
+
+		[TestCase]
+		public async Task Should_Share_Frame_Data_Between_Destinations()
+		{
+			var dest1 = new DestinationFixedGray2(128, 32);
+			var dest2 = new DestinationFixedGray2(128, 32);
+
+			_graph.Source = _source;
+			_graph.Destinations = new List<IDestination> { dest1, dest2 };
+			_graph.StartRendering();
+
+			var srcFrame = FrameGenerator.Random(128, 32, 2);
+
+			dest1.Reset();
+			dest2.Reset();
+			_source.AddFrame(srcFrame);
+			var receivedFrame1 = await dest1.Frame;
+			var receivedFrame2 = await dest2.Frame;
+
+			receivedFrame1.Should().NotBeSameAs(srcFrame);
+			receivedFrame2.Should().NotBeSameAs(receivedFrame1);
+			receivedFrame1.Data.Should().BeSameAs(srcFrame.Data);
+			receivedFrame2.Data.Should().BeSameAs(srcFrame.Data);
+		}
 	}
 }
@@ -1,5 +1,6 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Runtime.CompilerServices;
 using System.Windows.Media;
 using LibDmd.Frame;
 
@@ -247,6 +248,19 @@ namespace LibDmd.Common
 		/// <returns>Colorized frame data</returns>
 		/// <exception cref="ArgumentException">When provided frame and palette are incoherent</exception>
 		public static byte[] ColorizeRgb(Dimensions dim, byte[] frame, Color[] palette, int bytesPerPixel)
+			=> ColorizeRgb(dim, frame, palette, bytesPerPixel, new byte[frame.Length * bytesPerPixel]);
+
+		/// <summary>
+		/// Colors the frame like <see cref="ColorizeRgb(Dimensions, byte[], Color[], int)"/>, but into an existing buffer.
+		/// </summary>
+		/// <param name="dim">Dimensions of the frame to color</param>
+		/// <param name="frame">Frame to color, width * height pixels with values from 0 - [size of palette]</param>
+		/// <param name="palette">Colors to use for coloring</param>
+		/// <param name="bytesPerPixel">Number of output bytes per pixel. 3 for RGB24, 2 for RGB16.</param>
+		/// <param name="colorizedData">Destination buffer, must be exactly width * height * bytesPerPixel long</param>
+		/// <returns>The destination buffer</returns>
+		/// <exception cref="ArgumentException">When provided frame, palette or destination are incoherent</exception>
+		public static unsafe byte[] ColorizeRgb(Dimensions dim, byte[] frame, Color[] palette, int bytesPerPixel, byte[] colorizedData)
 		{
 			using (Profiler.Start("ColorUtil.ColorizeRgb")) {
 				#if DEBUG
@@ -254,48 +268,46 @@ namespace LibDmd.Common
 					throw new ArgumentException("Data and dimensions do not match.");
 				}
 				#endif
+				if (bytesPerPixel != 2 && bytesPerPixel != 3) {
+					throw new ArgumentException("Unsupported number of bytes per pixel.");
+				}
+				if (palette.Length == 0) {
+					throw new ArgumentException("Cannot colorize with an empty palette.");
+				}
+				if (colorizedData.Length != frame.Length * bytesPerPixel) {
+					throw new ArgumentException($"Destination must be {frame.Length * bytesPerPixel} bytes long, but is {colorizedData.Length}.");
+				}
 
-				var frameLength = dim.Surface * bytesPerPixel;
-				var colorizedData = new byte[frameLength];
-
-				var palValues = new byte[bytesPerPixel][];
-				for (var k = 0; k < bytesPerPixel; k++) {
-					palValues[k] = new byte[palette.Length];
+				// one packed color per possible pixel value, so there's no need to check the range per pixel.
+				var colors = stackalloc uint[256];
+				for (var i = 0; i < 256; i++) {
+					var color = palette[Math.Min(i, palette.Length - 1)]; // Avoid crash when VPinMame sends data out of the palette range
+					colors[i] = bytesPerPixel == 3
+						? (uint)(color.R | color.G << 8 | color.B << 16)
+						: PackRgb565(color.R, color.G, color.B);
 				}
 
-				for (var i = 0; i < palette.Length; i++) {
-					switch (bytesPerPixel) {
-						case 3:
-							palValues[0][i] = palette[i].R;
-							palValues[1][i] = palette[i].G;
-							palValues[2][i] = palette[i].B;
-							break;
-
-						case 2:
-							var (x1, x2) = Rgb24ToRgb565(palette[i].R, palette[i].G, palette[i].B);
-							palValues[0][i] = x2;
-							palValues[1][i] = x1;
-							break;
-
-						default:
-							throw new ArgumentException("Unsupported number of bytes per pixel.");
-					}
+				if (frame.Length == 0) {
+					return colorizedData;
 				}
 
-				var maxPixel = (byte)(palette.Length - 1);
-				unsafe {
-					fixed (byte* pFrame = frame, pcolorFrame = colorizedData) {
-						byte* pFrameCur = pFrame, pFEnd = pFrame + frame.Length;
-						byte* pColorFrameCur = pcolorFrame;
-
-						for (; pFrameCur < pFEnd; pFrameCur++, pColorFrameCur += bytesPerPixel) {
-							var pixel = *pFrameCur;
-							if (pixel > maxPixel) {
-								pixel = maxPixel; // Avoid crash when VPinMame sends data out of the palette range
-							}
-							for (var i = 0; i < bytesPerPixel; i++) {
-								*(pColorFrameCur + i) = palValues[i][pixel];
-							}
+				fixed (byte* pFrame = frame, pColorFrame = colorizedData) {
+					var last = frame.Length - 1;
+					if (bytesPerPixel == 3) {
+						// write four bytes per pixel, the fourth is overwritten by the next pixel.
+						var dest = pColorFrame;
+						for (var i = 0; i < last; i++, dest += 3) {
+							*(uint*)dest = colors[pFrame[i]];
+						}
+						var lastColor = colors[pFrame[last]];
+						dest[0] = (byte)lastColor;
+						dest[1] = (byte)(lastColor >> 8);
+						dest[2] = (byte)(lastColor >> 16);
+
+					} else {
+						var dest = (ushort*)pColorFrame;
+						for (var i = 0; i <= last; i++) {
+							dest[i] = (ushort)colors[pFrame[i]];
 						}
 					}
 				}
@@ -309,14 +321,15 @@ namespace LibDmd.Common
 		/// <param name="dim">Dimensions of the image</param>
 		/// <param name="rgb888Data">RGB24 array, from top left to bottom right</param>
 		/// <returns></returns>
-		public static byte[] ConvertRgb24ToRgb565(Dimensions dim, byte[] rgb888Data)
+		public static unsafe byte[] ConvertRgb24ToRgb565(Dimensions dim, byte[] rgb888Data)
 		{
-			var frame = new byte[dim.Surface * 2];
-			var rgb565Pos = 0;
-			for (var y = 0; y < dim.Height; y++) {
-				for (var x = 0; x < dim.Width * 3; x += 3) {
-					var rgb888Pos = y * dim.Width * 3 + x;
-					Rgb24ToRgb565(rgb888Data, rgb888Pos, frame, rgb565Pos++);
+			var surface = CheckSize(dim, rgb888Data, 3);
+			var frame = new byte[surface * 2];
+			fixed (byte* pSrc = rgb888Data, pDest = frame) {
+				var src = pSrc;
+				var dest = (ushort*)pDest;
+				for (var i = 0; i < surface; i++, src += 3) {
+					dest[i] = (ushort)PackRgb565(src[0], src[1], src[2]);
 				}
 			}
 			return frame;
@@ -329,41 +342,52 @@ namespace LibDmd.Common
 		/// <param name="rgb888Data">RGB24 array, from top left to bottom right</param>
 		/// <param name="frame"></param>
 		/// <returns></returns>
-		public static ushort[] ConvertRgb24ToRgb565(Dimensions dim, byte[] rgb888Data, ushort[] frame)
+		public static unsafe ushort[] ConvertRgb24ToRgb565(Dimensions dim, byte[] rgb888Data, ushort[] frame)
 		{
-			var rgb565Pos = 0;
-			for (var y = 0; y < dim.Height; y++) {
-				for (var x = 0; x < dim.Width * 3; x += 3) {
-					var rgb888Pos = y * dim.Width * 3 + x;
-					Rgb24ToRgb565(rgb888Data, rgb888Pos, frame, rgb565Pos++);
+			var surface = CheckSize(dim, rgb888Data, 3);
+			if (frame.Length < surface) {
+				throw new ArgumentException("Destination is smaller than the frame.");
+			}
+			fixed (byte* pSrc = rgb888Data)
+			fixed (ushort* dest = frame) {
+				var src = pSrc;
+				for (var i = 0; i < surface; i++, src += 3) {
+					dest[i] = (ushort)PackRgb565(src[0], src[1], src[2]);
 				}
 			}
 			return frame;
 		}
 
-		private static void Rgb24ToRgb565(IReadOnlyList<byte> rgb888Data, int rgb888Pos, IList<byte> rgb565Data, int rgb565Pos)
-		{
-			var (x1, x2) = Rgb24ToRgb565(rgb888Data, rgb888Pos);
-			rgb565Data[rgb565Pos] = x1;
-			rgb565Data[rgb565Pos + 1] = x2;
-		}
-
-		private static void Rgb24ToRgb565(IReadOnlyList<byte> rgb888Data, int rgb888Pos, IList<ushort> rgb565Data, int rgb565Pos)
+		public static (byte, byte) Rgb24ToRgb565(byte r, byte g, byte b)
 		{
-			var (x1, x2) = Rgb24ToRgb565(rgb888Data, rgb888Pos);
-			rgb565Data[rgb565Pos] = (ushort)((x1 << 8) + x2);
+			var x1 = (r & 0xF8) | (g >> 5);          // Take 5 bits of Red component and 3 bits of G component
+			var x2 = ((g & 0x1C) << 3) | (b >> 3);   // Take remaining 3 Bits of G component and 5 bits of Blue component
+			return ((byte)x1, (byte)x2);
 		}
 
-		private static (byte, byte) Rgb24ToRgb565(IReadOnlyList<byte> rgb888Data, int rgb888Pos)
+		/// <summary>
+		/// Packs an RGB888 color into RGB565, i.e. 5 bits red, 6 bits green and 5 bits blue.
+		/// </summary>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		internal static uint PackRgb565(byte r, byte g, byte b)
 		{
-			return Rgb24ToRgb565(rgb888Data[rgb888Pos], rgb888Data[rgb888Pos + 1], rgb888Data[rgb888Pos + 2]);
+			return (uint)((r & 0xF8) << 8 | (g & 0xFC) << 3 | b >> 3);
 		}
 
-		public static (byte, byte) Rgb24ToRgb565(byte r, byte g, byte b)
+		/// <summary>
+		/// Expands an RGB565 color to RGB888, with red in the lowest byte.
+		/// </summary>
+		///
+		/// <remarks>
+		/// The most significant bits of each component are copied into the lowest
+		/// ones, so full intensity stays full intensity.
+		/// </remarks>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		internal static uint UnpackRgb565(uint rgb565)
 		{
-			var x1 = (r & 0xF8) | (g >> 5);          // Take 5 bits of Red component and 3 bits of G component
-			var x2 = ((g & 0x1C) << 3) | (b >> 3);   // Take remaining 3 Bits of G component and 5 bits of Blue component
-			return ((byte)x1, (byte)x2);
+			return (((rgb565 >> 8) & 0xF8) | ((rgb565 >> 13) & 0x07))
+				| (((rgb565 >> 3) & 0xFC) | ((rgb565 >> 9) & 0x03)) << 8
+				| (((rgb565 << 3) & 0xF8) | ((rgb565 >> 2) & 0x07)) << 16;
 		}
 
 		/// <summary>
@@ -372,32 +396,40 @@ namespace LibDmd.Common
 		/// <param name="dim">Dimensions of the array</param>
 		/// <param name="rgb565Data">RGB565 data of the frame</param>
 		/// <returns>Converted RGB888 data</returns>
-		public static byte[] ConvertRgb565ToRgb24(Dimensions dim, byte[] rgb565Data)
+		public static unsafe byte[] ConvertRgb565ToRgb24(Dimensions dim, byte[] rgb565Data)
 		{
-			var rgb888Data = new byte[dim.Surface * 3];
-			for (var x = 0; x < dim.Width; x++) {
-				for (var y = 0; y < dim.Height; y++) {
-					var rgb565Pos = (y * dim.Width + x) * 2;
-					var rgb888Pos = (y * dim.Width + x) * 3;
-					Rgb565ToRgb888(rgb565Data, rgb565Pos, rgb888Data, rgb888Pos);
+			var surface = CheckSize(dim, rgb565Data, 2);
+			var rgb888Data = new byte[surface * 3];
+			if (surface == 0) {
+				return rgb888Data;
+			}
+			fixed (byte* pSrc = rgb565Data, pDest = rgb888Data) {
+				var src = (ushort*)pSrc;
+				var dest = pDest;
+
+				// write four bytes per pixel, the fourth is overwritten by the next pixel.
+				for (var i = 0; i < surface - 1; i++, dest += 3) {
+					*(uint*)dest = UnpackRgb565(src[i]);
 				}
+				var rgb = UnpackRgb565(src[surface - 1]);
+				dest[0] = (byte)rgb;
+				dest[1] = (byte)(rgb >> 8);
+				dest[2] = (byte)(rgb >> 16);
 			}
 			return rgb888Data;
 		}
 
 		/// <summary>
-		/// Converts a RGB565 pixel of a frame to a pixel in a RGB24 frame.
+		/// Makes sure the frame contains enough data for its dimensions, since the conversions use pointers.
 		/// </summary>
-		/// <param name="rgb565Data">Source RGB565 array</param>
-		/// <param name="rgb565Pos">Position of the source pixel within the array (not the frame)</param>
-		/// <param name="rgb888Data">Destination RGB888 array</param>
-		/// <param name="rgb888Pos">Position of the destination pixel without the array (not the frame)</param>
-		private static void Rgb565ToRgb888(IReadOnlyList<byte> rgb565Data, int rgb565Pos, IList<byte> rgb888Data, int rgb888Pos)
+		/// <returns>Number of pixels</returns>
+		private static int CheckSize(Dimensions dim, byte[] data, int bytesPerPixel)
 		{
-			var (r, g, b) = Rgb565ToRgb888(rgb565Data, rgb565Pos);
-			rgb888Data[rgb888Pos] = r;
-			rgb888Data[rgb888Pos + 1] = g;
-			rgb888Data[rgb888Pos + 2] = b;
+			var surface = dim.Surface;
+			if (data.Length < surface * bytesPerPixel) {
+				throw new ArgumentException($"Frame of {data.Length} bytes is too small for {dim} at {bytesPerPixel} bytes per pixel.");
+			}
+			return surface;
 		}
 
 		/// <summary>
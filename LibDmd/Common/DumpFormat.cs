@@ -0,0 +1,72 @@
+﻿using System.IO;
+using System.IO.Compression;
+
+namespace LibDmd.Common
+{
+	/// <summary>
+	/// Layout of binary frame dumps, as written by <see cref="Output.FileOutput.DumpWriter"/>
+	/// and read by <see cref="Input.FileSystem.DumpReader"/>.
+	/// </summary>
+	///
+	/// <remarks>
+	/// All numbers are little endian. A file looks like this:
+	///
+	///   Header:  "DMDR", version (ushort), game name length (ushort), game name (UTF-8)
+	///   Frames:  timestamp in ms since start (long), width (ushort), height (ushort),
+	///            bit length (byte), compression (byte), data length (int), data
+	///   Index:   per frame: timestamp (long), offset of the frame (long)
+	///   Footer:  offset of the index (long), number of frames (int), "DMDI"
+	///
+	/// The index and footer are written when the recording is closed. If
+	/// they are missing, e.g. because the recording was interrupted, the
+	/// reader rebuilds the index by walking through the frames.
+	/// </remarks>
+	internal static class DumpFormat
+	{
+		public const uint Magic = 0x52444D44;       // "DMDR"
+		public const uint IndexMagic = 0x49444D44;  // "DMDI"
+		public const ushort Version = 1;
+
+		public const int FrameHeaderSize = 8 + 2 + 2 + 1 + 1 + 4;
+		public const int IndexEntrySize = 8 + 8;
+		public const int FooterSize = 8 + 4 + 4;
+
+		public const byte CompressionNone = 0;
+		public const byte CompressionDeflate = 1;
+
+		/// <summary>
+		/// Uncompressed size of a frame's data.
+		/// </summary>
+		public static int FrameSize(int width, int height, int bitLength) => width * height * (bitLength <= 8 ? 1 : bitLength / 8);
+
+		/// <summary>
+		/// Compresses frame data, or returns null if that doesn't make it smaller.
+		/// </summary>
+		public static byte[] Compress(byte[] data, int offset, int length)
+		{
+			using (var memory = new MemoryStream(length)) {
+				using (var deflate = new DeflateStream(memory, CompressionLevel.Fastest, true)) {
+					deflate.Write(data, offset, length);
+				}
+				return memory.Length < length ? memory.ToArray() : null;
+			}
+		}
+
+		/// <summary>
+		/// Decompresses frame data into a buffer of the uncompressed size.
+		/// </summary>
+		public static void Decompress(byte[] data, int length, byte[] dest)
+		{
+			using (var deflate = new DeflateStream(new MemoryStream(data, 0, length), CompressionMode.Decompress)) {
+				var read = 0;
+				while (read < dest.Length) {
+					var n = deflate.Read(dest, read, dest.Length - read);
+					if (n == 0) {
+						throw new InvalidDataException("Compressed frame is shorter than its dimensions.");
+					}
+					read += n;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,236 @@
+﻿using System;
+using System.Runtime.InteropServices;
+using System.Threading;
+
+namespace LibDmd.Common
+{
+	/// <summary>
+	/// A fixed-size ring of frame buffers between exactly one producer and
+	/// one consumer thread.
+	/// </summary>
+	///
+	/// <remarks>
+	/// This is for callers that can't afford to wait, like PinMAME's emulation
+	/// thread. Writing a frame copies it into a preallocated slot and returns,
+	/// without taking a lock or allocating memory.
+	///
+	/// If the consumer is so far behind that the ring is full, the frame goes
+	/// into a separate "latest" slot instead, which is read after the ring.
+	/// Frames arriving while it's still unread replace it, and the replaced
+	/// ones are counted as overruns. So the producer never blocks, and the
+	/// newest frame always gets through, which matters because PinMAME only
+	/// sends a frame when it changes.
+	///
+	/// Slots only grow when a frame doesn't fit, which only happens for the
+	/// first few frames.
+	/// </remarks>
+	/// <typeparam name="THeader">Describes what's in a slot, e.g. frame format and dimensions.</typeparam>
+	public class FrameRing<THeader> where THeader : struct
+	{
+		/// <summary>
+		/// Processes a frame read from the ring.
+		/// </summary>
+		/// <param name="header">Frame description, as written</param>
+		/// <param name="data">Frame data. Only valid during the call.</param>
+		/// <param name="length">Number of bytes of data</param>
+		public delegate void ReadHandler(THeader header, byte[] data, int length);
+
+		/// <summary>
+		/// Number of frames waiting to be read.
+		/// </summary>
+		public int Count => (int)(Volatile.Read(ref _head) - Volatile.Read(ref _tail)) + (Volatile.Read(ref _latest).Fresh ? 1 : 0);
+
+		/// <summary>
+		/// Number of slots.
+		/// </summary>
+		public int Capacity => _slots.Length;
+
+		/// <summary>
+		/// Number of frames written so far.
+		/// </summary>
+		public long Written => Volatile.Read(ref _head) + Interlocked.Read(ref _latestWritten);
+
+		/// <summary>
+		/// Number of frames dropped because a newer one replaced them in the latest slot.
+		/// </summary>
+		public long Overruns => Interlocked.Read(ref _overruns);
+
+		/// <summary>
+		/// The most frames that were waiting in the ring at the same time.
+		/// </summary>
+		public int MaxCount => Volatile.Read(ref _maxCount);
+
+		private readonly Slot[] _slots;
+		private readonly int _mask;
+		private readonly ManualResetEventSlim _dataAvailable = new ManualResetEventSlim(false);
+
+		/// <summary>
+		/// The latest slot, swapped between producer and consumer, each of
+		/// which keeps a spare one to swap in.
+		/// </summary>
+		private Slot _latest;
+		private Slot _producerSpare;
+		private Slot _consumerSpare;
+
+		private long _head;
+		private long _tail;
+		private long _latestWritten;
+		private long _overruns;
+		private int _maxCount;
+		private int _woken;
+
+		/// <param name="capacity">Number of slots, must be a power of two.</param>
+		/// <param name="slotSize">Initial size of each slot in bytes.</param>
+		public FrameRing(int capacity, int slotSize)
+		{
+			if (capacity <= 0 || (capacity & (capacity - 1)) != 0) {
+				throw new ArgumentException("Capacity must be a power of two.", nameof(capacity));
+			}
+			_slots = new Slot[capacity];
+			_mask = capacity - 1;
+			for (var i = 0; i < capacity; i++) {
+				_slots[i] = new Slot { Data = new byte[slotSize] };
+			}
+			_latest = new Slot { Data = new byte[slotSize] };
+			_producerSpare = new Slot { Data = new byte[slotSize] };
+			_consumerSpare = new Slot { Data = new byte[slotSize] };
+		}
+
+		/// <summary>
+		/// Copies a frame into the ring. Must only be called from the producer thread.
+		/// </summary>
+		/// <param name="header">Frame description</param>
+		/// <param name="data">Pointer to the frame data</param>
+		/// <param name="length">Number of bytes to copy from data</param>
+		/// <param name="extraData">Pointer to additional data, copied right after the frame data</param>
+		/// <param name="extraLength">Number of bytes to copy from extraData</param>
+		/// <returns>True if queued, false if it replaced an unread frame in the latest slot.</returns>
+		public bool TryWrite(THeader header, IntPtr data, int length, IntPtr extraData = default, int extraLength = 0)
+		{
+			var head = _head;
+			var count = (int)(head - Volatile.Read(ref _tail));
+
+			// as long as the latest slot is unread, frames must go there too, or they'd be read before it.
+			if (count == _slots.Length || Volatile.Read(ref _latest).Fresh) {
+				return WriteLatest(header, data, length, extraData, extraLength);
+			}
+
+			Fill(_slots[head & _mask], header, data, length, extraData, extraLength);
+
+			// publish the slot only after it's completely written.
+			Volatile.Write(ref _head, head + 1);
+			if (count + 1 > _maxCount) {
+				Volatile.Write(ref _maxCount, count + 1);
+			}
+			_dataAvailable.Set();
+			return true;
+		}
+
+		/// <summary>
+		/// Processes the oldest frame in the ring, if any. Must only be called from the consumer thread.
+		/// </summary>
+		/// <param name="handler">What to do with the frame. The slot is released once it returns.</param>
+		/// <returns>True if a frame was processed, false if the ring was empty.</returns>
+		public bool TryRead(ReadHandler handler)
+		{
+			// once the latest slot is written, the producer stops writing to the ring until it's read,
+			// so if it's seen before the ring is found empty, it's the next frame.
+			var latestFresh = Volatile.Read(ref _latest).Fresh;
+			var tail = _tail;
+			if (tail != Volatile.Read(ref _head)) {
+				var slot = _slots[tail & _mask];
+				try {
+					handler(slot.Header, slot.Data, slot.Length);
+				} finally {
+					Volatile.Write(ref _tail, tail + 1);
+				}
+				return true;
+			}
+			if (!latestFresh) {
+				return false;
+			}
+
+			var latest = Interlocked.Exchange(ref _latest, _consumerSpare);
+			try {
+				handler(latest.Header, latest.Data, latest.Length);
+			} finally {
+				latest.Fresh = false;
+				_consumerSpare = latest;
+			}
+			return true;
+		}
+
+		/// <summary>
+		/// Blocks the consumer until there is something to read, it's woken up, or the timeout expires.
+		/// </summary>
+		/// <param name="timeout">Timeout in milliseconds, or -1 to wait forever.</param>
+		/// <returns>True if there is data or the consumer was woken up, false on timeout.</returns>
+		public bool WaitForData(int timeout)
+		{
+			// reset before checking, so a frame written or a wake-up in between sets it again.
+			_dataAvailable.Reset();
+
+			// a wake-up that came before the reset would be lost otherwise.
+			if (Interlocked.Exchange(ref _woken, 0) == 1) {
+				return true;
+			}
+			return Count > 0 || _dataAvailable.Wait(timeout);
+		}
+
+		/// <summary>
+		/// Wakes up a consumer waiting in <see cref="WaitForData"/>, or makes
+		/// its next call return right away if it isn't waiting yet.
+		/// </summary>
+		public void Wake()
+		{
+			Interlocked.Exchange(ref _woken, 1);
+			_dataAvailable.Set();
+		}
+
+		private bool WriteLatest(THeader header, IntPtr data, int length, IntPtr extraData, int extraLength)
+		{
+			var slot = _producerSpare;
+			Fill(slot, header, data, length, extraData, extraLength);
+			slot.Fresh = true;
+
+			var previous = Interlocked.Exchange(ref _latest, slot);
+			Interlocked.Increment(ref _latestWritten);
+			_producerSpare = previous;
+			_dataAvailable.Set();
+
+			if (previous.Fresh) {
+				previous.Fresh = false;
+				Interlocked.Increment(ref _overruns);
+				return false;
+			}
+			return true;
+		}
+
+		private static void Fill(Slot slot, THeader header, IntPtr data, int length, IntPtr extraData, int extraLength)
+		{
+			if (slot.Data.Length < length + extraLength) {
+				slot.Data = new byte[length + extraLength];
+			}
+			slot.Header = header;
+			slot.Length = length + extraLength;
+			if (length > 0) {
+				Marshal.Copy(data, slot.Data, 0, length);
+			}
+			if (extraLength > 0) {
+				Marshal.Copy(extraData, slot.Data, length, extraLength);
+			}
+		}
+
+		private class Slot
+		{
+			public THeader Header;
+			public byte[] Data;
+			public int Length;
+
+			/// <summary>
+			/// For the latest slot: set when written, cleared when read.
+			/// </summary>
+			public volatile bool Fresh;
+		}
+	}
+}
@@ -2,6 +2,8 @@
 using System.Collections;
 using System.Diagnostics;
 using System.Linq;
+using System.Numerics;
+using System.Runtime.CompilerServices;
 using System.Runtime.InteropServices;
 using System.Text;
 using LibDmd.Frame;
@@ -41,52 +43,34 @@ namespace LibDmd.Common
 				var planeSize = dim.Surface / 8;
 				var planes = destPlanes ?? new byte[bitlen][];
 
-				try
-				{
-					for (var i = 0; i < bitlen; i++) {
-						if (planes[i] == null) { // recycle, if possible
-							planes[i] = new byte[planeSize];
-						}
+				for (var i = 0; i < bitlen; i++) {
+					if (planes[i] == null) { // recycle, if possible
+						planes[i] = new byte[planeSize];
 					}
+				}
 
-					var byteIdx = 0;
-					var bd = new byte[bitlen];
-					for (var y = 0; y < dim.Height; y++)
-					{
-						for (var x = 0; x < dim.Width; x += 8)
-						{
-							for (var i = 0; i < bitlen; i++)
-							{
-								bd[i] = 0;
-							}
+				// we're using pointers below, so check bounds beforehand.
+				var fits = frame.Length >= planeSize * 8;
+				for (var i = 0; i < bitlen; i++) {
+					fits = fits && planes[i].Length >= planeSize;
+				}
+				if (!fits) {
+					Logger.Error("Split failed: {0}x{1} frame:{2} bitlen:{3}", dim.Width, dim.Height, frame.Length, bitlen);
+					throw new IndexOutOfRangeException($"Cannot split {frame.Length} bytes into {bitlen} planes of {dim}.");
+				}
 
-							for (var v = 7; v >= 0; v--)
-							{
-								var pixel = frame[(y * dim.Width) + (x + v)];
-								for (var i = 0; i < bitlen; i++)
-								{
-									bd[i] <<= 1;
-									if ((pixel & (1 << i)) != 0)
-									{
-										bd[i] |= 1;
-									}
+				unsafe {
+					fixed (byte* pFrame = frame) {
+						var src = (ulong*)pFrame;
+						for (var i = 0; i < bitlen; i++) {
+							fixed (byte* pPlane = planes[i]) {
+								for (var byteIdx = 0; byteIdx < planeSize; byteIdx++) {
+									pPlane[byteIdx] = GatherBits(src[byteIdx] >> i);
 								}
 							}
-
-							for (var i = 0; i < bitlen; i++)
-							{
-								planes[i][byteIdx] = bd[i];
-							}
-
-							byteIdx++;
 						}
 					}
 				}
-				catch (IndexOutOfRangeException e)
-				{
-					Logger.Error("Split failed: {0}x{1} frame:{2} bitlen:{3}", dim.Width, dim.Height, frame.Length, bitlen);
-					throw new IndexOutOfRangeException(e.Message, e);
-				}
 
 				return planes;
 			}
@@ -103,96 +87,60 @@ namespace LibDmd.Common
 			using (Profiler.Start("FrameUtil.Join")) {
 
 				var frame = new byte[dim.Surface];
-				if (bitPlanes.Length == 2) {
-					unsafe
-					{
-						fixed (byte* pFrame = &frame[0])
-						{
-							var pfEnd = pFrame + frame.Length;
-
-							fixed (byte* plane0 = &bitPlanes[0][0], plane1 = &bitPlanes[1][0])
-							{
-								byte* pp0 = plane0;
-								byte* pp1 = plane1;
-								byte andValue = 1;
-
-								for (var pf = pFrame; pf < pfEnd; pf++) {
-									if ((*pp0 & andValue) > 0)
-										*pf |= 1;
-									if ((*pp1 & andValue) > 0)
-										*pf |= 2;
-
-									if (andValue == 0x80) {
-										pp0++;
-										pp1++;
-										andValue = 0x01;
-									} else
-										andValue <<= 1;
-								}
-							}
-						}
-					}
-				} else if (bitPlanes.Length == 4) {
-					unsafe
-					{
-						fixed (byte* pFrame = &frame[0])
-						{
-							var pfEnd = pFrame + frame.Length;
-
-							Debug.Assert(bitPlanes.Length == 4);
-							fixed (byte* plane0 = &bitPlanes[0][0], plane1 = &bitPlanes[1][0],
-								   plane2 = &bitPlanes[2][0], plane3 = &bitPlanes[3][0])
-							{
-								byte* pp0 = plane0;
-								byte* pp1 = plane1;
-								byte* pp2 = plane2;
-								byte* pp3 = plane3;
-
-								byte andValue = 1;
-
-								for (var pf = pFrame; pf < pfEnd; pf++) {
-									if ((*pp0 & andValue) > 0)
-										*pf |= 1;
-									if ((*pp1 & andValue) > 0)
-										*pf |= 2;
-									if ((*pp2 & andValue) > 0)
-										*pf |= 4;
-									if ((*pp3 & andValue) > 0)
-										*pf |= 8;
-
-									if (andValue == 0x80) {
-										pp0++;
-										pp1++;
-										pp2++;
-										pp3++;
-										andValue = 0x01;
-									} else
-										andValue <<= 1;
+				var planeSize = frame.Length / 8;
+				var fits = true;
+				foreach (var plane in bitPlanes) {
+					fits = fits && plane.Length >= planeSize;
+				}
+				if (!fits) {
+					Logger.Error("Join failed: {0}x{1} with {2} planes of {3} bytes.", dim.Width, dim.Height, bitPlanes.Length, bitPlanes.Length > 0 ? bitPlanes[0].Length : 0);
+					throw new IndexOutOfRangeException($"Cannot join {bitPlanes.Length} planes into {dim}.");
+				}
+
+				unsafe {
+					fixed (byte* pFrame = frame) {
+						var dest = (ulong*)pFrame;
+						for (var i = 0; i < bitPlanes.Length; i++) {
+							fixed (byte* pPlane = bitPlanes[i]) {
+								for (var byteIdx = 0; byteIdx < planeSize; byteIdx++) {
+									dest[byteIdx] |= ScatterBits(pPlane[byteIdx]) << i;
 								}
 							}
 						}
 					}
-				} else {
-					var planes = new BitArray[bitPlanes.Length];
-					for (var i = 0; i < bitPlanes.Length; i++) {
-						planes[i] = new BitArray(bitPlanes[i]);
-					}
-					for (var f = 0; f < frame.Length; f++) {
-						for (var p = 0; p < bitPlanes.Length; p++) {
-							try {
-								var bit = planes[p].Get(f) ? (byte)1 : (byte)0;
-								frame[f] |= (byte)(bit << p);
-							} catch (ArgumentOutOfRangeException) {
-								Logger.Error("Error retrieving pixel {0} on plane {1}. Frame size = {2}x{3}, plane size = {4}.", f, p, dim.Width, dim.Height, planes.Length);
-								throw;
-							}
-						}
-					}
 				}
 				return frame;
 			}
 		}
 
+		/// <summary>
+		/// Collects the lowest bit of each of the eight bytes of a little-endian word
+		/// into one byte, so the first byte ends up in bit 0.
+		/// </summary>
+		///
+		/// <remarks>
+		/// The multiplication shifts every isolated bit into the top byte, each to
+		/// a different position, so no two of them ever carry into each other.
+		/// </remarks>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static byte GatherBits(ulong eightPixels)
+		{
+			return (byte)(((eightPixels & 0x0101010101010101UL) * 0x0102040810204080UL) >> 56);
+		}
+
+		/// <summary>
+		/// The opposite of <see cref="GatherBits"/>: bit n of the byte becomes the lowest bit of byte n.
+		/// </summary>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static ulong ScatterBits(byte eightPixels)
+		{
+			return ScatteredBits[eightPixels];
+		}
+
+		private static readonly ulong[] ScatteredBits = Enumerable.Range(0, 256)
+			.Select(b => Enumerable.Range(0, 8).Aggregate(0UL, (word, bit) => word | ((ulong)((b >> bit) & 1) << (bit * 8))))
+			.ToArray();
+
 
 		public static unsafe ushort[] CastToUShort(byte[] byteArray)
 		{
@@ -346,21 +294,27 @@ namespace LibDmd.Common
 		/// <param name="dim">Dimensions of source plane</param>
 		/// <param name="srcPlane">Source plane (eight 1-bit pixels packed into one byte</param>
 		/// <returns>Scaled bit plane</returns>
-		private static byte[] ScaleDoublePlane(Dimensions dim, byte[] srcPlane)
+		private static unsafe byte[] ScaleDoublePlane(Dimensions dim, byte[] srcPlane)
 		{
-			var newDim = dim * 2;
-			var newPlaneSize = newDim.Surface / 8;
-			ushort[] scaledPlane = new ushort[newPlaneSize / 2]; // div 2 because, ushorts
-			var width = newDim.Width / 2 / 8;
-			for (var i = 0; i < newDim.Height; i++) {
-				for (var k = 0; k < width; k++) {
-					scaledPlane[i * width + k] = scaledPlane[(i + 1) * width + k] = doublePixel[srcPlane[i / 2 * width + k]];
+			var srcStride = dim.Width / 8;
+			if (srcPlane.Length < srcStride * dim.Height) {
+				Logger.Error("ScaleDouble failed: {0}x{1} plane:{2}", dim.Width, dim.Height, srcPlane.Length);
+				throw new IndexOutOfRangeException($"Cannot scale plane of {srcPlane.Length} bytes from {dim}.");
+			}
+
+			// each source byte becomes a ushort, and each scaled row is written twice.
+			var plane = new byte[srcStride * 4 * dim.Height];
+			fixed (byte* pSrc = srcPlane)
+			fixed (byte* pDest = plane) {
+				for (var y = 0; y < dim.Height; y++) {
+					var src = pSrc + y * srcStride;
+					var row = (ushort*)pDest + 2 * y * srcStride;
+					for (var x = 0; x < srcStride; x++) {
+						row[x] = doublePixel[src[x]];
+					}
+					Buffer.MemoryCopy(row, row + srcStride, srcStride * 2, srcStride * 2);
 				}
-				i++;
 			}
-			// copy ushorts back to bytes
-			var plane = new byte[newPlaneSize];
-			Buffer.BlockCopy(scaledPlane, 0, plane, 0, newPlaneSize);
 			return plane;
 		}
 
@@ -385,21 +339,46 @@ namespace LibDmd.Common
 		/// <param name="frame">frame data to be resized</param>
 		/// <param name="byteSize">Number of bytes per pixel</param>
 		/// <returns></returns>
-		public static byte[] ScaleDouble(Dimensions dim, byte[] frame, int byteSize)
+		public static unsafe byte[] ScaleDouble(Dimensions dim, byte[] frame, int byteSize)
 		{
 			using (Profiler.Start($"FrameUtil.ScaleDouble({byteSize})")) {
-				var outputDim = dim * 2;
-				byte[] scaledData = new byte[outputDim.Surface * byteSize];
-				const int scale = 2;
-
-				int targetIdx = 0;
-				for (var i = 0; i < outputDim.Height; ++i) {
-					var iUnscaled = i / scale;
-					for (var j = 0; j < outputDim.Width; ++j) {
-						var jUnscaled = j / scale;
-						for (var k = 0; k < byteSize; k++) {
-							scaledData[targetIdx++] = frame[iUnscaled * dim.Width * byteSize + jUnscaled * byteSize + k];
+				var stride = dim.Width * byteSize;
+				if (frame.Length < stride * dim.Height) {
+					Logger.Error("ScaleDouble failed: {0}x{1} frame:{2} byteSize:{3}", dim.Width, dim.Height, frame.Length, byteSize);
+					throw new IndexOutOfRangeException($"Cannot scale {frame.Length} bytes from {dim} at {byteSize} bytes per pixel.");
+				}
+
+				var scaledStride = stride * 2;
+				var scaledData = new byte[scaledStride * dim.Height * 2];
+
+				// double each row's pixels, then copy the row below.
+				fixed (byte* pSrc = frame)
+				fixed (byte* pDest = scaledData) {
+					for (var y = 0; y < dim.Height; y++) {
+						var src = pSrc + y * stride;
+						var row = pDest + 2 * y * scaledStride;
+						switch (byteSize) {
+							case 1:
+								for (var x = 0; x < dim.Width; x++) {
+									((ushort*)row)[x] = (ushort)(src[x] * 0x0101);
+								}
+								break;
+							case 2:
+								for (var x = 0; x < dim.Width; x++) {
+									((uint*)row)[x] = ((ushort*)src)[x] * 0x00010001u;
+								}
+								break;
+							default:
+								for (var x = 0; x < dim.Width; x++) {
+									var pixel = src + x * byteSize;
+									var scaled = row + 2 * x * byteSize;
+									for (var k = 0; k < byteSize; k++) {
+										scaled[k] = scaled[k + byteSize] = pixel[k];
+									}
+								}
+								break;
 						}
+						Buffer.MemoryCopy(row, row + scaledStride, scaledStride, scaledStride);
 					}
 				}
 				return scaledData;
@@ -409,46 +388,60 @@ namespace LibDmd.Common
 		/// <summary>
 		/// Implementation of Scale2 for RGB frame data.
 		/// </summary>
+		///
+		/// <remarks>
+		/// Pixels are compared as integers, so up to four bytes per pixel are
+		/// supported. Edges are clamped, i.e. pixels outside of the frame take
+		/// the value of the nearest edge pixel.
+		/// </remarks>
 		/// <param name="dim">Original dimensions</param>
 		/// <param name="data">Original frame data</param>
 		/// <param name="bytesPerPixel">Number of bytes per pixel</param>
 		/// <returns>scaled frame planes</returns>
-		public static byte[] Scale2X(Dimensions dim, byte[] data, int bytesPerPixel)
+		public static unsafe byte[] Scale2X(Dimensions dim, byte[] data, int bytesPerPixel)
 		{
 			using (Profiler.Start($"FrameUtil.Scale2X({bytesPerPixel})")) {
-				var targetWidth = dim.Width * 2;
-				var targetHeight = dim.Height * 2;
-				byte[] scaledData = new byte[targetWidth * targetHeight * bytesPerPixel];
-
-				var colorB = new byte[bytesPerPixel];
-				var colorH = new byte[bytesPerPixel];
-				var colorD = new byte[bytesPerPixel];
-				var colorF = new byte[bytesPerPixel];
-				var colorE = new byte[bytesPerPixel];
+				if (bytesPerPixel < 1 || bytesPerPixel > 4) {
+					throw new ArgumentOutOfRangeException(nameof(bytesPerPixel), bytesPerPixel, "Scale2X supports between 1 and 4 bytes per pixel.");
+				}
+				var stride = dim.Width * bytesPerPixel;
+				if (data.Length < stride * dim.Height) {
+					Logger.Error("Scale2X failed: {0}x{1} frame:{2} bytesPerPixel:{3}", dim.Width, dim.Height, data.Length, bytesPerPixel);
+					throw new IndexOutOfRangeException($"Cannot scale {data.Length} bytes from {dim} at {bytesPerPixel} bytes per pixel.");
+				}
 
-				for (var y = 0; y < dim.Height; y++)
-				{
-					for (var x = 0; x < dim.Width; x++)
-					{
-						ImageUtil.GetRgbPixel(x, y - 1, dim.Width, dim.Height, data, colorB);
-						ImageUtil.GetRgbPixel(x, y + 1, dim.Width, dim.Height, data, colorH);
-						ImageUtil.GetRgbPixel(x - 1, y, dim.Width, dim.Height, data, colorD);
-						ImageUtil.GetRgbPixel(x + 1, y, dim.Width, dim.Height, data, colorF);
-						ImageUtil.GetRgbPixel(x, y, dim.Width, dim.Height, data, colorE);
-
-						if (!CompareBuffers(colorB, 0, colorH, 0, bytesPerPixel) && !CompareBuffers(colorD, 0, colorF, 0, bytesPerPixel))
-						{
-							ImageUtil.SetRgbPixel(2 * x, 2 * y, CompareBuffers(colorD, 0, colorB, 0, bytesPerPixel) ? colorD : colorE, targetWidth, scaledData, bytesPerPixel);
-							ImageUtil.SetRgbPixel(2 * x + 1, 2 * y, CompareBuffers(colorB, 0, colorF, 0, bytesPerPixel) ? colorF : colorE, targetWidth, scaledData, bytesPerPixel);
-							ImageUtil.SetRgbPixel(2 * x, 2 * y + 1, CompareBuffers(colorD, 0, colorH, 0, bytesPerPixel) ? colorD : colorE, targetWidth, scaledData, bytesPerPixel);
-							ImageUtil.SetRgbPixel(2 * x + 1, 2 * y + 1, CompareBuffers(colorH, 0, colorF, 0, bytesPerPixel) ? colorF : colorE, targetWidth, scaledData, bytesPerPixel);
-						}
-						else
-						{
-							ImageUtil.SetRgbPixel(2 * x, 2 * y, colorE, targetWidth, scaledData, bytesPerPixel);
-							ImageUtil.SetRgbPixel(2 * x + 1, 2 * y, colorE, targetWidth, scaledData, bytesPerPixel);
-							ImageUtil.SetRgbPixel(2 * x, 2 * y + 1, colorE, targetWidth, scaledData, bytesPerPixel);
-							ImageUtil.SetRgbPixel(2 * x + 1, 2 * y + 1, colorE, targetWidth, scaledData, bytesPerPixel);
+				var scaledStride = stride * 2;
+				var scaledData = new byte[scaledStride * dim.Height * 2];
+
+				fixed (byte* pSrc = data)
+				fixed (byte* pDest = scaledData) {
+					for (var y = 0; y < dim.Height; y++) {
+						var rowE = pSrc + y * stride;
+						var rowB = y > 0 ? rowE - stride : rowE;
+						var rowH = y < dim.Height - 1 ? rowE + stride : rowE;
+						var scaledRow0 = pDest + 2 * y * scaledStride;
+						var scaledRow1 = scaledRow0 + scaledStride;
+
+						var x = bytesPerPixel == 1 ? Scale2XVectorized(rowB, rowE, rowH, scaledRow0, scaledRow1, dim.Width) : 0;
+						for (; x < dim.Width; x++) {
+							var offset = x * bytesPerPixel;
+							var e = ReadPixel(rowE + offset, bytesPerPixel);
+							var b = ReadPixel(rowB + offset, bytesPerPixel);
+							var h = ReadPixel(rowH + offset, bytesPerPixel);
+							var d = x > 0 ? ReadPixel(rowE + offset - bytesPerPixel, bytesPerPixel) : e;
+							var f = x < dim.Width - 1 ? ReadPixel(rowE + offset + bytesPerPixel, bytesPerPixel) : e;
+
+							uint e0 = e, e1 = e, e2 = e, e3 = e;
+							if (b != h && d != f) {
+								if (d == b) e0 = d;
+								if (b == f) e1 = f;
+								if (d == h) e2 = d;
+								if (h == f) e3 = f;
+							}
+							WritePixel(scaledRow0 + 2 * offset, bytesPerPixel, e0);
+							WritePixel(scaledRow0 + 2 * offset + bytesPerPixel, bytesPerPixel, e1);
+							WritePixel(scaledRow1 + 2 * offset, bytesPerPixel, e2);
+							WritePixel(scaledRow1 + 2 * offset + bytesPerPixel, bytesPerPixel, e3);
 						}
 					}
 				}
@@ -456,30 +449,136 @@ namespace LibDmd.Common
 			}
 		}
 
+		/// <summary>
+		/// Runs Scale2X on as many one-byte pixels of a row as fit into vectors, so
+		/// the neighbours of a whole vector of pixels are compared at once.
+		/// </summary>
+		///
+		/// <remarks>
+		/// The first pixel and the ones that don't fill a vector anymore are left
+		/// to the caller, except when the row is too short, where the first one is
+		/// left as well.
+		/// </remarks>
+		/// <returns>Index of the first pixel not yet scaled</returns>
+		private static unsafe int Scale2XVectorized(byte* rowB, byte* rowE, byte* rowH, byte* scaledRow0, byte* scaledRow1, int width)
+		{
+			var count = Vector<byte>.Count;
+			if (!Vector.IsHardwareAccelerated || width < count + 2) {
+				return 0;
+			}
+
+			// pixel 0 has no left neighbour, do it like the scalar loop.
+			var e = rowE[0];
+			var b = rowB[0];
+			var h = rowH[0];
+			var f = rowE[1];
+			scaledRow0[0] = scaledRow1[0] = e;
+			scaledRow0[1] = b != h && e != f && b == f ? f : e;
+			scaledRow1[1] = b != h && e != f && h == f ? f : e;
+
+			var x = 1;
+			for (; x + count < width; x += count) {
+				var vE = Unsafe.ReadUnaligned<Vector<byte>>(rowE + x);
+				var vB = Unsafe.ReadUnaligned<Vector<byte>>(rowB + x);
+				var vH = Unsafe.ReadUnaligned<Vector<byte>>(rowH + x);
+				var vD = Unsafe.ReadUnaligned<Vector<byte>>(rowE + x - 1);
+				var vF = Unsafe.ReadUnaligned<Vector<byte>>(rowE + x + 1);
+
+				var differs = Vector.OnesComplement(Vector.Equals(vB, vH) | Vector.Equals(vD, vF));
+				var e0 = Vector.ConditionalSelect(differs & Vector.Equals(vD, vB), vD, vE);
+				var e1 = Vector.ConditionalSelect(differs & Vector.Equals(vB, vF), vF, vE);
+				var e2 = Vector.ConditionalSelect(differs & Vector.Equals(vD, vH), vD, vE);
+				var e3 = Vector.ConditionalSelect(differs & Vector.Equals(vH, vF), vF, vE);
+
+				Interleave(e0, e1, scaledRow0 + 2 * x);
+				Interleave(e2, e3, scaledRow1 + 2 * x);
+			}
+			return x;
+		}
+
+		/// <summary>
+		/// Writes the bytes of both vectors alternately, starting with the first vector.
+		/// </summary>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static unsafe void Interleave(Vector<byte> even, Vector<byte> odd, byte* dest)
+		{
+			Vector.Widen(even, out var evenLow, out var evenHigh);
+			Vector.Widen(odd, out var oddLow, out var oddHigh);
+			Unsafe.WriteUnaligned(dest, evenLow | oddLow * (ushort)0x100);
+			Unsafe.WriteUnaligned(dest + Vector<byte>.Count, evenHigh | oddHigh * (ushort)0x100);
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static unsafe uint ReadPixel(byte* pixel, int bytesPerPixel)
+		{
+			switch (bytesPerPixel) {
+				case 1: return *pixel;
+				case 2: return *(ushort*)pixel;
+				case 3: return (uint)(pixel[0] | pixel[1] << 8 | pixel[2] << 16);
+				default: return *(uint*)pixel;
+			}
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static unsafe void WritePixel(byte* pixel, int bytesPerPixel, uint value)
+		{
+			switch (bytesPerPixel) {
+				case 1:
+					*pixel = (byte)value;
+					break;
+				case 2:
+					*(ushort*)pixel = (ushort)value;
+					break;
+				case 3:
+					pixel[0] = (byte)value;
+					pixel[1] = (byte)(value >> 8);
+					pixel[2] = (byte)(value >> 16);
+					break;
+				default:
+					*(uint*)pixel = value;
+					break;
+			}
+		}
+
 		//Scale down planes by displaying every second pixel
-		private static byte[] ScaleDown(Dimensions dim, byte[] srcPlane)
+		private static unsafe byte[] ScaleDown(Dimensions dim, byte[] srcPlane)
 		{
 			using (Profiler.Start("FrameUtil.ScaleDown")) {
 
-				var planeSize = dim.Surface / 8;
-				byte[] scaledPlane = new byte[planeSize];
-				ushort[] plane = new ushort[planeSize * 2];
-				Buffer.BlockCopy(srcPlane, 0, plane, 0, planeSize * 4);
+				var stride = dim.Width / 8;
+				if (srcPlane.Length < stride * 4 * dim.Height) {
+					Logger.Error("ScaleDown failed: {0}x{1} plane:{2}", dim.Width, dim.Height, srcPlane.Length);
+					throw new IndexOutOfRangeException($"Cannot scale plane of {srcPlane.Length} bytes down to {dim}.");
+				}
 
-				for (var i = 0; i < dim.Height*2; i++)
-				{
-					for (var k = 0; k < (dim.Width / 8); k++)
-					{
-						ushort srcVal = plane[(i * (dim.Width / 8)) + k];
-						byte destVal = (byte) ((srcVal & 0x0001) | (srcVal & 0x0004) >> 1 | (srcVal & 0x0010) >> 2 | (srcVal & 0x0040) >> 3 | (srcVal & 0x0100) >> 4 | (srcVal & 0x0400) >> 5 | (srcVal & 0x1000) >> 6 | (srcVal & 0x4000) >> 7);
-						scaledPlane[((i / 2) * (dim.Width / 8)) + k] = destVal;
+				var scaledPlane = new byte[stride * dim.Height];
+				fixed (byte* pSrc = srcPlane)
+				fixed (byte* pDest = scaledPlane) {
+					for (var y = 0; y < dim.Height; y++) {
+						// every other source row, two source bytes per destination byte
+						var src = (ushort*)pSrc + 2 * y * stride;
+						var dest = pDest + y * stride;
+						for (var x = 0; x < stride; x++) {
+							dest[x] = PackEvenBits(src[x]);
+						}
 					}
-					i++;
 				}
 				return scaledPlane;
 			}
 		}
 
+		/// <summary>
+		/// Packs bits 0, 2, 4, .. 14 into one byte, by moving them together in three steps.
+		/// </summary>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static byte PackEvenBits(uint bits)
+		{
+			bits &= 0x5555;
+			bits = (bits | (bits >> 1)) & 0x3333;
+			bits = (bits | (bits >> 2)) & 0x0F0F;
+			return (byte)(bits | (bits >> 4));
+		}
+
 		public static byte[][] ScaleDown(Dimensions dim, byte[][] srcPlanes)
 		{
 			using (Profiler.Start("FrameUtil.ScaleDown")) {
@@ -855,6 +954,87 @@ namespace LibDmd.Common
 				}
 			}
 		}
+
+		/// <summary>
+		/// Computes a 64-bit hash of the given data.
+		/// </summary>
+		/// <remarks>
+		/// This is xxHash64. It reads eight bytes at the time into four
+		/// independent lanes, so the CPU works on them in parallel, which makes
+		/// it several times faster than hashing byte by byte. It's not meant
+		/// for anything security related.
+		/// </remarks>
+		/// <param name="data">Data to hash</param>
+		/// <param name="seed">Start value, for combining several hashes</param>
+		/// <returns>Hash of the data</returns>
+		public static ulong Hash(ReadOnlySpan<byte> data, ulong seed = 0)
+		{
+			const ulong p1 = 11400714785074694791;
+			const ulong p2 = 14029467366897019727;
+			const ulong p3 = 1609587929392839161;
+			const ulong p4 = 9650029242287828579;
+			const ulong p5 = 2870177450012600261;
+
+			unchecked {
+				var words = MemoryMarshal.Cast<byte, ulong>(data);
+				var i = 0;
+				ulong hash;
+				if (data.Length >= 32) {
+					var v1 = seed + p1 + p2;
+					var v2 = seed + p2;
+					var v3 = seed;
+					var v4 = seed - p1;
+					for (; i + 4 <= words.Length; i += 4) {
+						v1 = HashRound(v1, words[i]);
+						v2 = HashRound(v2, words[i + 1]);
+						v3 = HashRound(v3, words[i + 2]);
+						v4 = HashRound(v4, words[i + 3]);
+					}
+					hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+					hash = (hash ^ HashRound(0, v1)) * p1 + p4;
+					hash = (hash ^ HashRound(0, v2)) * p1 + p4;
+					hash = (hash ^ HashRound(0, v3)) * p1 + p4;
+					hash = (hash ^ HashRound(0, v4)) * p1 + p4;
+
+				} else {
+					hash = seed + p5;
+				}
+				hash += (ulong)data.Length;
+
+				for (; i < words.Length; i++) {
+					hash ^= HashRound(0, words[i]);
+					hash = RotateLeft(hash, 27) * p1 + p4;
+				}
+				var pos = words.Length * sizeof(ulong);
+				if (pos + 4 <= data.Length) {
+					hash ^= MemoryMarshal.Read<uint>(data.Slice(pos)) * p1;
+					hash = RotateLeft(hash, 23) * p2 + p3;
+					pos += 4;
+				}
+				for (; pos < data.Length; pos++) {
+					hash ^= data[pos] * p5;
+					hash = RotateLeft(hash, 11) * p1;
+				}
+
+				hash ^= hash >> 33;
+				hash *= p2;
+				hash ^= hash >> 29;
+				hash *= p3;
+				hash ^= hash >> 32;
+				return hash;
+			}
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static ulong HashRound(ulong acc, ulong input)
+		{
+			unchecked {
+				return RotateLeft(acc + input * 14029467366897019727, 31) * 11400714785074694791;
+			}
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static ulong RotateLeft(ulong value, int offset) => (value << offset) | (value >> (64 - offset));
 	}
 }
 
@@ -1,6 +1,7 @@
 ﻿using System;
 using System.Diagnostics;
 using System.IO;
+using System.Runtime.CompilerServices;
 
 namespace LibDmd.Common.HeatShrink
 {
@@ -106,6 +107,73 @@ namespace LibDmd.Common.HeatShrink
 			return Result.res(size, Code.Ok);
 		}
 
+		/// <summary>
+		/// Decodes a complete input in one go.
+		/// </summary>
+		///
+		/// <remarks>
+		/// This gives the same output as the streaming decoder, but since all
+		/// input is available, it doesn't need to suspend and resume, and the
+		/// output serves as window. Decoding stops when the output is full, or
+		/// when the input is exhausted.
+		/// </remarks>
+		/// <param name="input">Compressed data</param>
+		/// <param name="output">Where to write the decompressed data</param>
+		/// <param name="windowSize">Window size in bits</param>
+		/// <param name="lookaheadSize">Lookahead size in bits</param>
+		/// <returns>Number of bytes written to the output</returns>
+		public static int Decode(ReadOnlySpan<byte> input, Span<byte> output, int windowSize, int lookaheadSize)
+		{
+			var pos = 0;
+			uint bits = 0;
+			var numBits = 0;
+			var written = 0;
+			while (written < output.Length) {
+				if (!TryGetBits(input, ref pos, ref bits, ref numBits, 1, out var tag)) {
+					break;
+				}
+
+				// literal
+				if (tag != 0) {
+					if (!TryGetBits(input, ref pos, ref bits, ref numBits, 8, out var literal)) {
+						break;
+					}
+					output[written++] = (byte)literal;
+					continue;
+				}
+
+				// back-reference, before the start, the window is zeroed.
+				if (!TryGetBits(input, ref pos, ref bits, ref numBits, windowSize, out var index)) {
+					break;
+				}
+				if (!TryGetBits(input, ref pos, ref bits, ref numBits, lookaheadSize, out var count)) {
+					break;
+				}
+				index++;
+				count++;
+				for (var end = Math.Min(written + count, output.Length); written < end; written++) {
+					output[written] = written >= index ? output[written - index] : (byte)0;
+				}
+			}
+			return written;
+		}
+
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static bool TryGetBits(ReadOnlySpan<byte> input, ref int pos, ref uint bits, ref int numBits, int count, out int value)
+		{
+			while (numBits < count) {
+				if (pos == input.Length) {
+					value = NoBits;
+					return false;
+				}
+				bits = (bits << 8) | input[pos++];
+				numBits += 8;
+			}
+			numBits -= count;
+			value = (int)((bits >> numBits) & ((1u << count) - 1));
+			return true;
+		}
+
 		public void Decode(Stream reader, Stream os)
 		{
 			var inbuffer = new byte[1 << _windowSize];
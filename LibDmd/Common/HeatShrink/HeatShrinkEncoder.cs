@@ -547,7 +547,7 @@ namespace LibDmd.Common.HeatShrink
 				do { // read and fill input buffer until full
 					if (remainingInInput == 0) {
 						// read some input bytes
-						remainingInInput = reader.Read(inbuffer, 0, 4096);
+						remainingInInput = reader.Read(inbuffer, 0, inbuffer.Length);
 						inputOffset = 0;
 					}
 					if (remainingInInput == 0) {
@@ -2,6 +2,7 @@
 using System.Collections.Generic;
 using System.Drawing;
 using System.Drawing.Imaging;
+using System.Runtime.CompilerServices;
 using System.Threading;
 using System.Windows;
 using System.Windows.Media;
@@ -127,45 +128,103 @@ namespace LibDmd.Common
 		/// <param name="frameRgb24">RGB24 frame, top left to bottom right, three bytes per pixel with values between 0 and 255</param>
 		/// <param name="numColors">Number of gray tones. 4 for 2 bit, 16 for 4 bit</param>
 		/// <returns>Gray2 frame, top left to bottom right, one byte per pixel with values between 0 and 3</returns>
-		public static byte[] ConvertToGray(Dimensions dim, byte[] frameRgb24, int numColors)
+		public static unsafe byte[] ConvertToGray(Dimensions dim, byte[] frameRgb24, int numColors)
 		{
 			using (Profiler.Start("ImageUtil.ConvertToGray")) {
 
-				var frame = new byte[dim.Surface];
-				var pos = 0;
-				for (var y = 0; y < dim.Height; y++) {
-					for (var x = 0; x < dim.Width * 3; x += 3) {
-						var rgbPos = y * dim.Width * 3 + x;
-
-						// convert to HSL
-						ColorUtil.RgbToHsl(frameRgb24[rgbPos], frameRgb24[rgbPos + 1], frameRgb24[rgbPos + 2], out _, out _, out var luminosity);
-						frame[pos++] = (byte)Math.Round(luminosity * (numColors - 1));
+				var surface = dim.Surface;
+				if (frameRgb24.Length < surface * 3) {
+					throw new ArgumentException($"Frame of {frameRgb24.Length} bytes is too small for {dim} in RGB24.");
+				}
+				var levels = GrayLevels(numColors);
+				var frame = new byte[surface];
+				fixed (byte* pSrc = frameRgb24) {
+					var src = pSrc;
+					for (var i = 0; i < surface; i++, src += 3) {
+						frame[i] = ToGray(src[0], src[1], src[2], levels, numColors);
 					}
 				}
 				return frame;
 			}
 		}
 
-		public static byte[] ConvertRgb565ToGray(Dimensions dim, byte[] rgb565Data, int numColors)
+		public static unsafe byte[] ConvertRgb565ToGray(Dimensions dim, byte[] rgb565Data, int numColors)
 		{
 			using (Profiler.Start("ImageUtil.ConvertRgb565ToGray")) {
 
-				var frame = new byte[dim.Surface];
-				var pos = 0;
-				for (var y = 0; y < dim.Height; y++) {
-					for (var x = 0; x < dim.Width; x++) {
-						var i = (y * dim.Width + x) * 2;
-						var (r, g, b) = ColorUtil.Rgb565ToRgb888(rgb565Data, i);
-
-						// convert to HSL
-						ColorUtil.RgbToHsl(r, g, b, out _, out _, out var luminosity);
-						frame[pos++] = (byte)Math.Round(luminosity * (numColors - 1));
+				var surface = dim.Surface;
+				if (rgb565Data.Length < surface * 2) {
+					throw new ArgumentException($"Frame of {rgb565Data.Length} bytes is too small for {dim} in RGB565.");
+				}
+				var levels = GrayLevels(numColors);
+				var frame = new byte[surface];
+				fixed (byte* pSrc = rgb565Data) {
+					var src = (ushort*)pSrc;
+					for (var i = 0; i < surface; i++) {
+						var rgb = ColorUtil.UnpackRgb565(src[i]);
+						frame[i] = ToGray((byte)rgb, (byte)(rgb >> 8), (byte)(rgb >> 16), levels, numColors);
 					}
 				}
 				return frame;
 			}
 		}
 
+		/// <summary>
+		/// Returns the gray tone of a color, which is its HSL luminosity, quantized.
+		/// </summary>
+		[MethodImpl(MethodImplOptions.AggressiveInlining)]
+		private static byte ToGray(byte r, byte g, byte b, short[] levels, int numColors)
+		{
+			var max = r > g ? r : g;
+			var min = r < g ? r : g;
+			if (b > max) max = b;
+			if (b < min) min = b;
+
+			var level = levels[max + min];
+			if (level >= 0) {
+				return (byte)level;
+			}
+
+			// same as the luminosity of ColorUtil.RgbToHsl, down to the last bit
+			var luminosity = (max / 255d + min / 255d) / 2.0d;
+			return (byte)Math.Round(luminosity * (numColors - 1));
+		}
+
+		/// <summary>
+		/// Gray tone by the sum of a color's largest and smallest component.
+		/// </summary>
+		///
+		/// <remarks>
+		/// The luminosity only depends on that sum, so the quantization can be
+		/// done with integers. Except when the result lies exactly between two
+		/// gray tones, where the floating point error of <see cref="ColorUtil.RgbToHsl"/>
+		/// decides, so these are marked with -1 and computed in floating point.
+		/// </remarks>
+		private static short[] GrayLevels(int numColors)
+		{
+			if (numColors < 1 || numColors > 256) {
+				throw new ArgumentOutOfRangeException(nameof(numColors), numColors, "Number of gray tones must be between 1 and 256.");
+			}
+			var levels = GrayLevelsCache[numColors - 1];
+			if (levels != null) {
+				return levels;
+			}
+
+			// luminosity is sum / 510, so the gray tone is round(sum * (numColors - 1) / 510)
+			levels = new short[511];
+			for (var sum = 0; sum < levels.Length; sum++) {
+				var scaled = sum * (numColors - 1);
+				var remainder = scaled % 510;
+				levels[sum] = remainder * 2 == 510
+					? (short)-1
+					: (short)(scaled / 510 + (remainder * 2 > 510 ? 1 : 0));
+			}
+			GrayLevelsCache[numColors - 1] = levels;
+			return levels;
+		}
+
+		private static readonly short[][] GrayLevelsCache = new short[256][];
+
 		/// <summary>
 		/// Converts a bitmap to a 4-bit grayscale array.
 		/// </summary>
@@ -321,18 +380,25 @@ namespace LibDmd.Common
 			return bitmap;
 		}
 
-		public static void ConvertRgb24ToBgr32(Dimensions dim, byte[] from, byte[] to)
+		public static unsafe void ConvertRgb24ToBgr32(Dimensions dim, byte[] from, byte[] to)
 		{
-			var pos = 0;
-			for (var y = 0; y < dim.Height; y++) {
-				for (var x = 0; x < dim.Width * 3; x += 3) {
-					var fromPos = dim.Width * 3 * y + x;
-					to[pos] = from[fromPos + 2];
-					to[pos + 1] = from[fromPos + 1];
-					to[pos + 2] = from[fromPos];
-					to[pos + 3] = 0;
-					pos += 4;
+			var surface = dim.Surface;
+			if (from.Length < surface * 3 || to.Length < surface * 4) {
+				throw new ArgumentException($"Cannot convert {from.Length} bytes of {dim} RGB24 into {to.Length} bytes of BGR32.");
+			}
+			if (surface == 0) {
+				return;
+			}
+			fixed (byte* pFrom = from, pTo = to) {
+				var src = pFrom;
+				var dest = (uint*)pTo;
+
+				// read four bytes per pixel, the fourth is the next pixel's red, which gets masked away.
+				for (var i = 0; i < surface - 1; i++, src += 3) {
+					var rgb = *(uint*)src;
+					dest[i] = (rgb & 0xFF) << 16 | (rgb & 0xFF00) | (rgb >> 16) & 0xFF;
 				}
+				dest[surface - 1] = (uint)(src[0] << 16 | src[1] << 8 | src[2]);
 			}
 		}
 
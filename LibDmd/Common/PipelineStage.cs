@@ -0,0 +1,204 @@
+﻿using System;
+using System.Diagnostics;
+using System.Reactive.Disposables;
+using System.Reactive.Linq;
+using System.Threading;
+using NLog;
+
+namespace LibDmd.Common
+{
+	/// <summary>
+	/// A step of the render pipeline that runs on its own thread.
+	/// </summary>
+	///
+	/// <remarks>
+	/// Work is run in the order it was posted, one item at the time. The queue
+	/// in front of the thread is bounded: when it's full, <see cref="Post"/>
+	/// waits until the stage caught up, so a slow stage slows down the one
+	/// before it instead of piling up frames. Only the stage itself can't
+	/// wait for itself, so work it posts goes past the bound.
+	///
+	/// The stage keeps track of how much of its lifetime it spent working,
+	/// which is logged when it's disposed.
+	/// </remarks>
+	public class PipelineStage : IDisposable
+	{
+		/// <summary>
+		/// Name of the stage, which is also the name of its thread.
+		/// </summary>
+		public readonly string Name;
+
+		/// <summary>
+		/// Number of work items that were run.
+		/// </summary>
+		public long Processed => Interlocked.Read(ref _processed);
+
+		/// <summary>
+		/// Number of times <see cref="Post"/> had to wait because the queue was full.
+		/// </summary>
+		public long Stalls => Interlocked.Read(ref _stalls);
+
+		/// <summary>
+		/// The share of time the thread spent working since it was started, between 0 and 1.
+		/// </summary>
+		public double Utilization {
+			get {
+				var elapsed = Stopwatch.GetTimestamp() - _started;
+				return elapsed == 0 ? 0 : (double)Interlocked.Read(ref _busyTicks) / elapsed;
+			}
+		}
+
+		private readonly object _lock = new object();
+		private readonly int _capacity;
+		private readonly Thread _thread;
+		private Action[] _queue;
+		private readonly long _started;
+		private int _head;
+		private int _count;
+		private bool _disposed;
+
+		private long _processed;
+		private long _stalls;
+		private long _busyTicks;
+
+		private static readonly Logger Logger = LogManager.GetCurrentClassLogger();
+
+		/// <param name="name">Name of the stage</param>
+		/// <param name="capacity">How many work items can wait before <see cref="Post"/> blocks</param>
+		public PipelineStage(string name, int capacity = 16)
+		{
+			Name = name;
+			_capacity = capacity;
+			_queue = new Action[capacity];
+			_started = Stopwatch.GetTimestamp();
+			_thread = new Thread(Run) {
+				Name = name,
+				IsBackground = true
+			};
+			_thread.Start();
+		}
+
+		/// <summary>
+		/// Queues work to be run on the stage's thread.
+		/// </summary>
+		///
+		/// <remarks>
+		/// Blocks while the queue is full, unless called from the stage's own
+		/// thread. Work posted after the stage was disposed is ignored.
+		/// </remarks>
+		/// <param name="work">What to run</param>
+		public void Post(Action work)
+		{
+			lock (_lock) {
+				if (_count >= _capacity && !_disposed && Thread.CurrentThread != _thread) {
+					Interlocked.Increment(ref _stalls);
+					while (_count >= _capacity && !_disposed) {
+						Monitor.Wait(_lock);
+					}
+				}
+				if (_disposed) {
+					return;
+				}
+				if (_count == _queue.Length) {
+					// posted from the stage itself, which would wait forever. queue it anyway, after what's already there.
+					Grow();
+				}
+				_queue[(_head + _count) % _queue.Length] = work;
+				_count++;
+				Monitor.PulseAll(_lock);
+			}
+		}
+
+		/// <summary>
+		/// Moves a stream onto the stage's thread without dropping anything.
+		/// </summary>
+		/// <param name="source">Items to move</param>
+		/// <typeparam name="T">Item type</typeparam>
+		/// <returns>The same items, emitted on the stage's thread</returns>
+		public IObservable<T> ObserveOn<T>(IObservable<T> source)
+		{
+			return Observable.Create<T>(observer => {
+				var subscription = source.Subscribe(
+					item => Post(() => observer.OnNext(item)),
+					error => Post(() => observer.OnError(error)),
+					() => Post(observer.OnCompleted)
+				);
+				return Disposable.Create(subscription.Dispose);
+			});
+		}
+
+		/// <summary>
+		/// Logs how busy the stage was.
+		/// </summary>
+		public void LogStatistics()
+		{
+			if (Processed == 0) {
+				return;
+			}
+			Logger.Info("[{0}] {1} items processed, {2:0.#}% utilization, {3} stalls on a full queue.",
+				Name, Processed, Utilization * 100, Stalls);
+		}
+
+		/// <summary>
+		/// Stops the thread after the work that's already queued.
+		/// </summary>
+		public void Dispose()
+		{
+			lock (_lock) {
+				if (_disposed) {
+					return;
+				}
+				_disposed = true;
+				Monitor.PulseAll(_lock);
+			}
+			if (Thread.CurrentThread != _thread) {
+				_thread.Join(TimeSpan.FromSeconds(1));
+			}
+			LogStatistics();
+		}
+
+		private void Run()
+		{
+			while (true) {
+				Action work;
+				lock (_lock) {
+					while (_count == 0 && !_disposed) {
+						Monitor.Wait(_lock);
+					}
+					if (_count == 0) {
+						return;
+					}
+					work = _queue[_head];
+					_queue[_head] = null;
+					_head = (_head + 1) % _queue.Length;
+					_count--;
+					Monitor.PulseAll(_lock);
+				}
+				Execute(work);
+			}
+		}
+
+		private void Grow()
+		{
+			var queue = new Action[_queue.Length * 2];
+			for (var i = 0; i < _count; i++) {
+				queue[i] = _queue[(_head + i) % _queue.Length];
+			}
+			_queue = queue;
+			_head = 0;
+		}
+
+		private void Execute(Action work)
+		{
+			var start = Stopwatch.GetTimestamp();
+			try {
+				work();
+
+			} catch (Exception e) {
+				Logger.Error(e, "[{0}] Error processing frame.", Name);
+			}
+			Interlocked.Add(ref _busyTicks, Stopwatch.GetTimestamp() - start);
+			Interlocked.Increment(ref _processed);
+		}
+	}
+}
@@ -0,0 +1,262 @@
+﻿using System;
+using System.Diagnostics;
+using System.Threading;
+
+namespace LibDmd.Common
+{
+	/// <summary>
+	/// A named measuring point, see <see cref="Profiler"/>.
+	/// </summary>
+	///
+	/// <remarks>
+	/// Every thread records into its own counters, so recording doesn't lock
+	/// and doesn't contend with other threads. The counters are only summed
+	/// up when a snapshot is taken.
+	///
+	/// Durations are stored in a log-linear histogram: values are grouped by
+	/// their power of two, and each group is split into 8 buckets, so
+	/// percentiles are accurate to about 12%, no matter the range.
+	/// </remarks>
+	public class Probe
+	{
+		/// <summary>
+		/// Name of the probe, e.g. "Render.Virtual DMD".
+		/// </summary>
+		public string Name { get; }
+
+		internal const int SubBucketBits = 3;
+		internal const int SubBuckets = 1 << SubBucketBits;
+		internal const int MaxExponent = 40;
+		internal const int BucketCount = 2 * SubBuckets + (MaxExponent - SubBucketBits) * SubBuckets;
+
+		private readonly ThreadLocal<Counters> _counters = new ThreadLocal<Counters>(() => new Counters(), true);
+		private long _lastMark;
+
+		internal Probe(string name)
+		{
+			Name = name;
+		}
+
+		/// <summary>
+		/// Starts timing. Dispose the returned span to stop.
+		/// </summary>
+		public ProfilerSpan Start()
+		{
+			return Profiler.Enabled ? new ProfilerSpan(this, Stopwatch.GetTimestamp()) : default;
+		}
+
+		/// <summary>
+		/// Records the time since the last mark, e.g. to measure how regularly frames arrive.
+		/// </summary>
+		public void Mark()
+		{
+			if (!Profiler.Enabled) {
+				return;
+			}
+			var now = Stopwatch.GetTimestamp();
+			var last = Interlocked.Exchange(ref _lastMark, now);
+			if (last != 0) {
+				Record(now - last);
+			}
+		}
+
+		internal void Stop(long started)
+		{
+			Record(Stopwatch.GetTimestamp() - started);
+		}
+
+		/// <summary>
+		/// Records a duration.
+		/// </summary>
+		/// <param name="ticks">Duration in <see cref="Stopwatch"/> ticks</param>
+		public void Record(long ticks)
+		{
+			if (ticks < 0) {
+				return;
+			}
+			// only this thread writes to these counters, so no need for
+			// interlocked operations. readers on other threads might see
+			// a slightly outdated value, which is fine for statistics.
+			var counters = _counters.Value;
+			counters.Count++;
+			counters.Total += ticks;
+			counters.Buckets[BucketOf(ticks)]++;
+			if (ticks > counters.Max) {
+				counters.Max = ticks;
+			}
+		}
+
+		/// <summary>
+		/// Sums up the counters of all threads.
+		/// </summary>
+		public ProbeSnapshot Snapshot()
+		{
+			long count = 0, total = 0, max = 0;
+			var buckets = new long[BucketCount];
+			foreach (var counters in _counters.Values) {
+				count += Interlocked.Read(ref counters.Count);
+				total += Interlocked.Read(ref counters.Total);
+				max = Math.Max(max, Interlocked.Read(ref counters.Max));
+				for (var i = 0; i < BucketCount; i++) {
+					buckets[i] += Interlocked.Read(ref counters.Buckets[i]);
+				}
+			}
+			return new ProbeSnapshot(Name, count, total, max, buckets);
+		}
+
+		internal void Reset()
+		{
+			foreach (var counters in _counters.Values) {
+				Interlocked.Exchange(ref counters.Count, 0);
+				Interlocked.Exchange(ref counters.Total, 0);
+				Interlocked.Exchange(ref counters.Max, 0);
+				for (var i = 0; i < BucketCount; i++) {
+					Interlocked.Exchange(ref counters.Buckets[i], 0);
+				}
+			}
+			Interlocked.Exchange(ref _lastMark, 0);
+		}
+
+		/// <summary>
+		/// Returns the histogram bucket of a value.
+		/// </summary>
+		internal static int BucketOf(long value)
+		{
+			if (value < 2 * SubBuckets) {
+				return (int)value;
+			}
+			var exponent = Log2(value);
+			if (exponent > MaxExponent) {
+				return BucketCount - 1;
+			}
+			var subBucket = (int)(value >> (exponent - SubBucketBits)) & (SubBuckets - 1);
+			return 2 * SubBuckets + (exponent - SubBucketBits - 1) * SubBuckets + subBucket;
+		}
+
+		/// <summary>
+		/// Returns the smallest value that falls into a bucket.
+		/// </summary>
+		internal static long LowestOf(int bucket)
+		{
+			if (bucket < 2 * SubBuckets) {
+				return bucket;
+			}
+			var exponent = (bucket - 2 * SubBuckets) / SubBuckets + SubBucketBits + 1;
+			var subBucket = (bucket - 2 * SubBuckets) % SubBuckets;
+			return (long)(SubBuckets + subBucket) << (exponent - SubBucketBits);
+		}
+
+		private static int Log2(long value)
+		{
+			var log = 0;
+			if (value >= 1L << 32) { value >>= 32; log += 32; }
+			if (value >= 1L << 16) { value >>= 16; log += 16; }
+			if (value >= 1L << 8) { value >>= 8; log += 8; }
+			if (value >= 1L << 4) { value >>= 4; log += 4; }
+			if (value >= 1L << 2) { value >>= 2; log += 2; }
+			if (value >= 1L << 1) { log += 1; }
+			return log;
+		}
+
+		private class Counters
+		{
+			public long Count;
+			public long Total;
+			public long Max;
+			public readonly long[] Buckets = new long[BucketCount];
+		}
+	}
+
+	/// <summary>
+	/// The values of a <see cref="Probe"/> at a given time.
+	/// </summary>
+	public class ProbeSnapshot
+	{
+		public string Name { get; }
+
+		/// <summary>
+		/// Number of recorded durations.
+		/// </summary>
+		public long Count { get; }
+
+		/// <summary>
+		/// Sum of all durations in milliseconds.
+		/// </summary>
+		public double TotalMs => ToMs(_total);
+
+		/// <summary>
+		/// Average duration in milliseconds.
+		/// </summary>
+		public double MeanMs => Count == 0 ? 0 : ToMs(_total) / Count;
+
+		/// <summary>
+		/// Longest duration in milliseconds.
+		/// </summary>
+		public double MaxMs => ToMs(_max);
+
+		private readonly long _total;
+		private readonly long _max;
+		private readonly long[] _buckets;
+
+		internal ProbeSnapshot(string name, long count, long total, long max, long[] buckets)
+		{
+			Name = name;
+			Count = count;
+			_total = total;
+			_max = max;
+			_buckets = buckets;
+		}
+
+		/// <summary>
+		/// Returns the duration below which a given share of all durations fall.
+		/// </summary>
+		/// <param name="percentile">Percentile, between 0 and 100</param>
+		/// <returns>Duration in milliseconds</returns>
+		public double PercentileMs(double percentile)
+		{
+			if (Count == 0) {
+				return 0;
+			}
+			var rank = (long)Math.Ceiling(percentile / 100 * Count);
+			long seen = 0;
+			for (var i = 0; i < _buckets.Length; i++) {
+				seen += _buckets[i];
+				if (seen >= rank && _buckets[i] > 0) {
+					// middle of the bucket, but never more than the max.
+					var low = Probe.LowestOf(i);
+					var high = i + 1 < _buckets.Length ? Probe.LowestOf(i + 1) - 1 : low;
+					return ToMs(Math.Min(_max, (low + high) / 2));
+				}
+			}
+			return MaxMs;
+		}
+
+		/// <summary>
+		/// Returns what was recorded between a previous snapshot and this one.
+		/// </summary>
+		///
+		/// <remarks>
+		/// The max of the result comes from the histogram, since the probe only
+		/// knows its overall max.
+		/// </remarks>
+		public ProbeSnapshot Since(ProbeSnapshot previous)
+		{
+			var buckets = new long[_buckets.Length];
+			long max = 0;
+			for (var i = 0; i < buckets.Length; i++) {
+				buckets[i] = Math.Max(0, _buckets[i] - previous._buckets[i]);
+				if (buckets[i] > 0) {
+					max = i + 1 < buckets.Length ? Probe.LowestOf(i + 1) - 1 : Probe.LowestOf(i);
+				}
+			}
+			return new ProbeSnapshot(Name, Math.Max(0, Count - previous.Count), Math.Max(0, _total - previous._total), Math.Min(max, _max), buckets);
+		}
+
+		private static double ToMs(long ticks) => (double)ticks * 1000 / Stopwatch.Frequency;
+
+		public override string ToString()
+		{
+			return $"{Name}: {Count}x, avg {MeanMs:0.000}ms, p50 {PercentileMs(50):0.000}ms, p99 {PercentileMs(99):0.000}ms, max {MaxMs:0.000}ms";
+		}
+	}
+}
@@ -1,149 +1,173 @@
 ﻿using System;
-#if DEBUG
+using System.Collections.Concurrent;
 using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Text;
+using System.Threading;
 using NLog;
-#endif
 
 namespace LibDmd.Common
 {
+	/// <summary>
+	/// Collects timings of the render pipeline through named <see cref="Probe"/>s.
+	/// </summary>
+	///
+	/// <remarks>
+	/// This is compiled into release builds as well, so stutter can be diagnosed
+	/// on cabinets. When disabled, <see cref="Start"/> only checks a flag and
+	/// returns an empty span, so call sites can stay in hot paths.
+	///
+	/// For the hottest paths, keep the probe in a static field instead of
+	/// looking it up by name on each call.
+	/// </remarks>
 	public static class Profiler
 	{
+		/// <summary>
+		/// If false, probes don't record anything.
+		/// </summary>
 #if DEBUG
+		public static volatile bool Enabled = true;
+#else
+		public static volatile bool Enabled;
+#endif
 
-		private static readonly Dictionary<string, Profile> Profiles = new Dictionary<string, Profile>();
-		private static List<Profile> RootProfiles { get; } = new List<Profile>();
-		private static Profile _parent;
+		private static readonly ConcurrentDictionary<string, Probe> Probes = new ConcurrentDictionary<string, Probe>();
+		private static readonly object ReportLock = new object();
+		private static Timer _reportTimer;
+		private static Dictionary<string, ProbeSnapshot> _lastReport = new Dictionary<string, ProbeSnapshot>();
 
 		private static readonly Logger Logger = LogManager.GetCurrentClassLogger();
-#endif
-		public static IDisposable Start(string key)
-		{
-#if DEBUG
-			lock (Profiles) {
-				if (Profiles.TryGetValue(key, out var profile)) {
-					profile.Start();
-				} else {
-					_parent = new Profile(key, _parent);
-					Profiles.Add(key, _parent);
-					if (_parent.Parent == null) {
-						RootProfiles.Add(_parent);
-					}
-				}
-			}
-			return new ProfilerSpan(key);
-#else
-			return null;
-#endif
-		}
 
-		public static void Stop(string key)
+		/// <summary>
+		/// Returns the probe of the given name, and creates it if necessary.
+		/// </summary>
+		public static Probe GetProbe(string name) => Probes.GetOrAdd(name, n => new Probe(n));
+
+		/// <summary>
+		/// Starts timing a probe. Dispose the returned span to stop.
+		/// </summary>
+		/// <param name="key">Name of the probe</param>
+		public static ProfilerSpan Start(string key)
 		{
-#if DEBUG
-			Profiles[key].Stop();
-			_parent = Profiles[key].Parent;
-#endif
+			return Enabled ? GetProbe(key).Start() : default;
 		}
 
-		public static void Print()
+		/// <summary>
+		/// Returns the current values of all probes that have recorded something.
+		/// </summary>
+		public static List<ProbeSnapshot> Snapshot()
 		{
-#if DEBUG
-			Logger.Debug("Profiling data:");
-			RootProfiles.ForEach(p => p.Print());
-#endif
+			return Probes.Values
+				.Select(p => p.Snapshot())
+				.Where(s => s.Count > 0)
+				.OrderBy(s => s.Name)
+				.ToList();
 		}
 
-		public static void Reset()
+		/// <summary>
+		/// Enables probes and periodically writes what was recorded since the last report.
+		/// </summary>
+		/// <param name="interval">Time between reports</param>
+		/// <param name="path">File to append the reports to. If null, they go to the log.</param>
+		public static void StartReporting(TimeSpan interval, string path = null)
 		{
-#if DEBUG
-			Profiles.Clear();
-			RootProfiles.Clear();
-			_parent = null;
-#endif
+			lock (ReportLock) {
+				_reportTimer?.Dispose();
+				_lastReport = Snapshot().ToDictionary(s => s.Name);
+				_reportTimer = new Timer(_ => Report(path), null, interval, interval);
+			}
+			Enabled = true;
+			Logger.Info("Profiler enabled, reporting every {0}s to {1}.", interval.TotalSeconds, path ?? "the log");
 		}
-	}
 
-#if DEBUG
-	public readonly struct ProfilerSpan : IDisposable
-	{
-		private readonly string _key;
-		public ProfilerSpan(string key)
+		/// <summary>
+		/// Stops periodic reports.
+		/// </summary>
+		public static void StopReporting()
 		{
-			_key = key;
+			lock (ReportLock) {
+				_reportTimer?.Dispose();
+				_reportTimer = null;
+			}
 		}
-		public void Dispose()
+
+		/// <summary>
+		/// Logs the current values of all probes.
+		/// </summary>
+		public static void Print()
 		{
-			Profiler.Stop(_key);
+			Logger.Debug("Profiling data:");
+			Snapshot().ForEach(s => Logger.Debug("   " + s));
 		}
-	}
 
-	class Profile
-	{
-		public string Name { get; }
-		public Profile Parent { get; }
-		public List<Profile> Children { get; } = new List<Profile>();
-		public bool IsRunning;
-
-		private readonly int _level;
-		private long _started;
-		private long _totalTicks;
-		private long _count;
-		private long _minTicks;
-		private long _maxTicks;
-		private int _drops;
-
-		private static readonly Logger Logger = LogManager.GetCurrentClassLogger();
-
-		public Profile(string name, Profile parent)
+		/// <summary>
+		/// Clears the values of all probes.
+		/// </summary>
+		public static void Reset()
 		{
-			Name = name;
-			Parent = parent;
-			_level = parent?._level + 1 ?? 0;
-			parent?.Children.Add(this);
-			Start();
+			foreach (var probe in Probes.Values) {
+				probe.Reset();
+			}
+			lock (ReportLock) {
+				_lastReport.Clear();
+			}
 		}
 
-		public void Start()
+		private static void Report(string path)
 		{
-			if (IsRunning) {
-				_drops++;
-				// don't measure if caused drop
-				IsRunning = false;
+			List<ProbeSnapshot> delta;
+			lock (ReportLock) {
+				var current = Snapshot();
+				delta = current
+					.Select(s => _lastReport.TryGetValue(s.Name, out var last) ? s.Since(last) : s)
+					.Where(s => s.Count > 0)
+					.ToList();
+				_lastReport = current.ToDictionary(s => s.Name);
+			}
+			if (delta.Count == 0) {
 				return;
 			}
-			_started = DateTime.Now.Ticks;
-			IsRunning = true;
-		}
 
-		public void Stop()
-		{
-			if (!IsRunning) {
+			if (path == null) {
+				Logger.Info("[profiler] Timings since last report:");
+				delta.ForEach(s => Logger.Info("[profiler]    " + s));
 				return;
 			}
-			Children.ForEach(c => c.Stop());
-
-			var ticks = DateTime.Now.Ticks - _started;
-			_totalTicks += ticks;
-			_count++;
-			_maxTicks = Math.Max(_maxTicks, ticks);
-			_minTicks = _minTicks == 0 ? ticks : Math.Min(_minTicks, ticks);
-			IsRunning = false;
+
+			try {
+				var sb = new StringBuilder();
+				sb.AppendLine($"{DateTime.Now:yyyy-MM-dd HH:mm:ss.fff}");
+				delta.ForEach(s => sb.AppendLine("   " + s));
+				File.AppendAllText(path, sb.ToString());
+
+			} catch (Exception e) {
+				Logger.Warn("[profiler] Cannot write to {0}: {1}", path, e.Message);
+			}
 		}
+	}
 
-		public void Print()
+	/// <summary>
+	/// A running measurement of a probe. Stops when disposed.
+	/// </summary>
+	///
+	/// <remarks>
+	/// This is a struct, so <c>using (Profiler.Start(..))</c> doesn't allocate.
+	/// </remarks>
+	public readonly struct ProfilerSpan : IDisposable
+	{
+		private readonly Probe _probe;
+		private readonly long _started;
+
+		internal ProfilerSpan(Probe probe, long started)
 		{
-			Logger.Debug(this);
-			Children.ForEach(c => c.Print());
+			_probe = probe;
+			_started = started;
 		}
 
-		public override string ToString()
-		{ 
-			const int precision = 1000;
-			var avgMs = Math.Round((double)_totalTicks / _count / TimeSpan.TicksPerMillisecond * precision) / precision;
-			var minMs = Math.Round((double)_minTicks / TimeSpan.TicksPerMillisecond * precision) / precision;
-			var maxMs = Math.Round((double)_maxTicks / TimeSpan.TicksPerMillisecond * precision) / precision;
-			var str = $"{Name}: {avgMs}ms ({minMs}/{maxMs}), {_count}x, {_drops} drop(s)";
-			return str.PadLeft(str.Length + _level * 3);
+		public void Dispose()
+		{
+			_probe?.Stop(_started);
 		}
 	}
-#endif
-}
\ No newline at end of file
+}
@@ -100,8 +100,8 @@ namespace LibDmd.Converter
 			}
 #endif
 			_lastDmdFrame = PadSmallFrames && frame.Dimensions.IsSmallerThan(Dimensions.Standard)
-				? DmdFrame.GetFromPool().Update(Dimensions.Standard, frame.CenterFrame(Dimensions.Standard, frame.Data, frame.BytesPerPixel), frame.BitLength)
-				: DmdFrame.GetFromPool().Update(frame);
+				? new DmdFrame().Update(Dimensions.Standard, frame.CenterFrame(Dimensions.Standard, frame.Data, frame.BytesPerPixel), frame.BitLength)
+				: new DmdFrame().Update(frame);
 		}
 
 		/// <summary>
@@ -136,11 +136,26 @@ namespace LibDmd.Converter
 		{
 		}
 
+		/// <summary>
+		/// Stops the 60Hz clock. The caller then clocks the converter through
+		/// <see cref="Tick()"/>, which makes it run synchronously, e.g. when
+		/// benchmarking.
+		/// </summary>
+		public void StopClock()
+		{
+			_clock?.Dispose();
+		}
+
+		/// <summary>
+		/// Sends the last received frame to <see cref="ConvertClocked(LibDmd.Frame.DmdFrame)"/> on the calling thread.
+		/// </summary>
+		public void Tick() => Tick(0);
+
 		private void Tick(long _)
 		{
-			if (_lastDmdFrame != null) {
-				ConvertClocked(_lastDmdFrame);
-				_lastDmdFrame?.ReturnToPool();
+			var lastDmdFrame = _lastDmdFrame;
+			if (lastDmdFrame != null) {
+				ConvertClocked(lastDmdFrame);
 			}
 
 			if (_lastAlphanumFrame != null) {
@@ -148,7 +163,12 @@ namespace LibDmd.Converter
 			}
 		}
 
-		public void Dispose()
+		/// <summary>
+		/// Stops the clock. Converters holding native or file resources must
+		/// override this and call the base, since render graphs only know the
+		/// converter as <see cref="AbstractConverter"/>.
+		/// </summary>
+		public virtual void Dispose()
 		{
 			_lastDmdFrame = null;
 			_lastAlphanumFrame = null;
@@ -18,6 +18,12 @@ namespace LibDmd.Converter.Vni
 			_altcolorPath = PathUtil.GetVpmFolder("altcolor", "[serum]");
 		}
 
+		/// <param name="altcolorPath">Folder containing a colorization folder per game, instead of VPM's.</param>
+		public ColorizationLoader(string altcolorPath)
+		{
+			_altcolorPath = altcolorPath;
+		}
+
 		public AbstractConverter LoadSerum(string gameName, ScalerMode scalerMode)
 		{
 			if (_altcolorPath == null) {
@@ -0,0 +1,145 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Runtime.CompilerServices;
+using LibDmd.Common;
+using LibDmd.Frame;
+
+namespace LibDmd.Converter
+{
+	/// <summary>
+	/// A least recently used cache of converted frames, keyed by the input
+	/// planes and the converter state that affects the output.
+	/// </summary>
+	///
+	/// <remarks>
+	/// ROMs repeat the same frames all the time, and converters that get
+	/// frames at 60Hz see the same frame many times in a row. On a hit, the
+	/// input is compared byte by byte, so a hash collision never returns the
+	/// wrong frame.
+	///
+	/// The key is hashed from the planes, not taken from <see cref="DmdFrame.Hash"/>,
+	/// since animation frames come as planes without a frame, and planes are
+	/// smaller than the frame data anyway.
+	///
+	/// Only use this if the output depends on nothing else than the key, and
+	/// clear it when anything else changes. Not thread-safe, converters get
+	/// their frames from one thread.
+	/// </remarks>
+	public class FrameCache<T> where T : class
+	{
+		/// <summary>
+		/// Number of frames returned from the cache.
+		/// </summary>
+		public long Hits { get; private set; }
+
+		/// <summary>
+		/// Number of frames that had to be converted.
+		/// </summary>
+		public long Misses { get; private set; }
+
+		/// <summary>
+		/// Ratio of frames returned from the cache, between 0 and 1.
+		/// </summary>
+		public double HitRate => Hits + Misses == 0 ? 0 : (double)Hits / (Hits + Misses);
+
+		private readonly int _capacity;
+		private readonly Dictionary<ulong, LinkedListNode<Entry>> _entries;
+		private readonly LinkedList<Entry> _lru = new LinkedList<Entry>();
+
+		/// <param name="capacity">Maximal number of frames to keep</param>
+		public FrameCache(int capacity)
+		{
+			_capacity = capacity;
+			_entries = new Dictionary<ulong, LinkedListNode<Entry>>(capacity);
+		}
+
+		/// <summary>
+		/// Returns the cached output for the given input, or converts and adds it.
+		/// </summary>
+		/// <param name="dim">Dimensions of the input</param>
+		/// <param name="planes">Input planes. They are copied when added, so they can be reused.</param>
+		/// <param name="state">Converter state the output depends on, compared by reference</param>
+		/// <param name="convert">Converts the input, if not cached</param>
+		public T GetOrAdd(Dimensions dim, byte[][] planes, object state, Func<T> convert)
+		{
+			var hash = Seed(dim, planes.Length, state);
+			foreach (var plane in planes) {
+				hash = FrameUtil.Hash(plane, hash);
+			}
+
+			if (_entries.TryGetValue(hash, out var node) && node.Value.Matches(dim, planes, state)) {
+				_lru.Remove(node);
+				_lru.AddFirst(node);
+				Hits++;
+				return node.Value.Output;
+			}
+
+			Misses++;
+			var output = convert();
+			if (node != null) {
+				_lru.Remove(node);
+				_entries.Remove(hash);
+			}
+			if (_entries.Count >= _capacity) {
+				_entries.Remove(_lru.Last.Value.Hash);
+				_lru.RemoveLast();
+			}
+			_entries[hash] = _lru.AddFirst(new Entry(hash, dim, planes, state, output));
+			return output;
+		}
+
+		/// <summary>
+		/// Removes all frames, but keeps the statistics.
+		/// </summary>
+		public void Clear()
+		{
+			_entries.Clear();
+			_lru.Clear();
+		}
+
+		public override string ToString()
+		{
+			return $"{Hits} hits, {Misses} misses ({HitRate:P0})";
+		}
+
+		private static ulong Seed(Dimensions dim, int numPlanes, object state)
+		{
+			return (ulong)RuntimeHelpers.GetHashCode(state) << 32 ^ (ulong)dim.Width << 20 ^ (ulong)dim.Height << 8 ^ (uint)numPlanes;
+		}
+
+		private class Entry
+		{
+			public readonly ulong Hash;
+			public readonly T Output;
+
+			private readonly Dimensions _dim;
+			private readonly byte[][] _planes;
+			private readonly object _state;
+
+			public Entry(ulong hash, Dimensions dim, byte[][] planes, object state, T output)
+			{
+				Hash = hash;
+				Output = output;
+				_dim = dim;
+				_state = state;
+				_planes = new byte[planes.Length][];
+				for (var i = 0; i < planes.Length; i++) {
+					_planes[i] = (byte[])planes[i].Clone();
+				}
+			}
+
+			public bool Matches(Dimensions dim, byte[][] planes, object state)
+			{
+				if (_state != state || _dim != dim || _planes.Length != planes.Length) {
+					return false;
+				}
+				for (var i = 0; i < planes.Length; i++) {
+					if (!new ReadOnlySpan<byte>(_planes[i]).SequenceEqual(planes[i])) {
+						return false;
+					}
+				}
+				return true;
+			}
+		}
+	}
+}
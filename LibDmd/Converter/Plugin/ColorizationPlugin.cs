@@ -159,7 +159,7 @@ namespace LibDmd.Converter.Plugin
 			}
 		}
 
-		public new void Dispose()
+		public override void Dispose()
 		{
 			base.Dispose();
 
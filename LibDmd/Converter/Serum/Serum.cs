@@ -43,6 +43,7 @@ namespace LibDmd.Converter.Serum
 		private IDisposable _rotator;
 
 		private bool _frameEventsInitialized;
+		private bool _disposed;
 
 		private readonly Subject<ColoredFrame> _coloredGray6Frames = new Subject<ColoredFrame>();
 		private readonly Subject<DmdFrame> _rgb565Frames = new Subject<DmdFrame>();
@@ -113,8 +114,13 @@ namespace LibDmd.Converter.Serum
 			Logger.Info($"[serum] Found {NumTriggersAvailable} triggers to emit.");
 		}
 
-		public new void Dispose()
+		public override void Dispose()
 		{
+			// shared by all render graphs, which all dispose it.
+			if (_disposed) {
+				return;
+			}
+			_disposed = true;
 			StopRotating();
 			base.Dispose();
 			Serum_Dispose();
@@ -47,6 +47,8 @@ namespace LibDmd.Converter.Serum
 			if (serumFrame.Palette != null) {
 				Marshal.Copy(serumFrame.Palette, _bytePalette, 0, _bytePalette.Length);
 			}
+			// the previous frame might still be rendered, so don't overwrite its data.
+			_frame.Update(new byte[_dimensions.Surface], _frame.BitLength);
 			Marshal.Copy(serumFrame.Frame, _frame.Data, 0, _dimensions.Width * _dimensions.Height);
 			BytesToColors(_bytePalette, _colorPalette);
 
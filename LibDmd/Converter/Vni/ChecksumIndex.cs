@@ -0,0 +1,101 @@
+﻿using System.Collections.Generic;
+
+namespace LibDmd.Converter.Vni
+{
+	/// <summary>
+	/// A read-only lookup of values by plane checksum, built once at load time.
+	/// </summary>
+	///
+	/// <remarks>
+	/// Most planes don't match anything, so lookups first go through a small
+	/// bloom filter that rejects nearly all misses without touching the table.
+	/// The table itself is open-addressed with linear probing and at most half
+	/// full, and since the keys are CRCs, their low bits are used as they are.
+	/// </remarks>
+	/// <typeparam name="T">Value type</typeparam>
+	public class ChecksumIndex<T> where T : class
+	{
+		/// <summary>
+		/// Number of entries in the index
+		/// </summary>
+		public readonly int Count;
+
+		private readonly uint[] _checksums;
+		private readonly T[] _values;
+		private readonly int _slotMask;
+
+		private readonly ulong[] _filter;
+		private readonly uint _filterMask;
+
+		private const int FilterBitsPerEntry = 16;
+		private const uint FilterMultiplier = 0x9E3779B1;
+
+		/// <param name="entries">Values by checksum. Can be null, resulting in an empty index.</param>
+		public ChecksumIndex(IDictionary<uint, T> entries)
+		{
+			Count = entries?.Count ?? 0;
+
+			var numSlots = 4;
+			while (numSlots < Count * 2) {
+				numSlots <<= 1;
+			}
+			var numFilterBits = 64;
+			while (numFilterBits < Count * FilterBitsPerEntry) {
+				numFilterBits <<= 1;
+			}
+
+			_checksums = new uint[numSlots];
+			_values = new T[numSlots];
+			_slotMask = numSlots - 1;
+			_filter = new ulong[numFilterBits / 64];
+			_filterMask = (uint)numFilterBits - 1;
+
+			if (entries == null) {
+				return;
+			}
+			foreach (var entry in entries) {
+				var slot = (int)entry.Key & _slotMask;
+				while (_values[slot] != null) {
+					slot = (slot + 1) & _slotMask;
+				}
+				_checksums[slot] = entry.Key;
+				_values[slot] = entry.Value;
+
+				var bit = entry.Key & _filterMask;
+				_filter[bit >> 6] |= 1ul << (int)(bit & 63);
+				bit = (entry.Key * FilterMultiplier >> 7) & _filterMask;
+				_filter[bit >> 6] |= 1ul << (int)(bit & 63);
+			}
+		}
+
+		/// <summary>
+		/// Looks up the value of a checksum.
+		/// </summary>
+		/// <param name="checksum">Checksum to look up</param>
+		/// <param name="value">The value, or null if not found</param>
+		/// <returns>True if found, false otherwise</returns>
+		public bool TryGetValue(uint checksum, out T value)
+		{
+			value = null;
+
+			var bit = checksum & _filterMask;
+			if ((_filter[bit >> 6] & (1ul << (int)(bit & 63))) == 0) {
+				return false;
+			}
+			bit = (checksum * FilterMultiplier >> 7) & _filterMask;
+			if ((_filter[bit >> 6] & (1ul << (int)(bit & 63))) == 0) {
+				return false;
+			}
+
+			var slot = (int)checksum & _slotMask;
+			while (_values[slot] != null) {
+				if (_checksums[slot] == checksum) {
+					value = _values[slot];
+					return true;
+				}
+				slot = (slot + 1) & _slotMask;
+			}
+			return false;
+		}
+	}
+}
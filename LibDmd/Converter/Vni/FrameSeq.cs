@@ -2,6 +2,7 @@
 using System.Collections.Generic;
 using System.Drawing.Imaging;
 using System.IO;
+using System.Linq;
 using System.Windows.Media;
 using LibDmd.Common;
 using LibDmd.Frame;
@@ -16,7 +17,7 @@ namespace LibDmd.Converter.Vni
 		/// <summary>
 		/// Number of frames contained in this animation
 		/// </summary>
-		public int NumFrames => Frames.Length;
+		public int NumFrames { get; protected set; }
 
 		/// <summary>
 		/// Offset of this animation in the VNI file
@@ -30,7 +31,23 @@ namespace LibDmd.Converter.Vni
 		/// <summary>
 		/// D Biudr vo dr Animazion
 		/// </summary>
-		protected AnimationFrame[] Frames;
+		///
+		/// <remarks>
+		/// Decoded when first accessed, i.e. when the animation is played.
+		/// </remarks>
+		protected AnimationFrame[] Frames => _frames ?? (_frames = ReadFrames());
+
+		/// <summary>
+		/// True if the frames have been decoded.
+		/// </summary>
+		internal bool IsDecoded => _frames != null;
+
+		private AnimationFrame[] _frames;
+
+		/// <summary>
+		/// Set if decoding failed, so a broken animation isn't decoded again every time it's triggered.
+		/// </summary>
+		private bool _decodeFailed;
 
 		/// <summary>
 		/// D Lengi vo dr ganzä Animazio i Millisekundä
@@ -100,6 +117,13 @@ namespace LibDmd.Converter.Vni
 
 		protected byte[][] Masks;
 
+		private PlaneChecksums _planeChecksums;
+
+		/// <summary>
+		/// Indices of the frames by hash, for detecting the frames to follow or layer.
+		/// </summary>
+		private ChecksumIndex<int[]> _framesByHash;
+
 		private readonly List<byte[]> _lcmBufferPlanes = new List<byte[]>();
 
 		protected static readonly Logger Logger = LogManager.GetCurrentClassLogger();
@@ -109,6 +133,30 @@ namespace LibDmd.Converter.Vni
 			Offset = offset;
 		}
 
+		/// <summary>
+		/// Reads and decodes the frames of the animation.
+		/// </summary>
+		protected abstract AnimationFrame[] ReadFrames();
+
+		/// <summary>
+		/// Decodes the frames, if not done yet.
+		/// </summary>
+		/// <returns>False if the frames couldn't be decoded</returns>
+		public bool Decode()
+		{
+			if (_decodeFailed) {
+				return false;
+			}
+			try {
+				return Frames != null;
+
+			} catch (Exception e) {
+				_decodeFailed = true;
+				Logger.Warn(e, "[vni] Cannot decode animation \"{0}\": {1}", Name, e.Message);
+				return false;
+			}
+		}
+
 		/// <summary>
 		/// Tuät d Animazion startä.
 		/// </summary>
@@ -189,64 +237,93 @@ namespace LibDmd.Converter.Vni
 			return outPlanes;
 		}
 
-		public void DetectFollow(byte[] plane, uint NoMaskCRC, byte[][] masks, bool Reverse)
+		/// <summary>
+		/// Jumps to the first frame matching one of the plane's checksums.
+		/// </summary>
+		/// <param name="checksums">Checksums of the plane without and with the masks of the .pal file</param>
+		public void DetectFollow(uint[] checksums)
 		{
-			var frameIndex = 0;
-			foreach (var af in Frames)
+			var frameIndex = int.MaxValue;
+			foreach (var checksum in checksums)
 			{
-				if (NoMaskCRC == af.Hash)
-				{
-					_frameIndex = frameIndex;
-					return;
-				}
-				if (masks != null && masks.Length > 0)
+				if (FramesByHash.TryGetValue(checksum, out var frameIndices) && frameIndices[0] < frameIndex)
 				{
-					foreach (var mask in masks)
-					{
-						var maskcrc = FrameUtil.ChecksumWithMask(plane, mask, Reverse);
-						if (maskcrc == af.Hash)
-						{
-							_frameIndex = frameIndex;
-							return;
-						}
-					}
+					frameIndex = frameIndices[0];
 				}
-				frameIndex++;
+			}
+			if (frameIndex != int.MaxValue)
+			{
+				_frameIndex = frameIndex;
 			}
 		}
 
-		public bool DetectLCM(byte[] plane, uint NoMaskCRC, bool Reverse, bool clear)
+		/// <summary>
+		/// Adds all frames matching the plane, without or with any of the
+		/// animation's masks, to the LCM buffer.
+		/// </summary>
+		/// <param name="planeIndex">Which plane of the frame this is</param>
+		/// <param name="plane">Plane data</param>
+		/// <param name="Reverse">If set, reverse the bits of every byte before hashing</param>
+		/// <param name="clear">If set, clear the LCM buffer before adding the first match</param>
+		/// <returns>False if the buffer was cleared, otherwise the value of clear</returns>
+		public bool DetectLCM(int planeIndex, byte[] plane, bool Reverse, bool clear)
 		{
-			uint checksum = NoMaskCRC;
+			if (_planeChecksums == null)
+			{
+				_planeChecksums = new PlaneChecksums(Masks);
+			}
 
-			for (int k = -1; k < Masks.Length; k++)
+			foreach (var checksum in _planeChecksums.Compute(planeIndex, plane, Reverse))
 			{
-				if (k >= 0)
+				if (!FramesByHash.TryGetValue(checksum, out var frameIndices))
 				{
-					checksum = FrameUtil.ChecksumWithMask(plane, Masks[k], Reverse);
+					continue;
 				}
-				foreach (var af in Frames)
+				foreach (var frameIndex in frameIndices)
 				{
-					if (af.Hash == checksum)
+					var af = Frames[frameIndex];
+					if (clear)
 					{
-						if (clear)
-						{
-							ClearLCMBuffer();
-							clear = false;
-							if (SwitchMode == SwitchMode.MaskedReplace)
-								FrameUtil.ClearPlane(ReplaceMask);
-						}
+						ClearLCMBuffer();
+						clear = false;
+						if (SwitchMode == SwitchMode.MaskedReplace)
+							FrameUtil.ClearPlane(ReplaceMask);
+					}
 
-						for (int i = 0; i < af.Planes.Count; i++)
+					for (int i = 0; i < af.Planes.Count; i++)
+					{
+						FrameUtil.OrPlane(af.PlaneData[i], _lcmBufferPlanes[i]);
+						if (SwitchMode == SwitchMode.MaskedReplace)
+							FrameUtil.OrPlane(af.Mask, ReplaceMask);
+					}
+				}
+			}
+			return clear;
+		}
+
+		/// <summary>
+		/// Built on first detection, since most animations are never detected against.
+		/// </summary>
+		private ChecksumIndex<int[]> FramesByHash
+		{
+			get
+			{
+				if (_framesByHash == null)
+				{
+					var framesByHash = new Dictionary<uint, List<int>>();
+					for (var i = 0; i < Frames.Length; i++)
+					{
+						if (!framesByHash.TryGetValue(Frames[i].Hash, out var frameIndices))
 						{
-							FrameUtil.OrPlane(af.PlaneData[i], _lcmBufferPlanes[i]);
-							if (SwitchMode == SwitchMode.MaskedReplace)
-								FrameUtil.OrPlane(af.Mask, ReplaceMask);
+							frameIndices = new List<int>();
+							framesByHash.Add(Frames[i].Hash, frameIndices);
 						}
+						frameIndices.Add(i);
 					}
+					_framesByHash = new ChecksumIndex<int[]>(framesByHash.ToDictionary(kv => kv.Key, kv => kv.Value.ToArray()));
 				}
+				return _framesByHash;
 			}
-			return clear;
 		}
 
 		private void StartLCM(Action<Dimensions, byte[][]> render)
@@ -404,7 +481,7 @@ namespace LibDmd.Converter.Vni
 
 		public override string ToString()
 		{
-			return $"{Name}, {Frames.Length} frames";
+			return $"{Name}, {NumFrames} frames";
 		}
 
 		public void Dump(string path, Mapping mapping, Palette[] palettes)
@@ -22,6 +22,11 @@ namespace LibDmd.Converter.Vni
 
 		private string _filename;
 
+		/// <summary>
+		/// Mappings indexed for lookup per frame
+		/// </summary>
+		private ChecksumIndex<Mapping> _mappingIndex;
+
 		/// <summary>
 		/// File version. 1 = FSQ, 2 = VNI (but we don't really care, we fetch what we get)
 		/// </summary>
@@ -39,6 +44,7 @@ namespace LibDmd.Converter.Vni
 			using (var reader = new BinaryReader(fs)) {
 				Load(reader, filename);
 			}
+			_mappingIndex = new ChecksumIndex<Mapping>(Mappings);
 		}
 
 		public PalFile(byte[] palData, string filename)
@@ -47,6 +53,7 @@ namespace LibDmd.Converter.Vni
 			using (var reader = new BinaryReader(memoryStream)) {
 				Load(reader, filename);
 			}
+			_mappingIndex = new ChecksumIndex<Mapping>(Mappings);
 		}
 
 		private void Load(BinaryReader reader, string filename)
@@ -134,7 +141,7 @@ namespace LibDmd.Converter.Vni
 
 		public Mapping FindMapping(uint checksum)
 		{
-			Mappings.TryGetValue(checksum, out var mapping);
+			_mappingIndex.TryGetValue(checksum, out var mapping);
 			return mapping;
 		}
 
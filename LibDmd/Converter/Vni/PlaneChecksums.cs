@@ -0,0 +1,185 @@
+﻿using System;
+using System.Collections.Generic;
+using LibDmd.Common;
+
+namespace LibDmd.Converter.Vni
+{
+	/// <summary>
+	/// Computes the checksum of a bit plane along with its checksums under
+	/// every mask, in one pass over the plane.
+	/// </summary>
+	///
+	/// <remarks>
+	/// This gives the same results as <see cref="FrameUtil.Checksum"/> and
+	/// <see cref="FrameUtil.ChecksumWithMask"/>, but each CRC consumes eight
+	/// bytes per step (slicing-by-8), and the plane is only read and reversed
+	/// once, with all masked CRCs advancing side by side.
+	///
+	/// Results are kept per plane index, so as long as a plane doesn't
+	/// change, it's not hashed again, no matter how often it's asked for.
+	/// </remarks>
+	public class PlaneChecksums
+	{
+		private readonly byte[][] _masks;
+		private readonly List<CachedPlane> _cache = new List<CachedPlane>();
+		private ulong[] _buffer = Array.Empty<ulong>();
+		private ulong[] _maskWords;
+
+		private static readonly uint[][] Tables = CreateTables();
+
+		/// <param name="masks">The masks to hash with. Can be null.</param>
+		public PlaneChecksums(byte[][] masks)
+		{
+			_masks = masks ?? Array.Empty<byte[]>();
+		}
+
+		/// <summary>
+		/// Returns the plane's checksums. The first one is without mask, followed by one per mask.
+		/// </summary>
+		///
+		/// <remarks>
+		/// The returned array is reused for the next plane at the same index, so
+		/// don't hold on to it.
+		/// </remarks>
+		/// <param name="planeIndex">Which plane of the frame this is</param>
+		/// <param name="plane">Plane data</param>
+		/// <param name="reverse">If set, reverse the bits of every byte before hashing</param>
+		public uint[] Compute(int planeIndex, byte[] plane, bool reverse)
+		{
+			while (_cache.Count <= planeIndex) {
+				_cache.Add(new CachedPlane(_masks.Length + 1));
+			}
+
+			var cached = _cache[planeIndex];
+			if (cached.Plane != null && cached.Reverse == reverse && FrameUtil.CompareBuffersFast(cached.Plane, plane)) {
+				return cached.Checksums;
+			}
+
+			using (Profiler.Start("PlaneChecksums.Compute")) {
+				Hash(plane, reverse, cached.Checksums);
+			}
+
+			if (cached.Plane == null || cached.Plane.Length != plane.Length) {
+				cached.Plane = new byte[plane.Length];
+			}
+			Buffer.BlockCopy(plane, 0, cached.Plane, 0, plane.Length);
+			cached.Reverse = reverse;
+
+			return cached.Checksums;
+		}
+
+		private unsafe void Hash(byte[] plane, bool reverse, uint[] checksums)
+		{
+			var numWords = plane.Length / 8;
+			var numMasks = _masks.Length;
+			if (_buffer.Length < numWords) {
+				_buffer = new ulong[numWords];
+			}
+			if (_maskWords == null || _maskWords.Length != numWords * numMasks) {
+				_maskWords = InterleaveMasks(numWords, plane.Length);
+			}
+
+			var crcs = stackalloc uint[numMasks + 1];
+			for (var m = 0; m <= numMasks; m++) {
+				crcs[m] = uint.MaxValue;
+			}
+
+			fixed (byte* pPlane = plane)
+			fixed (ulong* pBuffer = _buffer)
+			fixed (ulong* pMasks = _maskWords)
+			fixed (uint* t0 = Tables[0], t1 = Tables[1], t2 = Tables[2], t3 = Tables[3], t4 = Tables[4], t5 = Tables[5], t6 = Tables[6], t7 = Tables[7]) {
+
+				// reverse first, because the masks apply to the reversed bytes.
+				var words = (ulong*)pPlane;
+				if (reverse) {
+					var reversed = (byte*)pBuffer;
+					for (var i = 0; i < numWords * 8; i++) {
+						reversed[i] = FrameUtil.reversebyte[pPlane[i]];
+					}
+					words = pBuffer;
+				}
+
+				// all CRCs advance together, so they don't wait on each other's table lookups.
+				for (var i = 0; i < numWords; i++) {
+					var plain = words[i];
+					var maskRow = pMasks + i * numMasks;
+					for (var m = 0; m <= numMasks; m++) {
+						var word = m == 0 ? plain : plain & maskRow[m - 1];
+						var low = crcs[m] ^ (uint)word;
+						var high = (uint)(word >> 32);
+						crcs[m] = t7[low & 0xff] ^ t6[(low >> 8) & 0xff] ^ t5[(low >> 16) & 0xff] ^ t4[low >> 24]
+							^ t3[high & 0xff] ^ t2[(high >> 8) & 0xff] ^ t1[(high >> 16) & 0xff] ^ t0[high >> 24];
+					}
+				}
+			}
+
+			checksums[0] = Finish(crcs[0], plane, reverse, null, numWords * 8);
+			for (var m = 0; m < numMasks; m++) {
+				checksums[m + 1] = Finish(crcs[m + 1], plane, reverse, _masks[m], numWords * 8);
+			}
+		}
+
+		/// <summary>
+		/// Lays out the masks word by word, so the i-th word of every mask is next to each other.
+		/// </summary>
+		private ulong[] InterleaveMasks(int numWords, int planeLength)
+		{
+			var maskWords = new ulong[numWords * _masks.Length];
+			for (var m = 0; m < _masks.Length; m++) {
+				var mask = _masks[m];
+				if (mask.Length < planeLength) {
+					throw new IndexOutOfRangeException($"Mask of {mask.Length} bytes is too small for plane of {planeLength} bytes.");
+				}
+				for (var i = 0; i < numWords; i++) {
+					maskWords[i * _masks.Length + m] = BitConverter.ToUInt64(mask, i * 8);
+				}
+			}
+			return maskWords;
+		}
+
+		/// <summary>
+		/// Hashes the bytes that don't fill a whole word and finalizes the checksum.
+		/// </summary>
+		private static uint Finish(uint crc, byte[] plane, bool reverse, byte[] mask, int start)
+		{
+			var table = Tables[0];
+			for (var i = start; i < plane.Length; i++) {
+				var b = reverse ? FrameUtil.reversebyte[plane[i]] : plane[i];
+				if (mask != null) {
+					b &= mask[i];
+				}
+				crc = (crc >> 8) ^ table[(crc ^ b) & 0xff];
+			}
+			return ~crc;
+		}
+
+		/// <summary>
+		/// Table n hashes a byte followed by n zero bytes, so eight of them hash eight bytes at once.
+		/// </summary>
+		private static uint[][] CreateTables()
+		{
+			var tables = new uint[8][];
+			tables[0] = FrameUtil.checksumtable;
+			for (var t = 1; t < 8; t++) {
+				tables[t] = new uint[256];
+				for (var i = 0; i < 256; i++) {
+					var prev = tables[t - 1][i];
+					tables[t][i] = (prev >> 8) ^ tables[0][prev & 0xff];
+				}
+			}
+			return tables;
+		}
+
+		private class CachedPlane
+		{
+			public byte[] Plane;
+			public bool Reverse;
+			public readonly uint[] Checksums;
+
+			public CachedPlane(int numChecksums)
+			{
+				Checksums = new uint[numChecksums];
+			}
+		}
+	}
+}
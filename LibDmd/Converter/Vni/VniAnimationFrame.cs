@@ -2,53 +2,99 @@
 using System.IO;
 using LibDmd.Common;
 using LibDmd.Common.HeatShrink;
-using System.Linq;
 
 namespace LibDmd.Converter.Vni
 {
 	public class VniAnimationFrame : AnimationFrame
 	{
+		/// <summary>
+		/// If set, the planes still need to be decompressed.
+		/// </summary>
+		public bool IsCompressed => _compressedPlanes != null;
+
+		private readonly int _planeSize;
+		private byte[] _compressedPlanes;
+
 		public VniAnimationFrame(BinaryReader reader, int fileVersion, uint time) : base(time)
 		{
-			int planeSize = reader.ReadInt16BE();
+			_planeSize = reader.ReadInt16BE();
 			Delay = (uint) reader.ReadInt16BE();
 			if (fileVersion >= 4) {
 				Hash = reader.ReadUInt32BE();
 			}
 			BitLength = reader.ReadByte();
 			Planes = new List<AnimationPlane>(BitLength);
-			
-			if (fileVersion < 3) {
-				ReadPlanes(reader, planeSize);
+
+			var compressed = fileVersion >= 3 && reader.ReadByte() != 0;
+			if (!compressed) {
+				ReadPlanes(reader.ReadBytes(PlanesSize));
 
 			} else {
-				var compressed = reader.ReadByte() != 0;
-				if (!compressed) {
-					ReadPlanes(reader, planeSize);
+				var compressedSize = reader.ReadInt32BE();
+				_compressedPlanes = reader.ReadBytes(compressedSize);
+			}
+		}
 
-				} else {
+		/// <summary>
+		/// Decompresses the planes, if they were compressed.
+		/// </summary>
+		///
+		/// <remarks>
+		/// This is separate from reading, so the frames of an animation can
+		/// be decompressed in parallel.
+		/// </remarks>
+		public void Decompress()
+		{
+			if (_compressedPlanes == null) {
+				return;
+			}
+			var planes = new byte[PlanesSize];
+			var length = HeatShrinkDecoder.Decode(_compressedPlanes, planes, 10, 5);
+			ReadPlanes(planes, length);
+			_compressedPlanes = null;
+		}
 
-					var compressedSize = reader.ReadInt32BE();
-					var compressedPlanes = reader.ReadBytes(compressedSize);
-					var dec = new HeatShrinkDecoder(10, 5, 1024);
-					var decompressedStream = new MemoryStream();
-					dec.Decode(new MemoryStream(compressedPlanes), decompressedStream);
-					decompressedStream.Seek(0, SeekOrigin.Begin);
-					ReadPlanes(new BinaryReader(decompressedStream), planeSize);
-				}
+		/// <summary>
+		/// Moves the reader to the next frame without decoding this one.
+		/// </summary>
+		public static void Skip(BinaryReader reader, int fileVersion)
+		{
+			int planeSize = reader.ReadInt16BE();
+			reader.ReadInt16BE(); // delay
+			if (fileVersion >= 4) {
+				reader.ReadUInt32BE(); // hash
 			}
+			var bitLength = reader.ReadByte();
+			var compressed = fileVersion >= 3 && reader.ReadByte() != 0;
+			var size = compressed
+				? reader.ReadInt32BE()
+				: bitLength * (planeSize + 1); // marker and plane
+			reader.BaseStream.Seek(size, SeekOrigin.Current);
 		}
 
-		private void ReadPlanes(BinaryReader reader, int planeSize)
+		/// <summary>
+		/// Size of all planes, each with its marker.
+		/// </summary>
+		private int PlanesSize => BitLength * (_planeSize + 1);
+
+		private void ReadPlanes(byte[] data, int length = -1)
 		{
+			if (length < 0) {
+				length = data.Length;
+			}
+			if (length < PlanesSize) {
+				throw new EndOfStreamException($"{PlanesSize} bytes required for {BitLength} planes, but only {length} available.");
+			}
+			var offset = 0;
 			for (var i = 0; i < BitLength; i++) {
-				var marker = reader.ReadByte();
+				var marker = data[offset++];
+				var plane = VniAnimationPlane.ReadPlane(data, offset, _planeSize);
 				if (marker == 0x6d) {
-					Mask = reader.ReadBytes(planeSize).Select(VniAnimationPlane.Reverse).ToArray();
+					Mask = plane;
 				} else {
-					var plane = new VniAnimationPlane(reader, planeSize, marker);
-					Planes.Add(plane);
+					Planes.Add(new VniAnimationPlane(plane, marker));
 				}
+				offset += _planeSize;
 			}
 		}
 	}
@@ -1,14 +1,25 @@
-﻿using System.IO;
-using System.Linq;
+﻿using LibDmd.Common;
 
 namespace LibDmd.Converter.Vni
 {
 	public class VniAnimationPlane : AnimationPlane
 	{
-		public VniAnimationPlane(BinaryReader reader, int planeSize, byte marker)
+		public VniAnimationPlane(byte[] plane, byte marker)
 		{
 			Marker = marker;
-			Plane = reader.ReadBytes(planeSize).Select(Reverse).ToArray();
+			Plane = plane;
+		}
+
+		/// <summary>
+		/// Copies a plane out of the frame data, with the bits of each byte reversed.
+		/// </summary>
+		public static byte[] ReadPlane(byte[] data, int offset, int planeSize)
+		{
+			var plane = new byte[planeSize];
+			for (var i = 0; i < planeSize; i++) {
+				plane[i] = FrameUtil.reversebyte[data[offset + i]];
+			}
+			return plane;
 		}
 
 		public static byte Reverse(byte a)
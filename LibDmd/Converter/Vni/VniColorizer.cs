@@ -19,7 +19,15 @@ namespace LibDmd.Converter.Vni
 		public IObservable<ColoredFrame> GetColoredGray6Frames() => DedupedColoredGray6Source.GetColoredGray6Frames();
 
 		public bool Has128x32Animation { get; set; }
-		public ScalerMode ScalerMode { get; set; }
+
+		public ScalerMode ScalerMode
+		{
+			get => _scalerMode;
+			set {
+				_scalerMode = value;
+				_frameCache.Clear();
+			}
+		}
 
 		protected override bool PadSmallFrames => true;
 
@@ -33,6 +41,11 @@ namespace LibDmd.Converter.Vni
 		/// </summary>
 		private readonly AnimationSet _animations;
 
+		/// <summary>
+		/// Hashes the incoming planes with the masks of the .pal file
+		/// </summary>
+		private readonly PlaneChecksums _planeChecksums;
+
 		/// <summary>
 		/// IF not null, the currently playing animation.
 		/// </summary>
@@ -54,7 +67,17 @@ namespace LibDmd.Converter.Vni
 		private IDisposable _paletteReset;
 
 		private bool _resetEmbedded;
+		private bool _disposed;
 		private int _lastEmbedded = -1;
+		private ScalerMode _scalerMode;
+
+		/// <summary>
+		/// Rendered frames by planes and palette. The frames in here are never
+		/// emitted, only their data, so they can't be changed downstream.
+		/// </summary>
+		private readonly FrameCache<ColoredFrame> _frameCache = new FrameCache<ColoredFrame>(64);
+
+		internal FrameCache<ColoredFrame> FrameCache => _frameCache;
 
 		protected static readonly Logger Logger = LogManager.GetCurrentClassLogger();
 
@@ -62,6 +85,7 @@ namespace LibDmd.Converter.Vni
 		{
 			_palFile = palFile;
 			_animations = animations;
+			_planeChecksums = new PlaneChecksums(palFile.Masks);
 			Has128x32Animation = (_palFile.Masks != null && _palFile.Masks.Length >= 1 && _palFile.Masks[0].Length == 512);
 			SetPalette(palFile.DefaultPalette, true);
 		}
@@ -84,9 +108,12 @@ namespace LibDmd.Converter.Vni
 				if (frame.Data[0] == 0x08 && frame.Data[1] == 0x09 && frame.Data[2] == 0x0a && frame.Data[3] == 0x0b) {
 					uint newPal = (uint)frame.Data[5] * 8 + frame.Data[4];
 
+					// the data is shared with other destinations, so clear the header on a copy.
+					var data = (byte[])frame.Data.Clone();
 					for (int i = 0; i < 6; i++) {
-						frame.Data[i] = 0;
+						data[i] = 0;
 					}
+					frame.Update(frame.Dimensions, data, frame.BitLength, frame.IsIdentifyFrame);
 
 					if (newPal != _lastEmbedded) {
 						LoadPalette(newPal);
@@ -205,18 +232,24 @@ namespace LibDmd.Converter.Vni
 					return;
 				}
 
+				if (!_activeFrameSeq.Decode())
+				{
+					_activeFrameSeq = null;
+					return;
+				}
+
 				_activeFrameSeq.Start(mapping.Mode, Render, AnimationFinished);
 			}
 		}
 
 		private void TriggerAnimation(byte[][] planes, bool reverse)
 		{
-			uint nomaskcrc = 0;
 			bool clear = true;
 
 			for (var i = 0; i < planes.Length; i++)
 			{
-				var mapping = FindMapping(planes[i], reverse, out nomaskcrc);
+				var checksums = _planeChecksums.Compute(i, planes[i], reverse);
+				var mapping = FindMapping(checksums);
 
 				// Faus niid gfundä hemmr fertig
 				if (mapping != null)
@@ -232,69 +265,48 @@ namespace LibDmd.Converter.Vni
 				if (_activeFrameSeq != null)
 				{
 					if (_activeFrameSeq.SwitchMode == SwitchMode.LayeredColorMask || _activeFrameSeq.SwitchMode == SwitchMode.MaskedReplace)
-						clear = _activeFrameSeq.DetectLCM(planes[i], nomaskcrc, reverse, clear);
+						clear = _activeFrameSeq.DetectLCM(i, planes[i], reverse, clear);
 					else if (_activeFrameSeq.SwitchMode == SwitchMode.Follow || _activeFrameSeq.SwitchMode == SwitchMode.FollowReplace)
-						_activeFrameSeq.DetectFollow(planes[i], nomaskcrc, _palFile.Masks, reverse);
+						_activeFrameSeq.DetectFollow(checksums);
 				}
 			}
 		}
 
 		/// <summary>
-		/// Tuät Bitplane fir Bitplane häschä unds erschtä Mäpping wo gfundä
-		/// wordä isch zrugg gäh.
+		/// Gät s erschtä Mäpping zrugg wo zu einä vo dä Häschs vo dr Bitplane
+		/// passt, zerscht ohni Maskä und när Maskä fir Maskä.
 		/// </summary>
-		/// <param name="plane"></param>
-		/// <param name="reverse"></param>
-		/// <param name="noMaskCrc"></param>
+		/// <param name="checksums">Häschs vo dr Bitplane, vo <see cref="PlaneChecksums.Compute"/></param>
 		/// <returns>Mäpping odr null wenn nid gfundä</returns>
-		private Mapping FindMapping(byte[] plane, bool reverse, out uint noMaskCrc)
+		private Mapping FindMapping(uint[] checksums)
 		{
-			noMaskCrc = 0;
-			var checksum = FrameUtil.Checksum(plane, reverse);
-			noMaskCrc = checksum;
-
-			var mapping = _palFile.FindMapping(checksum);
-			if (mapping != null) 
-			{
-				return mapping;
-			}
-
-			// Wenn kä Maskä definiert, de nächschti Bitplane
-			if (_palFile.Masks == null || _palFile.Masks.Length <= 0)
-				return null;
-		
-			// Sisch gemmr Maskä fir Maskä durä und luägid ob da eppis passt
-			foreach (var mask in _palFile.Masks)
+			foreach (var checksum in checksums)
 			{
-				checksum = FrameUtil.ChecksumWithMask(plane, mask, reverse);
-				mapping = _palFile.FindMapping(checksum);
-				if (mapping != null) 
+				var mapping = _palFile.FindMapping(checksum);
+				if (mapping != null)
 				{
 					return mapping;
 				}
 			}
-			
 			return null;
 		}
 
 		/// <summary>
 		/// Tuäts Biud uif diä entschprächändä Sourcä uisgäh.
 		/// </summary>
+		///
+		/// <remarks>
+		/// Used for both incoming frames and frames of an animation, so both
+		/// are cached by their planes and the current palette.
+		/// </remarks>
 		/// <param name="dim">Frame dimensions</param>
 		/// <param name="planes">S Biud zum uisgäh</param>
 		private void Render(Dimensions dim, byte[][] planes)
 		{
-			// We want to do the scaling after the animations get triggered.
-			if (_animations != null && dim * 2 == _animations.Dimensions) {
-				planes = ScalerMode == ScalerMode.Scale2x
-					? FrameUtil.Scale2X(dim, planes)
-					: FrameUtil.ScaleDouble(dim, planes);
-				dim *= 2;
-			}
+			var cached = _frameCache.GetOrAdd(dim, planes, _palette, () => Colorize(dim, planes));
 
-			var palette = ColorUtil.GetPalette(_palette.GetColors((int)(Math.Log(_palette.Colors.Length) / Math.Log(2))), (int)Math.Pow(2, planes.Length));
-			var data = FrameUtil.Join(dim, planes);
-			var coloredFrame = new ColoredFrame(dim, data, palette);
+			// the clone keeps the hash of the cached frame, so de-duping it downstream doesn't hash it again.
+			var coloredFrame = (ColoredFrame)cached.Clone();
 
 			switch (planes.Length) {
 				case 2:
@@ -309,6 +321,24 @@ namespace LibDmd.Converter.Vni
 			}
 		}
 
+		/// <summary>
+		/// Scales the planes if needed, joins them and applies the current palette.
+		/// </summary>
+		private ColoredFrame Colorize(Dimensions dim, byte[][] planes)
+		{
+			// We want to do the scaling after the animations get triggered.
+			if (_animations != null && dim * 2 == _animations.Dimensions) {
+				planes = ScalerMode == ScalerMode.Scale2x
+					? FrameUtil.Scale2X(dim, planes)
+					: FrameUtil.ScaleDouble(dim, planes);
+				dim *= 2;
+			}
+
+			var palette = ColorUtil.GetPalette(_palette.GetColors((int)(Math.Log(_palette.Colors.Length) / Math.Log(2))), (int)Math.Pow(2, planes.Length));
+			var data = FrameUtil.Join(dim, planes);
+			return new ColoredFrame(dim, data, palette);
+		}
+
 		/// <summary>
 		/// Tuät nii Farbä dr Palettä wo grad bruichd wird zuäwiisä.
 		/// </summary>
@@ -338,6 +368,18 @@ namespace LibDmd.Converter.Vni
 			_activeFrameSeq = null;
 		}
 
+		public override void Dispose()
+		{
+			// shared by all render graphs, which all dispose it.
+			if (_disposed) {
+				return;
+			}
+			_disposed = true;
+			Logger.Info("[vni] Frame cache: {0}", _frameCache);
+			base.Dispose();
+			(_animations as IDisposable)?.Dispose();
+		}
+
 		public void DumpAnimations(string path)
 		{
 			foreach (var offset in _palFile.Mappings.Keys) {
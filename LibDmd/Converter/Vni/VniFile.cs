@@ -1,5 +1,7 @@
-﻿using System.Collections.Generic;
+﻿using System;
+using System.Collections.Generic;
 using System.IO;
+using System.IO.MemoryMappedFiles;
 using System.Text;
 using LibDmd.Common;
 using LibDmd.Frame;
@@ -7,53 +9,85 @@ using LibDmd.Input.FileSystem;
 
 namespace LibDmd.Converter.Vni
 {
-	public class VniFile : AnimationSet
+	/// <summary>
+	/// Reads the VNI file format.
+	/// </summary>
+	///
+	/// <remarks>
+	/// Only the animation headers are parsed when loading. The frames stay in
+	/// the file, which is memory-mapped, and are decoded when an animation is
+	/// played for the first time. Most animations never are during a session.
+	/// </remarks>
+	public class VniFile : AnimationSet, IDisposable
 	{
+		private readonly MemoryMappedFile _file;
+		private readonly BinaryReader _reader;
+		private readonly object _readLock = new object();
+
 		public VniFile(string filename)
 		{
-			using (var fs = new FileStream(filename, FileMode.Open))
-			using (var reader = new BinaryReader(fs)) {
-				Load(reader, filename);
+			var length = new FileInfo(filename).Length;
+			if (length < 8) {
+				throw new WrongFormatException("Not a VPIN file: " + filename);
+			}
+			// share the file, so tools can still read it while it's loaded. the mapping closes the stream.
+			var stream = new FileStream(filename, FileMode.Open, FileAccess.Read, FileShare.Read);
+			_file = MemoryMappedFile.CreateFromFile(stream, null, 0, MemoryMappedFileAccess.Read, null, HandleInheritability.None, false);
+			_reader = new BinaryReader(_file.CreateViewStream(0, length, MemoryMappedFileAccess.Read));
+			try {
+				Load(filename);
+
+			} catch {
+				Dispose();
+				throw;
 			}
 		}
 
-		public VniFile(byte[] palData, string filename)
+		public VniFile(byte[] vniData, string filename)
 		{
-			using (var memoryStream = new MemoryStream(palData))
-			using (var reader = new BinaryReader(memoryStream)) {
-				Load(reader, filename);
+			_reader = new BinaryReader(new MemoryStream(vniData));
+			Load(filename);
+		}
+
+		/// <summary>
+		/// Reads data from the file.
+		/// </summary>
+		/// <param name="position">Where to start reading</param>
+		/// <param name="read">Reads the data from the positioned reader</param>
+		internal T Read<T>(long position, Func<BinaryReader, T> read)
+		{
+			lock (_readLock) {
+				_reader.BaseStream.Position = position;
+				return read(_reader);
 			}
 		}
 
-		private void Load(BinaryReader reader, string filename)
+		private void Load(string filename)
 		{
 			// name
-			var header = Encoding.UTF8.GetString(reader.ReadBytes(4));
+			var header = Encoding.UTF8.GetString(_reader.ReadBytes(4));
 			if (header != "VPIN") {
-				reader.Close();
 				throw new WrongFormatException("Not a VPIN file: " + filename);
 			}
 
 			// version
-			Version = reader.ReadInt16BE();
+			Version = _reader.ReadInt16BE();
 
 			// number of animations
-			var numAnimations = reader.ReadInt16BE();
+			var numAnimations = _reader.ReadInt16BE();
 
 			if (Version >= 2) {
-				Logger.Trace("[vni] VNI[{1}] Skipping {0} bytes of animation indexes.", numAnimations * 4, reader.BaseStream.Position);
-				for (var i = 0; i < numAnimations; i++) {
-					reader.ReadUInt32();
-				}
+				Logger.Trace("[vni] VNI[{1}] Skipping {0} bytes of animation indexes.", numAnimations * 4, _reader.BaseStream.Position);
+				_reader.BaseStream.Seek(numAnimations * 4, SeekOrigin.Current);
 			}
 
 			Animations = new List<FrameSeq>(numAnimations);
-			Logger.Debug("[vni] VNI[{3}] Reading {0} animations from {1} v{2}...", numAnimations, header, Version, reader.BaseStream.Position);
+			Logger.Debug("[vni] VNI[{3}] Indexing {0} animations from {1} v{2}...", numAnimations, header, Version, _reader.BaseStream.Position);
 
 			var maxWidth = 0;
 			var maxHeight = 0;
 			for (var i = 0; i < numAnimations; i++) {
-				Animations.Add(new VniFrameSeq(reader, Version));
+				Animations.Add(new VniFrameSeq(this, _reader, Version));
 				int h = Animations[i].Size.Height;
 				int w = Animations[i].Size.Width;
 				if (h > maxHeight)
@@ -61,10 +95,17 @@ namespace LibDmd.Converter.Vni
 				if (w > maxWidth)
 					maxWidth = w;
 			}
-			reader.Close();
 			Dimensions = new Dimensions(maxWidth, maxHeight);
 		}
 
+		public void Dispose()
+		{
+			lock (_readLock) {
+				_reader.Dispose();
+				_file?.Dispose();
+			}
+		}
+
 		public override string ToString()
 		{
 			return $"VPIN v{Version}, {Animations.Count} animation(s)";
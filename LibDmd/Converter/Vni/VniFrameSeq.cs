@@ -1,6 +1,8 @@
-﻿using System.IO;
+﻿using System.Diagnostics;
+using System.IO;
 using System.Linq;
 using System.Text;
+using System.Threading.Tasks;
 using System.Windows.Media;
 using LibDmd.Common;
 using LibDmd.Frame;
@@ -12,8 +14,24 @@ namespace LibDmd.Converter.Vni
 	/// </summary>
 	public class VniFrameSeq : FrameSeq
 	{
-		public VniFrameSeq(BinaryReader reader, int fileVersion) : base(reader.BaseStream.Position)
+		/// <summary>
+		/// Below this number of compressed frames, decompressing in parallel doesn't pay off.
+		/// </summary>
+		private const int MinParallelFrames = 8;
+
+		private readonly VniFile _file;
+		private readonly int _fileVersion;
+
+		/// <summary>
+		/// Where the frames start in the file
+		/// </summary>
+		private readonly long _framesOffset;
+
+		public VniFrameSeq(VniFile file, BinaryReader reader, int fileVersion) : base(reader.BaseStream.Position)
 		{
+			_file = file;
+			_fileVersion = fileVersion;
+
 			// animations name
 			var nameLength = reader.ReadInt16BE();
 			Name = nameLength > 0 ? Encoding.UTF8.GetString(reader.ReadBytes(nameLength)) : "<undefined>";
@@ -34,6 +52,7 @@ namespace LibDmd.Converter.Vni
 			if (numFrames < 0) {
 				numFrames += 65536;
 			}
+			NumFrames = numFrames;
 
 			if (fileVersion >= 2) {
 				ReadPalettesAndColors(reader);
@@ -69,16 +88,42 @@ namespace LibDmd.Converter.Vni
 				uint startFrame = reader.ReadUInt32BE();
 			}
 
-			Logger.Debug("[vni] VNI[{3}] Reading {0} frame{1} for animation \"{2}\"...", numFrames, numFrames == 1 ? "" : "s", Name, reader.BaseStream.Position);
-			Frames = new AnimationFrame[numFrames];
-			AnimationDuration = 0;
+			Logger.Trace("[vni] VNI[{3}] Skipping {0} frame{1} of animation \"{2}\"...", numFrames, numFrames == 1 ? "" : "s", Name, reader.BaseStream.Position);
+			_framesOffset = reader.BaseStream.Position;
 			for (var i = 0; i < numFrames; i++) {
-				Frames[i] = new VniAnimationFrame(reader, fileVersion, AnimationDuration);
-				if (Frames[i].Mask != null && TransitionFrom == 0) {
+				VniAnimationFrame.Skip(reader, fileVersion);
+			}
+		}
+
+		protected override AnimationFrame[] ReadFrames()
+		{
+			var stopwatch = Stopwatch.StartNew();
+			var frames = _file.Read(_framesOffset, reader => {
+				var animationFrames = new VniAnimationFrame[NumFrames];
+				AnimationDuration = 0;
+				for (var i = 0; i < NumFrames; i++) {
+					animationFrames[i] = new VniAnimationFrame(reader, _fileVersion, AnimationDuration);
+					AnimationDuration += animationFrames[i].Delay;
+				}
+				return animationFrames;
+			});
+
+			var compressed = frames.Where(f => f.IsCompressed).ToArray();
+			if (compressed.Length >= MinParallelFrames) {
+				Parallel.ForEach(compressed, f => f.Decompress());
+			} else {
+				foreach (var frame in compressed) {
+					frame.Decompress();
+				}
+			}
+
+			for (var i = 0; i < frames.Length; i++) {
+				if (frames[i].Mask != null && TransitionFrom == 0) {
 					TransitionFrom = i;
 				}
-				AnimationDuration += Frames[i].Delay;
 			}
+			Logger.Debug("[vni] Decoded {0} frame{1} of animation \"{2}\" in {3}ms.", NumFrames, NumFrames == 1 ? "" : "s", Name, stopwatch.Elapsed.TotalMilliseconds);
+			return frames;
 		}
 
 		private void ReadPalettesAndColors(BinaryReader reader)
@@ -97,7 +142,7 @@ namespace LibDmd.Converter.Vni
 
 		public override string ToString()
 		{
-			return $"{Name}, {Frames.Length} frames";
+			return $"{Name}, {NumFrames} frames";
 		}
 	}
 }
@@ -12,6 +12,7 @@ using IniParser;
 using IniParser.Model;
 using LibDmd.Common;
 using LibDmd.Input;
+using LibDmd.Output.FileOutput;
 using LibDmd.Output.Virtual.AlphaNumeric;
 using LibDmd.Output.Virtual.Dmd;
 using NLog;
@@ -236,6 +237,10 @@ namespace LibDmd.DmdDevice
 		public string VniKey => GetString("vni.key", null);
 
 		public bool SkipAnalytics => GetBoolean("skipanalytics", false);
+		public bool Profiler => GetBoolean("profiler", false);
+		public int ProfilerInterval => GetInt("profiler.interval", 10);
+		public string ProfilerFile => GetString("profiler.file", null);
+		public bool RenderThreads => GetBoolean("renderthreads", false);
 		public PluginConfig[] Plugins {
 			get {
 				var plugins = new List<PluginConfig>();
@@ -883,6 +888,8 @@ namespace LibDmd.DmdDevice
 	{
 		public override string Name { get; } = "rawoutput";
 		public bool Enabled => GetBoolean("enabled", false);
+		public RawOutputFormat Format => GetEnum("format", RawOutputFormat.Text);
+		public bool Compress => GetBoolean("compress", true);
 		public RawOutputConfig(IniData data, Configuration parent) : base(data, parent)
 		{
 		}
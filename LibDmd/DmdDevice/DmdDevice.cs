@@ -15,7 +15,6 @@ using LibDmd.Common;
 using LibDmd.Converter;
 using LibDmd.Converter.Vni;
 using LibDmd.Converter.Plugin;
-using LibDmd.Converter.Serum;
 using LibDmd.Frame;
 using LibDmd.Input.Passthrough;
 using LibDmd.Output;
@@ -145,6 +144,10 @@ namespace LibDmd.DmdDevice
 				ReportError(e);
 				Analytics.Instance.Disable(false);
 			}
+
+			if (_config.Global.Profiler) {
+				Profiler.StartReporting(TimeSpan.FromSeconds(_config.Global.ProfilerInterval), _config.Global.ProfilerFile);
+			}
 		}
 
 		#region DmdDevice.dll API
@@ -454,14 +457,7 @@ namespace LibDmd.DmdDevice
 			_alphaNumericDest = null;
 			_color = RenderGraph.DefaultColor;
 			_palette = null;
-			switch (_colorizer) {
-				case Serum serum:
-					serum.Dispose();
-					break;
-				case ColorizationPlugin plugin:
-					plugin.Dispose();
-					break;
-			}
+			_colorizer?.Dispose();
 			_colorizer = null;
 			_isOpen = false;
 		}
@@ -676,7 +672,7 @@ namespace LibDmd.DmdDevice
 			}
 			if (_config.RawOutput.Enabled) {
 				try {
-					var rawOutput = new RawOutput(_gameName);
+					var rawOutput = new RawOutput(_gameName, _config.RawOutput.Format, _config.RawOutput.Compress);
 					if (rawOutput.IsAvailable) {
 						renderers.Add(rawOutput);
 						Logger.Info("Added raw output renderer.");
@@ -709,7 +705,8 @@ namespace LibDmd.DmdDevice
 						Resize = _config.Global.Resize,
 						FlipHorizontally = _config.Global.FlipHorizontally,
 						FlipVertically = _config.Global.FlipVertically,
-						ScalerMode = _config.Global.ScalerMode
+						ScalerMode = _config.Global.ScalerMode,
+						DedicatedThreads = _config.Global.RenderThreads
 					});
 					ReportingTags.Add("Color:Gray2");
 				}
@@ -723,7 +720,8 @@ namespace LibDmd.DmdDevice
 						Resize = _config.Global.Resize,
 						FlipHorizontally = _config.Global.FlipHorizontally,
 						FlipVertically = _config.Global.FlipVertically,
-						ScalerMode = _config.Global.ScalerMode
+						ScalerMode = _config.Global.ScalerMode,
+						DedicatedThreads = _config.Global.RenderThreads
 					});
 					ReportingTags.Add("Color:Gray4");
 				}
@@ -738,6 +736,7 @@ namespace LibDmd.DmdDevice
 						FlipHorizontally = _config.Global.FlipHorizontally,
 						FlipVertically = _config.Global.FlipVertically,
 						ScalerMode = _config.Global.ScalerMode,
+						DedicatedThreads = _config.Global.RenderThreads
 					});
 					ReportingTags.Add("Color:Alphanumeric");
 				}
@@ -753,7 +752,8 @@ namespace LibDmd.DmdDevice
 							Resize = _config.Global.Resize,
 							FlipHorizontally = _config.Global.FlipHorizontally,
 							FlipVertically = _config.Global.FlipVertically,
-							ScalerMode = _config.Global.ScalerMode
+							ScalerMode = _config.Global.ScalerMode,
+							DedicatedThreads = _config.Global.RenderThreads
 						});
 
 						_graphs.Add(new RenderGraph(refs) {
@@ -763,7 +763,8 @@ namespace LibDmd.DmdDevice
 							Resize = _config.Global.Resize,
 							FlipHorizontally = _config.Global.FlipHorizontally,
 							FlipVertically = _config.Global.FlipVertically,
-							ScalerMode = _config.Global.ScalerMode
+							ScalerMode = _config.Global.ScalerMode,
+							DedicatedThreads = _config.Global.RenderThreads
 						});
 
 						_graphs.Add(new RenderGraph(refs) {
@@ -773,7 +774,8 @@ namespace LibDmd.DmdDevice
 							Resize = _config.Global.Resize,
 							FlipHorizontally = _config.Global.FlipHorizontally,
 							FlipVertically = _config.Global.FlipVertically,
-							ScalerMode = _config.Global.ScalerMode
+							ScalerMode = _config.Global.ScalerMode,
+							DedicatedThreads = _config.Global.RenderThreads
 						});
 					}
 				}
@@ -799,7 +801,8 @@ namespace LibDmd.DmdDevice
 					Resize = _config.Global.Resize,
 					FlipHorizontally = _config.Global.FlipHorizontally,
 					FlipVertically = _config.Global.FlipVertically,
-					ScalerMode = _config.Global.ScalerMode
+					ScalerMode = _config.Global.ScalerMode,
+					DedicatedThreads = _config.Global.RenderThreads
 				});
 
 				_graphs.Add(new RenderGraph(refs) {
@@ -809,7 +812,8 @@ namespace LibDmd.DmdDevice
 					Resize = _config.Global.Resize,
 					FlipHorizontally = _config.Global.FlipHorizontally,
 					FlipVertically = _config.Global.FlipVertically,
-					ScalerMode = _config.Global.ScalerMode
+					ScalerMode = _config.Global.ScalerMode,
+					DedicatedThreads = _config.Global.RenderThreads
 				});
 
 				_graphs.Add(new RenderGraph(refs) {
@@ -819,7 +823,8 @@ namespace LibDmd.DmdDevice
 					Resize = _config.Global.Resize,
 					FlipHorizontally = _config.Global.FlipHorizontally,
 					FlipVertically = _config.Global.FlipVertically,
-					ScalerMode = _config.Global.ScalerMode
+					ScalerMode = _config.Global.ScalerMode,
+					DedicatedThreads = _config.Global.RenderThreads
 				});
 			}
 
@@ -831,7 +836,8 @@ namespace LibDmd.DmdDevice
 				Resize = _config.Global.Resize,
 				FlipHorizontally = _config.Global.FlipHorizontally,
 				FlipVertically = _config.Global.FlipVertically,
-				ScalerMode = _config.Global.ScalerMode
+				ScalerMode = _config.Global.ScalerMode,
+				DedicatedThreads = _config.Global.RenderThreads
 			});
 
 			// alphanumeric graph
@@ -842,7 +848,8 @@ namespace LibDmd.DmdDevice
 				Resize = _config.Global.Resize,
 				FlipHorizontally = _config.Global.FlipHorizontally,
 				FlipVertically = _config.Global.FlipVertically,
-				ScalerMode = _config.Global.ScalerMode
+				ScalerMode = _config.Global.ScalerMode,
+				DedicatedThreads = _config.Global.RenderThreads
 			});
 
 			// if colorization enabled and frame-by-frame colorization disabled, just set the palette.
@@ -1,6 +1,7 @@
 ﻿using System.Windows.Media;
 using LibDmd.Input;
 using LibDmd.Common;
+using LibDmd.Output.FileOutput;
 using LibDmd.Output.Virtual.AlphaNumeric;
 using LibDmd.Output.Virtual.Dmd;
 
@@ -49,6 +50,10 @@ namespace LibDmd.DmdDevice
 		ScalerMode VniScalerMode { get; }
 		string VniKey { get; }
 		bool SkipAnalytics { get; }
+		bool Profiler { get; }
+		int ProfilerInterval { get; }
+		string ProfilerFile { get; }
+		bool RenderThreads { get; }
 		PluginConfig[] Plugins { get; }
 	}
 
@@ -163,5 +168,7 @@ namespace LibDmd.DmdDevice
 	public interface IRawOutputConfig
 	{
 		bool Enabled { get; }
+		RawOutputFormat Format { get; }
+		bool Compress { get; }
 	}
 }
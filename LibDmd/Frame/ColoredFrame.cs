@@ -96,6 +96,7 @@ namespace LibDmd
 			Buffer.BlockCopy(frame.Data, 0, Data, 0, frame.Data.Length);
 			BitLength = frame.BitLength;
 			Palette = frame.Palette;
+			CopyHash(frame);
 
 			#if DEBUG
 			AssertData();
@@ -280,8 +281,8 @@ namespace LibDmd
 			unchecked {
 				var hashCode = Dimensions.GetHashCode();
 				hashCode = (hashCode * 397) ^ BitLength;
-				hashCode = (hashCode * 397) ^ (Palette != null ? Palette.GetHashCode() : 0);
-				hashCode = (hashCode * 397) ^ (Data != null ? Data.GetHashCode() : 0);
+				hashCode = (hashCode * 397) ^ (Palette?.Length ?? 0);
+				hashCode = (hashCode * 397) ^ (Data != null ? Hash.GetHashCode() : 0);
 				return hashCode;
 			}
 		}
@@ -308,6 +309,7 @@ namespace LibDmd
 			}
 			return a.Dimensions == b.Dimensions
 			       && PaletteEquals(a.Palette, b.Palette)
+			       && HashEquals(a, b)
 			       && FrameUtil.CompareBuffersFast(a.Data, b.Data);
 		}
 
@@ -344,7 +346,12 @@ namespace LibDmd
 
 		#region Overrides
 
-		public new object Clone() => new ColoredFrame(Dimensions, Data, Palette);
+		public new object Clone()
+		{
+			var frame = new ColoredFrame(Dimensions, Data, Palette);
+			frame.CopyHash(this);
+			return frame;
+		}
 
 		public override string ToString()
 		{
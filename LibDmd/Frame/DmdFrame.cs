@@ -1,8 +1,8 @@
 ﻿using System;
-using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.IO;
 using System.Text;
+using System.Threading;
 using System.Windows.Media;
 using LibDmd.Common;
 using LibDmd.Output;
@@ -26,7 +26,43 @@ namespace LibDmd.Frame
 		/// The frame data, from top left to bottom right.
 		/// It's usually one byte per pixel, but three bytes for RGB24.
 		/// </summary>
-		public byte[] Data { get; protected set; }
+		///
+		/// <remarks>
+		/// Once a frame is emitted, its data might be shared with other frames
+		/// (see <see cref="Clone"/>), so never write into it. Create a new array
+		/// and <see cref="Update(byte[], int)"/> the frame instead.
+		/// </remarks>
+		public byte[] Data {
+			get => _data;
+			protected set {
+				_data = value;
+				_hasHash = false;
+			}
+		}
+
+		/// <summary>
+		/// A 64-bit hash of <see cref="Data"/>, computed when first needed.
+		/// </summary>
+		///
+		/// <remarks>
+		/// It's used by <see cref="GetHashCode"/>, and by <see cref="Equals(object)"/>
+		/// when both frames already have one. Setting new data resets it, and
+		/// clones and updates from another frame with the same data take it
+		/// over, so a frame is only hashed once.
+		/// </remarks>
+		public ulong Hash {
+			get {
+				if (!Volatile.Read(ref _hasHash)) {
+					_hash = FrameUtil.Hash(_data);
+					Volatile.Write(ref _hasHash, true);
+				}
+				return _hash;
+			}
+		}
+
+		private byte[] _data;
+		private ulong _hash;
+		private bool _hasHash;
 
 		/// <summary>
 		/// These frames are used for colorization and should never be rendered (if they exist, that means
@@ -58,7 +94,6 @@ namespace LibDmd.Frame
 		public static bool operator == (DmdFrame x, DmdFrame y) => Equals(x, y);
 		public static bool operator != (DmdFrame x, DmdFrame y) => !Equals(x, y);
 
-		private static readonly ObjectPool Pool = new ObjectPool();
 		private static readonly Logger Logger = LogManager.GetCurrentClassLogger();
 
 		public FrameFormat Format {
@@ -139,6 +174,7 @@ namespace LibDmd.Frame
 			Data = frame.Data;
 			BitLength = frame.BitLength;
 			IsIdentifyFrame = frame.IsIdentifyFrame;
+			CopyHash(frame);
 
 			#if DEBUG
 			AssertData();
@@ -183,6 +219,17 @@ namespace LibDmd.Frame
 			return this;
 		}
 
+		/// <summary>
+		/// Takes over the hash of a frame with the same data, if it's computed already.
+		/// </summary>
+		protected void CopyHash(DmdFrame frame)
+		{
+			if (Volatile.Read(ref frame._hasHash)) {
+				_hash = frame._hash;
+				Volatile.Write(ref _hasHash, true);
+			}
+		}
+
 		#endregion
 
 		#region Transfers
@@ -538,29 +585,35 @@ namespace LibDmd.Frame
 		public DmdFrame TransformHdScaling(IFixedSizeDestination fixedDest, ScalerMode scalerMode)
 		{
 			using (Profiler.Start("DmdFrame.TransformHdScaling")) {
+				return CanHdScale(fixedDest, scalerMode) ? TransformHdScaling(scalerMode) : this;
+			}
+		}
 
-				// skip if disabled
-				if (scalerMode == ScalerMode.None) {
-					return this;
-				}
-
-				// if destination doesn't allow scaling (e.g. pup), return
-				if (fixedDest != null && !fixedDest.DmdAllowHdScaling) {
-					return this;
-				}
-
-				// if double of frame size doesn't fit into destination, return
-				if (fixedDest != null && !(Dimensions * 2).FitsInto(fixedDest.FixedSize)) {
-					return this;
-				}
+		/// <summary>
+		/// Checks whether <see cref="TransformHdScaling(IFixedSizeDestination, ScalerMode)"/> would scale the frame.
+		/// </summary>
+		/// <param name="fixedDest">The fixed destination, null if dynamic.</param>
+		/// <param name="scalerMode">If and how to scale</param>
+		/// <returns>True if the frame would be scaled, false otherwise.</returns>
+		public bool CanHdScale(IFixedSizeDestination fixedDest, ScalerMode scalerMode)
+		{
+			// skip if disabled
+			if (scalerMode == ScalerMode.None) {
+				return false;
+			}
 
-				// if source is already > 128x32, return
-				if (Dimensions > Dimensions.Standard) {
-					return this;
-				}
+			// if destination doesn't allow scaling (e.g. pup), return
+			if (fixedDest != null && !fixedDest.DmdAllowHdScaling) {
+				return false;
+			}
 
-				return TransformHdScaling(scalerMode);
+			// if double of frame size doesn't fit into destination, return
+			if (fixedDest != null && !(Dimensions * 2).FitsInto(fixedDest.FixedSize)) {
+				return false;
 			}
+
+			// if source is already > 128x32, return
+			return !(Dimensions > Dimensions.Standard);
 		}
 
 		public DmdFrame TransformHdScaling(ScalerMode scalerMode)
@@ -617,7 +670,7 @@ namespace LibDmd.Frame
 			unchecked {
 				var hashCode = Dimensions.GetHashCode();
 				hashCode = (hashCode * 397) ^ BitLength;
-				hashCode = (hashCode * 397) ^ (Data != null ? Data.GetHashCode() : 0);
+				hashCode = (hashCode * 397) ^ (Data != null ? Hash.GetHashCode() : 0);
 				return hashCode;
 			}
 		}
@@ -642,7 +695,24 @@ namespace LibDmd.Frame
 			if (ReferenceEquals(a, b)) {
 				return true;
 			}
-			return a.BitLength == b.BitLength && a.Dimensions == b.Dimensions && FrameUtil.CompareBuffersFast(a.Data, b.Data);
+			if (a.BitLength != b.BitLength || a.Dimensions != b.Dimensions) {
+				return false;
+			}
+			return HashEquals(a, b) && FrameUtil.CompareBuffersFast(a.Data, b.Data);
+		}
+
+		/// <summary>
+		/// Compares the hashes of two frames if both already have one, so different
+		/// data is told apart without comparing it. Computing a hash just for this
+		/// would cost more than comparing the data, so otherwise it's left to that.
+		/// </summary>
+		/// <returns>False if the data is different, true if it's possibly the same.</returns>
+		protected static bool HashEquals(DmdFrame a, DmdFrame b)
+		{
+			if (a.Data == b.Data || !Volatile.Read(ref a._hasHash) || !Volatile.Read(ref b._hasHash)) {
+				return true;
+			}
+			return a._hash == b._hash;
 		}
 
 		bool IEqualityComparer<DmdFrame>.Equals(DmdFrame x, DmdFrame y) => Equals(x, y);
@@ -657,9 +727,15 @@ namespace LibDmd.Frame
 		/// can replace it without affecting other references of the frame).
 		/// </summary>
 		/// <returns></returns>
-		public object Clone() => new DmdFrame(Dimensions, Data, BitLength);
+		public object Clone() => CloneFrame();
 
-		public DmdFrame CloneFrame() => new DmdFrame(Dimensions, Data, BitLength);
+		/// <inheritdoc cref="Clone"/>
+		public DmdFrame CloneFrame()
+		{
+			var frame = new DmdFrame(Dimensions, Data, BitLength);
+			frame.CopyHash(this);
+			return frame;
+		}
 
 		public override string ToString()
 		{
@@ -706,29 +782,6 @@ namespace LibDmd.Frame
 
 		#endregion
 
-		#region Pool
-
-		private class ObjectPool
-		{
-			private readonly ConcurrentBag<DmdFrame> _objects = new ConcurrentBag<DmdFrame>();
-
-			public DmdFrame Get()
-			{
-				var f = _objects.TryTake(out DmdFrame item) ? item : new DmdFrame();
-				#if DEBUG
-				f.FrameId = FrameCount++;
-				#endif
-				return f;
-			}
-
-			public void Return(DmdFrame item) => _objects.Add(item);
-		}
-
-		public static DmdFrame GetFromPool() => Pool.Get();
-		public void ReturnToPool() => Pool.Return(this);
-
-		#endregion
-
 		#region Debug
 
 		public void Dump(string path, string prefix = null)
@@ -741,27 +794,6 @@ namespace LibDmd.Frame
 			}
 		}
 
-		public uint DataHash()
-		{
-			const uint fnvPrime = 16777619;
-			uint hash = 2166136261;
-
-			for (int i = 0; i < Data.Length; i++)
-			{
-				hash ^= Data[i];
-				hash *= fnvPrime;
-			}
-
-			// Final avalanche (mix bits for better distribution)
-			hash += hash << 13;
-			hash ^= hash >> 7;
-			hash += hash << 3;
-			hash ^= hash >> 17;
-			hash += hash << 5;
-
-			return hash;
-		}
-
 		#endregion
 	}
 }
\ No newline at end of file
@@ -0,0 +1,214 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Threading;
+using NLog;
+
+namespace LibDmd.Frame
+{
+	/// <summary>
+	/// A pool of frame buffers, for buffers that are only needed during a
+	/// render call, like the scratch data a device converts a frame into
+	/// before sending it to the hardware.
+	/// </summary>
+	///
+	/// <remarks>
+	/// Buffers are pooled by exact size, since most code relies on the length
+	/// of the array. The usual DMD sizes are known in advance, and a few more
+	/// are added as they are requested. Other sizes are just allocated.
+	///
+	/// Every thread keeps a few buffers of each size for itself, so renting
+	/// and returning on the same thread doesn't need any synchronization.
+	/// When a thread's cache is full, buffers go to a shared queue, where any
+	/// other thread can pick them up.
+	///
+	/// Rented buffers are not cleared. Also, never return a buffer that was
+	/// emitted as frame data, because destinations might still hold on to it
+	/// (see <see cref="DmdFrame.Data"/>).
+	/// </remarks>
+	public static class FrameBufferPool
+	{
+		/// <summary>
+		/// Number of times a buffer was taken from the pool.
+		/// </summary>
+		public static long Hits => Interlocked.Read(ref _hits);
+
+		/// <summary>
+		/// Number of times a pooled size had to be allocated, because the pool was empty.
+		/// </summary>
+		public static long Misses => Interlocked.Read(ref _misses);
+
+		/// <summary>
+		/// Number of times a size was requested that isn't pooled.
+		/// </summary>
+		public static long Unpooled => Interlocked.Read(ref _unpooled);
+
+		private const int MaxSizeClasses = 16;
+		private const int ThreadCacheSize = 4;
+		private const int MaxSharedBuffers = 16;
+
+		/// <summary>
+		/// 128x32, 192x64 and 256x64 with one, two and three bytes per pixel.
+		/// </summary>
+		private static readonly int[] KnownSizes = {
+			128 * 32, 128 * 32 * 2, 128 * 32 * 3,
+			192 * 64, 192 * 64 * 2, 192 * 64 * 3,
+			256 * 64, 256 * 64 * 2, 256 * 64 * 3,
+		};
+
+		private static SizeClass[] _sizeClasses = CreateSizeClasses();
+		private static readonly object SizeClassLock = new object();
+
+		[ThreadStatic] private static byte[][][] _threadCache;
+		[ThreadStatic] private static int[] _threadCacheCount;
+
+		private static long _hits;
+		private static long _misses;
+		private static long _unpooled;
+
+		private static readonly Logger Logger = LogManager.GetCurrentClassLogger();
+
+		/// <summary>
+		/// Returns a buffer of the given length, with undefined content.
+		/// </summary>
+		/// <param name="length">Length of the buffer in bytes</param>
+		public static byte[] Rent(int length)
+		{
+			var index = GetSizeClass(length, true);
+			if (index < 0) {
+				Interlocked.Increment(ref _unpooled);
+				return new byte[length];
+			}
+
+			var cacheCount = ThreadCacheCount;
+			if (cacheCount[index] > 0) {
+				var cache = ThreadCache[index];
+				var buffer = cache[--cacheCount[index]];
+				cache[cacheCount[index]] = null;
+				Interlocked.Increment(ref _hits);
+				return buffer;
+			}
+
+			var sizeClass = _sizeClasses[index];
+			if (sizeClass.Shared.TryDequeue(out var sharedBuffer)) {
+				Interlocked.Decrement(ref sizeClass.SharedCount);
+				Interlocked.Increment(ref _hits);
+				return sharedBuffer;
+			}
+
+			Interlocked.Increment(ref _misses);
+			return new byte[length];
+		}
+
+		/// <summary>
+		/// Gives a rented buffer back to the pool. Don't use it afterwards.
+		/// </summary>
+		/// <param name="buffer">Buffer to return. Can be null.</param>
+		public static void Return(byte[] buffer)
+		{
+			if (buffer == null) {
+				return;
+			}
+			var index = GetSizeClass(buffer.Length, false);
+			if (index < 0) {
+				return;
+			}
+
+			var cacheCount = ThreadCacheCount;
+			if (cacheCount[index] < ThreadCacheSize) {
+				ThreadCache[index][cacheCount[index]++] = buffer;
+				return;
+			}
+
+			// if the shared queue is full too, leave it to the garbage collector.
+			var sizeClass = _sizeClasses[index];
+			if (Interlocked.Increment(ref sizeClass.SharedCount) <= MaxSharedBuffers) {
+				sizeClass.Shared.Enqueue(buffer);
+			} else {
+				Interlocked.Decrement(ref sizeClass.SharedCount);
+			}
+		}
+
+		/// <summary>
+		/// Logs how well the pool did so far.
+		/// </summary>
+		public static void LogStatistics()
+		{
+			var total = Hits + Misses + Unpooled;
+			if (total == 0) {
+				return;
+			}
+			Logger.Debug("Frame buffer pool: {0} hits, {1} misses, {2} unpooled ({3:0.#}% hit rate).", Hits, Misses, Unpooled, 100d * Hits / total);
+		}
+
+		private static int GetSizeClass(int length, bool create)
+		{
+			var sizeClasses = _sizeClasses;
+			for (var i = 0; i < sizeClasses.Length; i++) {
+				if (sizeClasses[i].Length == length) {
+					return i;
+				}
+			}
+			if (!create || length <= 0) {
+				return -1;
+			}
+
+			lock (SizeClassLock) {
+				sizeClasses = _sizeClasses;
+				for (var i = 0; i < sizeClasses.Length; i++) {
+					if (sizeClasses[i].Length == length) {
+						return i;
+					}
+				}
+				if (sizeClasses.Length == MaxSizeClasses) {
+					return -1;
+				}
+
+				// readers iterate over the array without locking, so replace it instead of changing it.
+				var newSizeClasses = new SizeClass[sizeClasses.Length + 1];
+				Array.Copy(sizeClasses, newSizeClasses, sizeClasses.Length);
+				newSizeClasses[sizeClasses.Length] = new SizeClass(length);
+				Volatile.Write(ref _sizeClasses, newSizeClasses);
+				return sizeClasses.Length;
+			}
+		}
+
+		private static byte[][][] ThreadCache {
+			get {
+				if (_threadCache == null) {
+					_threadCache = new byte[MaxSizeClasses][][];
+					for (var i = 0; i < MaxSizeClasses; i++) {
+						_threadCache[i] = new byte[ThreadCacheSize][];
+					}
+				}
+				return _threadCache;
+			}
+		}
+
+		private static int[] ThreadCacheCount => _threadCacheCount ?? (_threadCacheCount = new int[MaxSizeClasses]);
+
+		private static SizeClass[] CreateSizeClasses()
+		{
+			var sizeClasses = new SizeClass[0];
+			foreach (var size in KnownSizes) {
+				if (Array.Exists(sizeClasses, c => c.Length == size)) {
+					continue;
+				}
+				Array.Resize(ref sizeClasses, sizeClasses.Length + 1);
+				sizeClasses[sizeClasses.Length - 1] = new SizeClass(size);
+			}
+			return sizeClasses;
+		}
+
+		private class SizeClass
+		{
+			public readonly int Length;
+			public readonly ConcurrentQueue<byte[]> Shared = new ConcurrentQueue<byte[]>();
+			public int SharedCount;
+
+			public SizeClass(int length)
+			{
+				Length = length;
+			}
+		}
+	}
+}
@@ -0,0 +1,171 @@
+﻿using System;
+using System.Windows.Media;
+using LibDmd.Common;
+using LibDmd.Output;
+
+namespace LibDmd.Frame
+{
+	/// <summary>
+	/// Converts grayscale frames to RGB24 or RGB565 for one destination of
+	/// the render graph, doing HD scaling, palette lookup and flipping in a
+	/// single pass.
+	/// </summary>
+	///
+	/// <remarks>
+	/// This produces the same result as <see cref="DmdFrame.TransformHdScaling(IFixedSizeDestination, ScalerMode)"/>
+	/// followed by <see cref="DmdFrame.ConvertGrayToRgb24"/> and <see cref="DmdFrame.TransformRgb24"/>
+	/// (or their RGB565 counterparts), but without an intermediate buffer
+	/// for every step.
+	///
+	/// Doubling and flipping only move pixels around, so they are combined
+	/// into a map pointing every destination pixel to its source pixel. The
+	/// map only depends on the dimensions and flags, so it's computed once
+	/// and kept until they change. Scale2x looks at neighboring pixels, so
+	/// it's still done before, but on the gray frame, which is the smallest.
+	///
+	/// If the frame needs to be resized for the destination, this falls back
+	/// to the separate steps.
+	/// </remarks>
+	public class GrayToRgbPipeline
+	{
+		private readonly RenderGraph _renderGraph;
+		private readonly IFixedSizeDestination _fixedDest;
+		private readonly IMultiSizeDestination _multiDest;
+		private readonly int _bytesPerPixel;
+
+		private int[] _map;
+		private Dimensions _mapDim;
+		private bool _mapDoubled;
+		private bool _mapFlipHorizontally;
+		private bool _mapFlipVertically;
+
+		/// <param name="renderGraph">Render graph to retrieve the flipping and scaling config from</param>
+		/// <param name="fixedDest">If not null, the fixed destination we're converting for</param>
+		/// <param name="multiDest">If not null, the multi-res destination we're converting for</param>
+		/// <param name="bytesPerPixel">3 for RGB24, 2 for RGB565</param>
+		public GrayToRgbPipeline(RenderGraph renderGraph, IFixedSizeDestination fixedDest, IMultiSizeDestination multiDest, int bytesPerPixel)
+		{
+			if (bytesPerPixel != 2 && bytesPerPixel != 3) {
+				throw new ArgumentException("Unsupported number of bytes per pixel.");
+			}
+			_renderGraph = renderGraph;
+			_fixedDest = fixedDest;
+			_multiDest = multiDest;
+			_bytesPerPixel = bytesPerPixel;
+		}
+
+		/// <summary>
+		/// Converts a grayscale frame for the destination.
+		/// </summary>
+		/// <param name="frame">Grayscale frame</param>
+		/// <param name="palette">Colors to use for the gray shades</param>
+		/// <returns>Updated frame instance</returns>
+		public DmdFrame Process(DmdFrame frame, Color[] palette)
+		{
+			using (Profiler.Start("GrayToRgbPipeline.Process")) {
+
+				var scalerMode = _renderGraph.ScalerMode;
+				var scale = frame.CanHdScale(_fixedDest, scalerMode);
+				var targetDim = scale ? frame.Dimensions * 2 : frame.Dimensions;
+
+				// resizing needs the bitmap, so do it step by step.
+				if (_fixedDest != null && _fixedDest.FixedSize != targetDim) {
+					var scaledFrame = frame.TransformHdScaling(_fixedDest, scalerMode);
+					return _bytesPerPixel == 3
+						? scaledFrame.ConvertGrayToRgb24(palette).TransformRgb24(_renderGraph, _fixedDest, _multiDest)
+						: scaledFrame.ConvertGrayToRgb565(palette).TransformRgb565(_renderGraph, _fixedDest, _multiDest);
+				}
+
+				var srcDim = frame.Dimensions;
+				var srcData = frame.Data;
+				var doubled = scale;
+				if (scale && scalerMode == ScalerMode.Scale2x) {
+					srcData = FrameUtil.Scale2X(srcDim, srcData, 1);
+					srcDim = targetDim;
+					doubled = false;
+				}
+
+				var map = GetMap(srcDim, doubled, _renderGraph.FlipHorizontally, _renderGraph.FlipVertically);
+				var data = Colorize(srcData, targetDim.Surface, map, palette);
+				return frame.Update(targetDim, data, _bytesPerPixel * 8, frame.IsIdentifyFrame);
+			}
+		}
+
+		private unsafe byte[] Colorize(byte[] srcData, int numPixels, int[] map, Color[] palette)
+		{
+			if (palette.Length == 0) {
+				throw new ArgumentException("Cannot colorize with an empty palette.");
+			}
+
+			// one packed color per possible pixel value, so there's no need to check the range per pixel.
+			var colors = stackalloc uint[256];
+			for (var i = 0; i < 256; i++) {
+				var color = palette[Math.Min(i, palette.Length - 1)];
+				colors[i] = _bytesPerPixel == 3
+					? (uint)(color.R | color.G << 8 | color.B << 16)
+					: ColorUtil.PackRgb565(color.R, color.G, color.B);
+			}
+
+			var data = new byte[numPixels * _bytesPerPixel];
+			if (numPixels == 0) {
+				return data;
+			}
+
+			fixed (byte* pSrc = srcData, pDest = data)
+			fixed (int* pMap = map) {
+				var last = numPixels - 1;
+				if (_bytesPerPixel == 3) {
+					// write four bytes per pixel, the fourth is overwritten by the next pixel.
+					var dest = pDest;
+					for (var i = 0; i < last; i++, dest += 3) {
+						*(uint*)dest = colors[pSrc[pMap == null ? i : pMap[i]]];
+					}
+					var lastColor = colors[pSrc[pMap == null ? last : pMap[last]]];
+					dest[0] = (byte)lastColor;
+					dest[1] = (byte)(lastColor >> 8);
+					dest[2] = (byte)(lastColor >> 16);
+
+				} else {
+					var dest = (ushort*)pDest;
+					for (var i = 0; i <= last; i++) {
+						dest[i] = (ushort)colors[pSrc[pMap == null ? i : pMap[i]]];
+					}
+				}
+			}
+			return data;
+		}
+
+		/// <summary>
+		/// Returns the source index of every destination pixel, or null if they are the same.
+		/// </summary>
+		private int[] GetMap(Dimensions srcDim, bool doubled, bool flipHorizontally, bool flipVertically)
+		{
+			if (!doubled && !flipHorizontally && !flipVertically) {
+				return null;
+			}
+			if (_map != null && _mapDim == srcDim && _mapDoubled == doubled && _mapFlipHorizontally == flipHorizontally && _mapFlipVertically == flipVertically) {
+				return _map;
+			}
+
+			var shift = doubled ? 1 : 0;
+			var width = srcDim.Width << shift;
+			var height = srcDim.Height << shift;
+			var map = new int[width * height];
+			var pos = 0;
+			for (var y = 0; y < height; y++) {
+				var srcY = (flipVertically ? height - y - 1 : y) >> shift;
+				for (var x = 0; x < width; x++) {
+					var srcX = (flipHorizontally ? width - x - 1 : x) >> shift;
+					map[pos++] = srcY * srcDim.Width + srcX;
+				}
+			}
+
+			_map = map;
+			_mapDim = srcDim;
+			_mapDoubled = doubled;
+			_mapFlipHorizontally = flipHorizontally;
+			_mapFlipVertically = flipVertically;
+			return map;
+		}
+	}
+}
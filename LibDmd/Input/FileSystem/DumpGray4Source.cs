@@ -0,0 +1,44 @@
+﻿using System;
+using System.IO;
+using System.Reactive;
+using System.Reactive.Subjects;
+using LibDmd.Frame;
+
+namespace LibDmd.Input.FileSystem
+{
+	/// <summary>
+	/// Plays back the 4-bit frames of a binary dump, see <see cref="DumpSource"/>.
+	/// </summary>
+	public class DumpGray4Source : AbstractSource, IGray4Source, IGameNameSource
+	{
+		public override string Name => "Dump File (4-bit)";
+		public IObservable<Unit> OnResume => null;
+		public IObservable<Unit> OnPause => null;
+
+		public IObservable<string> GetGameName() => _gameName;
+
+		private readonly string _filename;
+		private readonly TimeSpan _startTime;
+		private readonly bool _realTime;
+
+		private readonly Subject<string> _gameName = new Subject<string>();
+
+		/// <param name="filename">Path to the binary dump</param>
+		/// <param name="startTime">Where to start playing, relative to the first frame</param>
+		/// <param name="realTime">If true, play at the recorded speed, otherwise as fast as possible</param>
+		public DumpGray4Source(string filename, TimeSpan startTime = default, bool realTime = true)
+		{
+			_filename = filename;
+			_startTime = startTime;
+			_realTime = realTime;
+			if (!File.Exists(_filename)) {
+				throw new ArgumentException($"File {_filename} does not exist.");
+			}
+		}
+
+		public IObservable<DmdFrame> GetGray4Frames(bool dedupe, bool skipIdentificationFrames)
+		{
+			return DumpSource.PlayDump(_filename, 4, _startTime, _realTime, _gameName);
+		}
+	}
+}
@@ -0,0 +1,211 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.IO.MemoryMappedFiles;
+using System.Text;
+using LibDmd.Common;
+using LibDmd.Frame;
+using NLog;
+
+namespace LibDmd.Input.FileSystem
+{
+	/// <summary>
+	/// Reads frames from a binary dump, see <see cref="DumpFormat"/>.
+	/// </summary>
+	///
+	/// <remarks>
+	/// The file is memory-mapped and only the index is loaded, so opening
+	/// even hours of frames is instant, and any frame can be read without
+	/// going through the ones before.
+	/// </remarks>
+	public class DumpReader : IDisposable
+	{
+		/// <summary>
+		/// Name of the game that was recorded.
+		/// </summary>
+		public string GameName { get; }
+
+		/// <summary>
+		/// Number of frames in the dump.
+		/// </summary>
+		public int Count => _timestamps.Length;
+
+		/// <summary>
+		/// Timestamp of the last frame in milliseconds.
+		/// </summary>
+		public long Duration => Count == 0 ? 0 : _timestamps[Count - 1];
+
+		private readonly MemoryMappedFile _file;
+		private readonly MemoryMappedViewAccessor _view;
+		private readonly long[] _timestamps;
+		private readonly long[] _offsets;
+		private byte[] _buffer = new byte[0];
+
+		private static readonly Logger Logger = LogManager.GetCurrentClassLogger();
+
+		/// <summary>
+		/// Checks whether a file is a binary dump.
+		/// </summary>
+		public static bool IsDump(string path)
+		{
+			using (var stream = File.OpenRead(path)) {
+				var magic = new byte[4];
+				return stream.Read(magic, 0, 4) == 4 && BitConverter.ToUInt32(magic, 0) == DumpFormat.Magic;
+			}
+		}
+
+		public DumpReader(string path)
+		{
+			var length = new FileInfo(path).Length;
+			if (length < 8) {
+				throw new InvalidDataException($"{path} is not a frame dump.");
+			}
+			// share the file, so it can still be copied or read while it's played back. the mapping closes the stream.
+			var stream = new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.Read);
+			_file = MemoryMappedFile.CreateFromFile(stream, null, 0, MemoryMappedFileAccess.Read, null, HandleInheritability.None, false);
+			_view = _file.CreateViewAccessor(0, length, MemoryMappedFileAccess.Read);
+
+			if (_view.ReadUInt32(0) != DumpFormat.Magic) {
+				Dispose();
+				throw new InvalidDataException($"{path} is not a frame dump.");
+			}
+			var version = _view.ReadUInt16(4);
+			if (version > DumpFormat.Version) {
+				Dispose();
+				throw new InvalidDataException($"{path} was written by a newer version (format {version}).");
+			}
+			var nameLength = _view.ReadUInt16(6);
+			var name = new byte[nameLength];
+			_view.ReadArray(8, name, 0, nameLength);
+			GameName = Encoding.UTF8.GetString(name);
+			var firstFrame = 8L + nameLength;
+
+			if (!ReadIndex(length, firstFrame, out _timestamps, out _offsets)) {
+				Logger.Warn("[dump] No index found in {0}, scanning frames.", path);
+				ScanIndex(length, firstFrame, out _timestamps, out _offsets);
+			}
+		}
+
+		/// <summary>
+		/// Returns the timestamp of a frame in milliseconds since the start of the recording.
+		/// </summary>
+		public long GetTimestamp(int index) => _timestamps[index];
+
+		/// <summary>
+		/// Returns the bit length of a frame without reading its data.
+		/// </summary>
+		public int GetBitLength(int index) => _view.ReadByte(_offsets[index] + 12);
+
+		/// <summary>
+		/// Returns the bit lengths of all frames in the dump.
+		/// </summary>
+		public HashSet<int> GetBitLengths()
+		{
+			var bitLengths = new HashSet<int>();
+			for (var i = 0; i < Count; i++) {
+				bitLengths.Add(GetBitLength(i));
+			}
+			return bitLengths;
+		}
+
+		/// <summary>
+		/// Returns the first frame at or after a given time.
+		/// </summary>
+		/// <param name="timestamp">Milliseconds since the start of the recording</param>
+		/// <returns>Frame index, or <see cref="Count"/> if the time is after the last frame.</returns>
+		public int IndexOf(long timestamp)
+		{
+			var index = Array.BinarySearch(_timestamps, timestamp);
+			if (index < 0) {
+				return ~index;
+			}
+			// timestamps can repeat, so go back to the first one.
+			while (index > 0 && _timestamps[index - 1] == timestamp) {
+				index--;
+			}
+			return index;
+		}
+
+		/// <summary>
+		/// Reads a frame.
+		/// </summary>
+		/// <param name="index">Frame index</param>
+		/// <param name="frame">Frame to update</param>
+		/// <returns>The updated frame, with new data.</returns>
+		public DmdFrame ReadFrame(int index, DmdFrame frame)
+		{
+			var offset = _offsets[index];
+			var width = _view.ReadUInt16(offset + 8);
+			var height = _view.ReadUInt16(offset + 10);
+			var bitLength = _view.ReadByte(offset + 12);
+			var compression = _view.ReadByte(offset + 13);
+			var length = _view.ReadInt32(offset + 14);
+
+			var data = new byte[DumpFormat.FrameSize(width, height, bitLength)];
+			switch (compression) {
+				case DumpFormat.CompressionNone:
+					_view.ReadArray(offset + DumpFormat.FrameHeaderSize, data, 0, Math.Min(length, data.Length));
+					break;
+
+				case DumpFormat.CompressionDeflate:
+					if (_buffer.Length < length) {
+						_buffer = new byte[length];
+					}
+					_view.ReadArray(offset + DumpFormat.FrameHeaderSize, _buffer, 0, length);
+					DumpFormat.Decompress(_buffer, length, data);
+					break;
+
+				default:
+					throw new InvalidDataException($"Unknown compression {compression} at frame {index}.");
+			}
+			return frame.Update(new Dimensions(width, height), data, bitLength);
+		}
+
+		private bool ReadIndex(long length, long firstFrame, out long[] timestamps, out long[] offsets)
+		{
+			timestamps = null;
+			offsets = null;
+			if (length < firstFrame + DumpFormat.FooterSize || _view.ReadUInt32(length - 4) != DumpFormat.IndexMagic) {
+				return false;
+			}
+			var indexOffset = _view.ReadInt64(length - DumpFormat.FooterSize);
+			var count = _view.ReadInt32(length - DumpFormat.FooterSize + 8);
+			if (count < 0 || indexOffset < firstFrame || indexOffset + (long)count * DumpFormat.IndexEntrySize != length - DumpFormat.FooterSize) {
+				return false;
+			}
+			timestamps = new long[count];
+			offsets = new long[count];
+			for (var i = 0; i < count; i++) {
+				timestamps[i] = _view.ReadInt64(indexOffset + i * DumpFormat.IndexEntrySize);
+				offsets[i] = _view.ReadInt64(indexOffset + i * DumpFormat.IndexEntrySize + 8);
+			}
+			return true;
+		}
+
+		private void ScanIndex(long length, long firstFrame, out long[] timestamps, out long[] offsets)
+		{
+			var timestampList = new List<long>();
+			var offsetList = new List<long>();
+			var offset = firstFrame;
+			while (offset + DumpFormat.FrameHeaderSize <= length) {
+				var dataLength = _view.ReadInt32(offset + 14);
+				var next = offset + DumpFormat.FrameHeaderSize + dataLength;
+				if (dataLength < 0 || next > length) {
+					// last frame was cut off.
+					break;
+				}
+				timestampList.Add(_view.ReadInt64(offset));
+				offsetList.Add(offset);
+				offset = next;
+			}
+			timestamps = timestampList.ToArray();
+			offsets = offsetList.ToArray();
+		}
+
+		public void Dispose()
+		{
+			_view?.Dispose();
+			_file?.Dispose();
+		}
+	}
+}
@@ -1,5 +1,6 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Diagnostics;
 using System.Globalization;
 using System.IO;
 using System.Linq;
@@ -14,6 +15,14 @@ using NLog;
 
 namespace LibDmd.Input.FileSystem
 {
+	/// <summary>
+	/// Plays back frames dumped by <see cref="Output.FileOutput.RawOutput"/>.
+	/// </summary>
+	///
+	/// <remarks>
+	/// Both the text and the binary format are supported. Binary dumps can
+	/// contain 4-bit frames as well, which are played by <see cref="DumpGray4Source"/>.
+	/// </remarks>
 	public class DumpSource : AbstractSource, IGray2Source, IGameNameSource
 	{
 		public override string Name => "Dump File";
@@ -23,20 +32,36 @@ namespace LibDmd.Input.FileSystem
 		public IObservable<string> GetGameName() => _gameName;
 
 		private readonly string _filename;
+		private readonly TimeSpan _startTime;
+		private readonly bool _realTime;
+		private readonly bool _isBinary;
 
 		private readonly Subject<string> _gameName = new Subject<string>();
 
 		private static readonly Logger Logger = LogManager.GetCurrentClassLogger();
 
-		public DumpSource(string filename)
+		/// <param name="filename">Path to the dump</param>
+		/// <param name="startTime">Where to start playing, relative to the first frame</param>
+		/// <param name="realTime">If true, play at the recorded speed, otherwise as fast as possible</param>
+		public DumpSource(string filename, TimeSpan startTime = default, bool realTime = true)
 		{
 			_filename = filename;
+			_startTime = startTime;
+			_realTime = realTime;
 			if (!File.Exists(_filename)) {
 				throw new ArgumentException($"File {_filename} does not exist.");
 			}
+			_isBinary = DumpReader.IsDump(_filename);
 		}
 
 		public IObservable<DmdFrame> GetGray2Frames(bool dedupe, bool skipIdentificationFrames)
+		{
+			return _isBinary
+				? PlayDump(_filename, 2, _startTime, _realTime, _gameName)
+				: PlayText();
+		}
+
+		private IObservable<DmdFrame> PlayText()
 		{
 			const Int32 bufferSize = 128;
 			_gameName.OnNext(Path.GetFileNameWithoutExtension(_filename).TrimEnd('-'));
@@ -48,6 +73,7 @@ namespace LibDmd.Input.FileSystem
 					using (var streamReader = new StreamReader(fileStream, Encoding.UTF8, true, bufferSize)) {
 
 						Logger.Info($"[dump] Starting to stream frames from {_filename}");
+						var firstTimestamp = 0L;
 						var lastTimestamp = 0L;
 						var frame = new DmdFrame(128, 32, 2);
 						var data = new List<byte>();
@@ -61,6 +87,7 @@ namespace LibDmd.Input.FileSystem
 
 							var timestamp = long.Parse(line.Substring(2), NumberStyles.HexNumber);
 							if (lastTimestamp == 0) {
+								firstTimestamp = timestamp;
 								lastTimestamp = timestamp;
 							}
 
@@ -79,13 +106,15 @@ namespace LibDmd.Input.FileSystem
 								height++;
 							} while (!string.IsNullOrEmpty(line));
 
-							var wait = timestamp - lastTimestamp;
-							if (wait < 0 || wait > 2000) {
-								wait = 0;
+							if (timestamp - firstTimestamp >= _startTime.TotalMilliseconds) {
+								var wait = timestamp - lastTimestamp;
+								if (wait < 0 || wait > 2000 || !_realTime) {
+									wait = 0;
+								}
+								await Task.Delay((int)wait, token);
+								frame.Update(new Dimensions(width, height), data.ToArray());
+								subject.OnNext(frame);
 							}
-							await Task.Delay((int)wait, token);
-							frame.Update(new Dimensions(width, height), data.ToArray());
-							subject.OnNext(frame);
 
 							line = await streamReader.ReadLineAsync();
 							lastTimestamp = timestamp;
@@ -101,5 +130,51 @@ namespace LibDmd.Input.FileSystem
 				return Disposable.Empty;
 			});
 		}
+
+		/// <summary>
+		/// Plays the frames of a given bit length from a binary dump.
+		/// </summary>
+		/// <remarks>
+		/// Frames are scheduled relative to when playback started, so sources
+		/// playing different bit lengths of the same dump stay in sync.
+		/// </remarks>
+		internal static IObservable<DmdFrame> PlayDump(string filename, int bitLength, TimeSpan startTime, bool realTime, ISubject<string> gameName)
+		{
+			return Observable.Create<DmdFrame>(async (subject, token) =>
+			{
+				try {
+					using (var reader = new DumpReader(filename)) {
+
+						gameName.OnNext(reader.GameName);
+						var start = reader.IndexOf((long)startTime.TotalMilliseconds);
+						Logger.Info("[dump] Starting to stream {0}-bit frames from {1} at frame {2}/{3}.", bitLength, filename, start, reader.Count);
+
+						var frame = new DmdFrame();
+						var firstTimestamp = start < reader.Count ? reader.GetTimestamp(start) : 0;
+						var clock = Stopwatch.StartNew();
+						for (var i = start; i < reader.Count; i++) {
+							if (reader.GetBitLength(i) != bitLength) {
+								continue;
+							}
+							if (realTime) {
+								var wait = reader.GetTimestamp(i) - firstTimestamp - clock.ElapsedMilliseconds;
+								if (wait > 0) {
+									await Task.Delay((int)wait, token);
+								}
+							}
+							token.ThrowIfCancellationRequested();
+							subject.OnNext(reader.ReadFrame(i, frame));
+						}
+					}
+				}
+				catch (Exception ex) {
+					subject.OnError(ex);
+				}
+				finally {
+					subject.OnCompleted();
+				}
+				return Disposable.Empty;
+			});
+		}
 	}
 }
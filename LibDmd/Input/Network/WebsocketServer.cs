@@ -1,4 +1,5 @@
-﻿using System.Collections.Generic;
+﻿using System;
+using System.Collections.Generic;
 using System.Net;
 using System.Text;
 using System.Windows.Media;
@@ -147,6 +148,13 @@ namespace LibDmd.Input.Network
 	
 		protected override void OnMessage(MessageEventArgs e)
 		{
+			// agree on the protocol version, which allows the client to send deltas.
+			if (WebsocketSerializer.TryReadHello(e.RawData, out var version)) {
+				var agreed = Math.Min(version, WebsocketSerializer.Version);
+				Logger.Info("WebSocket client {0} speaks protocol version {1}, using {2}.", ID, version, agreed);
+				Send(_serializer.SerializeHello(agreed));
+				return;
+			}
 			_serializer.Unserialize(e.RawData, _src);
 		}
 
@@ -32,6 +32,7 @@ namespace LibDmd.Input.ProPinball
 		private IObservable<DmdFrame> _framesGray4;
 		private readonly DmdFrame _dmdFrame = new DmdFrame();
 		private readonly BehaviorSubject<string> _gameName = new BehaviorSubject<string>("ProPinballUltra_Timeshock");
+		private readonly Subject<ProPinballBridge.FeedbackEvent> _feedback = new Subject<ProPinballBridge.FeedbackEvent>();
 
 		private static readonly Logger Logger = LogManager.GetCurrentClassLogger();
 
@@ -45,6 +46,17 @@ namespace LibDmd.Input.ProPinball
 
 		public IObservable<string> GetGameName() => _gameName;
 
+		/// <summary>
+		/// Flashers, solenoids, flippers and button lights as they change.
+		/// Only emits while frames are subscribed, since both come through the same loop.
+		/// </summary>
+		public IObservable<ProPinballBridge.FeedbackEvent> GetFeedback() => _feedback;
+
+		/// <summary>
+		/// Timing and drop counters of the bridge's frame loop, or null if not connected yet.
+		/// </summary>
+		public ProPinballBridge.FrameStatistics? Statistics => _bridge?.GetStatistics();
+
 		public IObservable<DmdFrame> GetGray4Frames(bool dedupe, bool skipIdentificationFrames)
 		{
 			if (_framesGray4 != null) {
@@ -59,14 +71,18 @@ namespace LibDmd.Input.ProPinball
 				var thread = new Thread(() => {
 					unsafe {
 						_bridge.GetFrames(frame => {
-							var updatedFrame = _dmdFrame.Update(_dimensions, new byte[4096], 4);
-							Marshal.Copy((IntPtr)frame, updatedFrame.Data, 0, 4096);
-							o.OnNext(updatedFrame);
+							// with shared memory, this copies straight out of the master's ring, which might overwrite it meanwhile.
+							var data = new byte[4096];
+							Marshal.Copy((IntPtr)frame, data, 0, data.Length);
+							if (_bridge.FrameIsCurrent()) {
+								o.OnNext(_dmdFrame.Update(_dimensions, data, 4));
+							}
 
 						}, err => throw new ProPinballSlaveException(new string(err)), () => {
 							Logger.Debug("Received exit signal from Pro Pinball, closing.");
+							LogStatistics();
 							Process.GetCurrentProcess().Kill();
-						});
+						}, feedback => _feedback.OnNext(feedback));
 					}
 				});
 				thread.Start();
@@ -74,6 +90,7 @@ namespace LibDmd.Input.ProPinball
 
 				return Disposable.Create(() => {
 					thread.Abort();
+					LogStatistics();
 					Logger.Debug("Disposing Pro Pinball's message queue...");
 				});
 			});
@@ -91,6 +108,35 @@ namespace LibDmd.Input.ProPinball
 					throw new ProPinballSlaveException("Error connecting: " + new string(_bridge.Error));
 				}
 			}
+			Logger.Info(_bridge.SharedMemory
+				? "Pro Pinball provides frames through shared memory."
+				: "Pro Pinball provides frames through its message queue.");
+		}
+
+		private void LogStatistics()
+		{
+			var stats = _bridge.GetStatistics();
+			Logger.Info("Pro Pinball frame statistics: {0} frames in {1} wake-ups, {2} dropped, {3} torn.", stats.Frames, stats.Wakeups, stats.Dropped, stats.Torn);
+			Logger.Info("  Interval:   {0}", FormatTime(stats.Interval));
+			Logger.Info("  Callback:   {0}", FormatTime(stats.Callback));
+			Logger.Info("  Age:        {0}", FormatTime(stats.Age));
+			Logger.Info("  Queue:      {0}", FormatCount(stats.QueueDepth));
+			Logger.Info("  Per wakeup: {0}", FormatCount(stats.FramesPerWakeup));
+		}
+
+		private static string FormatTime(ProPinballBridge.FramePercentiles percentiles)
+		{
+			// the bridge measures in microseconds
+			return percentiles.Count == 0
+				? "n/a"
+				: $"p50 {percentiles.P50 / 1000d:0.##}ms, p99 {percentiles.P99 / 1000d:0.##}ms, max {percentiles.Max / 1000d:0.##}ms ({percentiles.Count} samples)";
+		}
+
+		private static string FormatCount(ProPinballBridge.FramePercentiles percentiles)
+		{
+			return percentiles.Count == 0
+				? "n/a"
+				: $"p50 {percentiles.P50}, p99 {percentiles.P99}, max {percentiles.Max} ({percentiles.Count} samples)";
 		}
 	}
 
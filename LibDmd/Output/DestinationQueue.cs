@@ -0,0 +1,226 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Reactive.Concurrency;
+using System.Reactive.Disposables;
+using System.Reactive.Linq;
+using LibDmd.Common;
+using NLog;
+
+namespace LibDmd.Output
+{
+	/// <summary>
+	/// Decouples a destination from its sources, so a slow destination only
+	/// delays itself.
+	/// </summary>
+	///
+	/// <remarks>
+	/// Every connection to the destination gets a slot holding the next frame
+	/// to render. When a new frame arrives before the previous one was picked
+	/// up, the previous one is dropped, so a stalled device skips to the most
+	/// recent frame instead of building up a backlog. Errors and completion
+	/// go through the slot as well, after its pending frame.
+	///
+	/// Slots are drained by a single worker per destination, so a destination
+	/// never renders more than one frame at the time, and other destinations
+	/// don't wait for it. The worker is either a thread pool job or a
+	/// <see cref="PipelineStage"/>, which is a dedicated thread.
+	/// </remarks>
+	public class DestinationQueue
+	{
+		/// <summary>
+		/// Name of the destination, for logging.
+		/// </summary>
+		public readonly string Name;
+
+		/// <summary>
+		/// Number of frames received from the sources.
+		/// </summary>
+		public long Received { get { lock (_gate) { return _received; } } }
+
+		/// <summary>
+		/// Number of frames that were replaced by a newer one before being rendered.
+		/// </summary>
+		public long Dropped { get { lock (_gate) { return _dropped; } } }
+
+		/// <summary>
+		/// Number of frames passed on to the destination.
+		/// </summary>
+		public long Rendered { get { lock (_gate) { return _rendered; } } }
+
+		/// <summary>
+		/// The longest time a frame waited in the queue.
+		/// </summary>
+		public TimeSpan MaxAge { get { lock (_gate) { return TicksToTime(_maxAgeTicks); } } }
+
+		/// <summary>
+		/// The average time a frame waited in the queue.
+		/// </summary>
+		public TimeSpan AverageAge { get { lock (_gate) { return _rendered == 0 ? TimeSpan.Zero : TicksToTime(_totalAgeTicks / _rendered); } } }
+
+		private readonly Action<Action> _schedule;
+		private readonly object _gate = new object();
+		private readonly List<Slot> _slots = new List<Slot>();
+		private int _nextSlot;
+		private bool _running;
+
+		private long _received;
+		private long _dropped;
+		private long _rendered;
+		private long _maxAgeTicks;
+		private long _totalAgeTicks;
+
+		private static readonly Logger Logger = LogManager.GetCurrentClassLogger();
+
+		/// <param name="name">Name of the destination</param>
+		/// <param name="scheduler">Where the worker runs</param>
+		public DestinationQueue(string name, IScheduler scheduler)
+		{
+			Name = name;
+			_schedule = drain => scheduler.Schedule(drain);
+		}
+
+		/// <param name="name">Name of the destination</param>
+		/// <param name="stage">Thread the worker runs on</param>
+		public DestinationQueue(string name, PipelineStage stage)
+		{
+			Name = name;
+			_schedule = stage.Post;
+		}
+
+		/// <summary>
+		/// Moves a stream of frames onto the destination's worker, dropping
+		/// frames the destination can't keep up with.
+		/// </summary>
+		/// <param name="frames">Frames to render</param>
+		/// <typeparam name="T">Frame type</typeparam>
+		/// <returns>The frames to render, emitted on the worker</returns>
+		public IObservable<T> Coalesce<T>(IObservable<T> frames)
+		{
+			return Observable.Create<T>(observer => {
+				var slot = new Slot();
+				lock (_gate) {
+					_slots.Add(slot);
+				}
+				var subscription = frames.Subscribe(
+					frame => Post(slot, () => observer.OnNext(frame)),
+					error => Terminate(slot, () => observer.OnError(error)),
+					() => Terminate(slot, observer.OnCompleted)
+				);
+				return Disposable.Create(() => {
+					subscription.Dispose();
+					lock (_gate) {
+						_slots.Remove(slot);
+						slot.Pending = null;
+						slot.Terminal = null;
+					}
+				});
+			});
+		}
+
+		/// <summary>
+		/// Logs how the destination kept up.
+		/// </summary>
+		public void LogStatistics()
+		{
+			lock (_gate) {
+				if (_received == 0) {
+					return;
+				}
+				Logger.Info("[{0}] {1} frames received, {2} rendered, {3} dropped. Queue age: avg {4:0.##}ms, max {5:0.##}ms.",
+					Name, _received, _rendered, _dropped, AverageAge.TotalMilliseconds, MaxAge.TotalMilliseconds);
+			}
+		}
+
+		private void Post(Slot slot, Action render)
+		{
+			lock (_gate) {
+				_received++;
+				if (slot.Pending != null) {
+					_dropped++;
+				}
+				slot.Pending = render;
+				slot.Enqueued = Stopwatch.GetTimestamp();
+				if (_running) {
+					return;
+				}
+				_running = true;
+			}
+			_schedule(Drain);
+		}
+
+		/// <summary>
+		/// Queues the end of a slot's stream, so the destination gets it on the
+		/// worker like the frames, and only after the pending one.
+		/// </summary>
+		private void Terminate(Slot slot, Action terminal)
+		{
+			lock (_gate) {
+				slot.Terminal = terminal;
+				if (_running) {
+					return;
+				}
+				_running = true;
+			}
+			_schedule(Drain);
+		}
+
+		private void Drain()
+		{
+			while (true) {
+				Action render;
+				lock (_gate) {
+					render = Take();
+					if (render == null) {
+						_running = false;
+						return;
+					}
+				}
+				try {
+					render();
+
+				} catch (Exception e) {
+					Logger.Error(e, "[{0}] Error rendering frame.", Name);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Takes the next pending frame, or the end of a stream once its last
+		/// frame was taken, going through the slots in turn. Must be called within the lock.
+		/// </summary>
+		private Action Take()
+		{
+			for (var i = 0; i < _slots.Count; i++) {
+				var slot = _slots[(_nextSlot + i) % _slots.Count];
+				if (slot.Pending != null) {
+					var render = slot.Pending;
+					slot.Pending = null;
+					_nextSlot = (_nextSlot + i + 1) % _slots.Count;
+
+					var age = Stopwatch.GetTimestamp() - slot.Enqueued;
+					_rendered++;
+					_totalAgeTicks += age;
+					_maxAgeTicks = Math.Max(_maxAgeTicks, age);
+					return render;
+				}
+				if (slot.Terminal != null) {
+					var terminal = slot.Terminal;
+					slot.Terminal = null;
+					_nextSlot = (_nextSlot + i + 1) % _slots.Count;
+					return terminal;
+				}
+			}
+			return null;
+		}
+
+		private static TimeSpan TicksToTime(long ticks) => TimeSpan.FromSeconds((double)ticks / Stopwatch.Frequency);
+
+		private class Slot
+		{
+			public Action Pending;
+			public Action Terminal;
+			public long Enqueued;
+		}
+	}
+}
@@ -0,0 +1,214 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.IO;
+using System.Text;
+using System.Threading;
+using LibDmd.Common;
+using LibDmd.Frame;
+using NLog;
+
+namespace LibDmd.Output.FileOutput
+{
+	/// <summary>
+	/// Writes frames into a binary dump, see <see cref="DumpFormat"/>.
+	/// </summary>
+	///
+	/// <remarks>
+	/// Frames are copied into a preallocated buffer, and a background thread
+	/// compresses and writes them to disk, so the render path doesn't wait
+	/// for the file system. The buffers are swapped when the thread picks
+	/// them up. If the disk is so slow that the buffer is full, frames are
+	/// dropped and counted.
+	/// </remarks>
+	public class DumpWriter : IDisposable
+	{
+		/// <summary>
+		/// Number of frames written to disk.
+		/// </summary>
+		public long Written => Interlocked.Read(ref _written);
+
+		/// <summary>
+		/// Number of frames dropped because the buffer was full.
+		/// </summary>
+		public long Dropped => Interlocked.Read(ref _dropped);
+
+		private readonly bool _compress;
+		private readonly FileStream _stream;
+		private readonly BinaryWriter _writer;
+		private readonly Thread _thread;
+		private readonly Stopwatch _clock = Stopwatch.StartNew();
+		private readonly List<long> _indexTimestamps = new List<long>();
+		private readonly List<long> _indexOffsets = new List<long>();
+		private readonly object _gate = new object();
+
+		private byte[] _front;
+		private byte[] _back;
+		private int _frontLength;
+		private bool _stopping;
+		private long _written;
+		private long _dropped;
+
+		private static readonly Logger Logger = LogManager.GetCurrentClassLogger();
+
+		/// <param name="path">File to write to. Overwritten if it exists.</param>
+		/// <param name="gameName">Name of the game, stored in the header</param>
+		/// <param name="compress">If true, compress frames</param>
+		/// <param name="bufferSize">Size of each of the two buffers in bytes</param>
+		public DumpWriter(string path, string gameName, bool compress, int bufferSize = 4 * 1024 * 1024)
+		{
+			_compress = compress;
+			_front = new byte[bufferSize];
+			_back = new byte[bufferSize];
+			_stream = new FileStream(path, FileMode.Create, FileAccess.Write, FileShare.Read, 65536);
+			_writer = new BinaryWriter(_stream);
+
+			var name = Encoding.UTF8.GetBytes(gameName ?? string.Empty);
+			_writer.Write(DumpFormat.Magic);
+			_writer.Write(DumpFormat.Version);
+			_writer.Write((ushort)name.Length);
+			_writer.Write(name);
+
+			_thread = new Thread(Run) {
+				Name = "DumpWriter",
+				IsBackground = true
+			};
+			_thread.Start();
+		}
+
+		/// <summary>
+		/// Queues a frame for writing. Doesn't block.
+		/// </summary>
+		/// <param name="frame">Frame to write</param>
+		public void Write(DmdFrame frame)
+		{
+			var length = frame.Data.Length;
+			lock (_gate) {
+				if (_stopping) {
+					return;
+				}
+				if (_frontLength + DumpFormat.FrameHeaderSize + length > _front.Length) {
+					_dropped++;
+					return;
+				}
+				var pos = _frontLength;
+				WriteInt64(_front, pos, _clock.ElapsedMilliseconds);
+				WriteUInt16(_front, pos + 8, (ushort)frame.Dimensions.Width);
+				WriteUInt16(_front, pos + 10, (ushort)frame.Dimensions.Height);
+				_front[pos + 12] = (byte)frame.BitLength;
+				_front[pos + 13] = DumpFormat.CompressionNone;
+				WriteInt32(_front, pos + 14, length);
+				Buffer.BlockCopy(frame.Data, 0, _front, pos + DumpFormat.FrameHeaderSize, length);
+				_frontLength = pos + DumpFormat.FrameHeaderSize + length;
+				Monitor.Pulse(_gate);
+			}
+		}
+
+		private void Run()
+		{
+			while (true) {
+				int length;
+				bool stopping;
+				lock (_gate) {
+					while (_frontLength == 0 && !_stopping) {
+						Monitor.Wait(_gate);
+					}
+					var buffer = _back;
+					_back = _front;
+					_front = buffer;
+					length = _frontLength;
+					_frontLength = 0;
+					stopping = _stopping;
+				}
+
+				try {
+					WriteFrames(_back, length);
+
+				} catch (Exception e) {
+					Logger.Error(e, "[dump] Error writing frames.");
+				}
+
+				if (stopping) {
+					return;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Writes the frames of a buffer to disk, compressing them if enabled.
+		/// </summary>
+		private void WriteFrames(byte[] buffer, int length)
+		{
+			var pos = 0;
+			while (pos < length) {
+				var dataLength = BitConverter.ToInt32(buffer, pos + 14);
+				var dataPos = pos + DumpFormat.FrameHeaderSize;
+				var compressed = _compress ? DumpFormat.Compress(buffer, dataPos, dataLength) : null;
+
+				_indexTimestamps.Add(BitConverter.ToInt64(buffer, pos));
+				_indexOffsets.Add(_stream.Position);
+
+				if (compressed != null) {
+					buffer[pos + 13] = DumpFormat.CompressionDeflate;
+					WriteInt32(buffer, pos + 14, compressed.Length);
+					_writer.Write(buffer, pos, DumpFormat.FrameHeaderSize);
+					_writer.Write(compressed);
+
+				} else {
+					_writer.Write(buffer, pos, DumpFormat.FrameHeaderSize + dataLength);
+				}
+
+				pos = dataPos + dataLength;
+				Interlocked.Increment(ref _written);
+			}
+			_writer.Flush();
+		}
+
+		/// <summary>
+		/// Writes the remaining frames and the index, and closes the file.
+		/// </summary>
+		public void Dispose()
+		{
+			lock (_gate) {
+				if (_stopping) {
+					return;
+				}
+				_stopping = true;
+				Monitor.Pulse(_gate);
+			}
+			_thread.Join();
+
+			var indexOffset = _stream.Position;
+			for (var i = 0; i < _indexOffsets.Count; i++) {
+				_writer.Write(_indexTimestamps[i]);
+				_writer.Write(_indexOffsets[i]);
+			}
+			_writer.Write(indexOffset);
+			_writer.Write(_indexOffsets.Count);
+			_writer.Write(DumpFormat.IndexMagic);
+			_writer.Dispose();
+
+			Logger.Info("[dump] Wrote {0} frames, {1} dropped.", Written, Dropped);
+		}
+
+		private static void WriteInt64(byte[] buffer, int pos, long value)
+		{
+			WriteInt32(buffer, pos, (int)value);
+			WriteInt32(buffer, pos + 4, (int)(value >> 32));
+		}
+
+		private static void WriteInt32(byte[] buffer, int pos, int value)
+		{
+			buffer[pos] = (byte)value;
+			buffer[pos + 1] = (byte)(value >> 8);
+			buffer[pos + 2] = (byte)(value >> 16);
+			buffer[pos + 3] = (byte)(value >> 24);
+		}
+
+		private static void WriteUInt16(byte[] buffer, int pos, ushort value)
+		{
+			buffer[pos] = (byte)value;
+			buffer[pos + 1] = (byte)(value >> 8);
+		}
+	}
+}
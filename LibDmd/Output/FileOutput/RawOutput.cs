@@ -17,15 +17,22 @@ namespace LibDmd.Output.FileOutput
 
 		private static readonly Logger Logger = LogManager.GetCurrentClassLogger();
 		private TextWriter _writer;
+		private DumpWriter _dumpWriter;
+		private readonly RawOutputFormat _format;
+		private readonly bool _compress;
 		private readonly object _writeLock = new object();
 
-		public RawOutput()
+		public RawOutput(RawOutputFormat format = RawOutputFormat.Text, bool compress = true)
 		{
+			_format = format;
+			_compress = compress;
 			Logger.Info($"[rawoutput] Waiting for game name...");
 		}
 
-		public RawOutput(string gameName)
+		public RawOutput(string gameName, RawOutputFormat format = RawOutputFormat.Text, bool compress = true)
 		{
+			_format = format;
+			_compress = compress;
 			SetGameName(gameName);
 		}
 
@@ -39,10 +46,22 @@ namespace LibDmd.Output.FileOutput
 					Directory.CreateDirectory(folder);
 				}
 			}
-			var path = Path.Combine(folder, $"{_gameName}.txt");
+			string path;
 			lock (_writeLock) {
 				_writer?.Dispose();
-				_writer = new StreamWriter(File.Open(path, FileMode.Append));
+				_writer = null;
+				_dumpWriter?.Dispose();
+				_dumpWriter = null;
+
+				if (_format == RawOutputFormat.Binary) {
+					// the index is at the end, so every session gets its own file.
+					path = Path.Combine(folder, $"{_gameName}-{DateTime.Now:yyyyMMdd-HHmmss}.dmdrec");
+					_dumpWriter = new DumpWriter(path, _gameName, _compress);
+
+				} else {
+					path = Path.Combine(folder, $"{_gameName}.txt");
+					_writer = new StreamWriter(File.Open(path, FileMode.Append));
+				}
 			}
 
 			Logger.Info($"[rawoutput] Dumping frames to {path}.");
@@ -54,6 +73,13 @@ namespace LibDmd.Output.FileOutput
 
 		private void WriteFrame(DmdFrame frame)
 		{
+			if (_format == RawOutputFormat.Binary) {
+				lock (_writeLock) {
+					_dumpWriter?.Write(frame);
+				}
+				return;
+			}
+
 			// Build outside lock so we don't block other work while formatting.
 			var sb = new System.Text.StringBuilder(frame.Dimensions.Width * frame.Dimensions.Height + 64);
 			sb.Append("0x").AppendLine(Environment.TickCount.ToString("X8"));
@@ -83,7 +109,21 @@ namespace LibDmd.Output.FileOutput
 		{
 			lock (_writeLock) {
 				_writer?.Dispose();
+				_dumpWriter?.Dispose();
 			}
 		}
 	}
+
+	public enum RawOutputFormat
+	{
+		/// <summary>
+		/// One hex digit per pixel, readable by humans. Appends to one file per game.
+		/// </summary>
+		Text,
+
+		/// <summary>
+		/// Indexed binary format with timestamps and optional compression, see <see cref="DumpFormat"/>.
+		/// </summary>
+		Binary
+	}
 }
\ No newline at end of file
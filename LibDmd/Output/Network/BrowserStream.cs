@@ -1,10 +1,12 @@
-﻿using System.Collections.Generic;
+﻿using System;
+using System.Collections.Generic;
 using System.IO;
 using System.Linq;
 using System.Reflection;
 using System.Text;
 using System.Windows.Media;
 using System.Windows.Media.Imaging;
+using LibDmd.Common;
 using LibDmd.Frame;
 using MimeTypes;
 using NLog;
@@ -25,8 +27,15 @@ namespace LibDmd.Output.Network
 		private readonly Assembly _assembly = Assembly.GetExecutingAssembly();
 		private readonly Dictionary<string, string> _www = new Dictionary<string, string>(); 
 		private readonly HttpServer _server;
-		private readonly List<DmdSocket>  _sockets = new List<DmdSocket>();
 		private readonly string _gameName;
+		private readonly MessagePool _pool = new MessagePool();
+		private readonly WebsocketSerializer _serializer;
+		private readonly WebsocketSerializer _initSerializer = new WebsocketSerializer();
+
+		// copied on write, so rendering doesn't need to lock.
+		private volatile DmdSocket[] _clients = new DmdSocket[0];
+		private readonly object _clientsLock = new object();
+		private byte[][] _planes = new byte[0][];
 
 		private Dimensions _dimensions;
 		private Color _color = RenderGraph.DefaultColor;
@@ -45,6 +54,7 @@ namespace LibDmd.Output.Network
 			_www["/"] = prefix + "index.html";
 
 			_gameName = romName;
+			_serializer = new WebsocketSerializer { Pool = _pool };
 
 			_server = new HttpServer(port);
 			_server.OnGet += (sender, e) => {
@@ -68,45 +78,44 @@ namespace LibDmd.Output.Network
 					res.StatusCode = (int)HttpStatusCode.NotFound;
 				}
 			};
-			_server.AddWebSocketService("/dmd", () => {
-				var socket = new DmdSocket(this);
-				_sockets.Add(socket);
-				return socket;
-			});
+			_server.AddWebSocketService("/dmd", () => new DmdSocket(this));
 			_server.Start();
 			if (_server.IsListening) {
 				Logger.Info("Listening on port {0}, and providing WebSocket services: [ {1} ]", _server.Port, string.Join(", ", _server.WebSocketServices.Paths));
 			}
 		}
-				
+
 		public void Init(DmdSocket socket)
 		{
 			Logger.Debug("Init socket");
 			if (_gameName != null)
 			{
-				socket.SendGameName(_gameName);
+				socket.Enqueue(new SocketMessage(_initSerializer.SerializeGameName(_gameName), false, 1));
 			}
-			socket.SendDimensions(_dimensions);
-			socket.SendColor(_color);
+			socket.Enqueue(new SocketMessage(_initSerializer.SerializeDimensions(_dimensions), false, 1));
+			socket.Enqueue(new SocketMessage(_initSerializer.SerializeColor(_color), false, 1));
 			if (_palette != null) {
-				socket.SendPalette(_palette);
+				socket.Enqueue(new SocketMessage(_initSerializer.SerializePalette(_palette), false, 1));
 			}
 		}
 
-		public void RenderGray2(DmdFrame frame)
-		{
-			if (frame.Dimensions != _dimensions) {
-				SetDimensions(frame.Dimensions);
-			}
-			_sockets.ForEach(s => s.SendGray(frame.Data, 2));
-		}
+		public void RenderGray2(DmdFrame frame) => RenderGray(frame, 2);
+
+		public void RenderGray4(DmdFrame frame) => RenderGray(frame, 4);
 
-		public void RenderGray4(DmdFrame frame)
+		private void RenderGray(DmdFrame frame, int bitLength)
 		{
 			if (frame.Dimensions != _dimensions) {
 				SetDimensions(frame.Dimensions);
 			}
-			_sockets.ForEach(s => s.SendGray(frame.Data, 4));
+			if (_clients.Length == 0) {
+				return;
+			}
+			if (frame.Data.Length < _serializer.Dimensions.Surface) {
+				Logger.Info("SendGray: invalid frame received frame.length={0} bitlength={1} dim={2}", frame.Data.Length, bitLength, _serializer.Dimensions);
+				return;
+			}
+			Broadcast(_serializer.SerializeGray(frame.Data, bitLength), true);
 		}
 
 		public void RenderColoredGray2(ColoredFrame frame)
@@ -114,7 +123,9 @@ namespace LibDmd.Output.Network
 			if (frame.Dimensions != _dimensions) {
 				SetDimensions(frame.Dimensions);
 			}
-			_sockets.ForEach(s => s.SendColoredGray2(frame.BitPlanes, frame.Palette));
+			if (_clients.Length > 0) {
+				Broadcast(_serializer.SerializeColoredGray2(SplitPlanes(frame), frame.Palette), true);
+			}
 		}
 
 		public void RenderColoredGray4(ColoredFrame frame)
@@ -122,7 +133,9 @@ namespace LibDmd.Output.Network
 			if (frame.Dimensions != _dimensions) {
 				SetDimensions(frame.Dimensions);
 			}
-			_sockets.ForEach(s => s.SendColoredGray4(frame.BitPlanes, frame.Palette));
+			if (_clients.Length > 0) {
+				Broadcast(_serializer.SerializeColoredGray4(SplitPlanes(frame), frame.Palette), true);
+			}
 		}
 
 		public void RenderColoredGray6(ColoredFrame frame)
@@ -130,7 +143,9 @@ namespace LibDmd.Output.Network
 			if (frame.Dimensions != _dimensions) {
 				SetDimensions(frame.Dimensions);
 			}
-			_sockets.ForEach(s => s.SendColoredGray6(frame.BitPlanes, frame.Palette));
+			if (_clients.Length > 0) {
+				Broadcast(_serializer.SerializeColoredGray6(SplitPlanes(frame), frame.Palette), true);
+			}
 		}
 
 		public void RenderRgb24(DmdFrame frame)
@@ -138,40 +153,81 @@ namespace LibDmd.Output.Network
 			if (frame.Dimensions != _dimensions) {
 				SetDimensions(frame.Dimensions);
 			}
-			_sockets.ForEach(s => s.SendRgb24(frame.Data));
+			if (_clients.Length > 0) {
+				Broadcast(_serializer.SerializeRgb24(frame.Data), true);
+			}
 		}
 
 		public void SetDimensions(Dimensions dim)
 		{
 			_dimensions = dim;
-			_sockets.ForEach(s => s.SendDimensions(dim));
+			Broadcast(_serializer.SerializeDimensions(dim), false);
 		}
 
 		public void SetColor(Color color)
 		{
 			_color = color;
-			_sockets.ForEach(s => s.SendColor(color));
+			Broadcast(_serializer.SerializeColor(color), false);
 		}
 
 		public void SetPalette(Color[] colors)
 		{
 			_palette = colors;
-			_sockets.ForEach(s => s.SendPalette(colors));
+			Broadcast(_serializer.SerializePalette(colors), false);
 		}
 
 		public void ClearPalette()
 		{
-			_sockets.ForEach(s => s.SendClearPalette());
+			Broadcast(_serializer.SerializeClearPalette(), false);
 		}
 
 		public void ClearColor()
 		{
-			_sockets.ForEach(s => s.SendClearColor());
+			Broadcast(_serializer.SerializeClearColor(), false);
+		}
+
+		/// <summary>
+		/// Hands a serialized message to every connected socket.
+		/// </summary>
+		/// <param name="data">Serialized message, from the pool</param>
+		/// <param name="isFrame">If true, sockets that are behind can skip it</param>
+		private void Broadcast(byte[] data, bool isFrame)
+		{
+			var clients = _clients;
+			if (clients.Length == 0) {
+				_pool.Return(data);
+				return;
+			}
+			var message = new SocketMessage(data, isFrame, clients.Length, _pool);
+			foreach (var client in clients) {
+				client.Enqueue(message);
+			}
+		}
+
+		/// <summary>
+		/// Splits a frame into bit planes, re-using the planes of the previous frame.
+		/// </summary>
+		private byte[][] SplitPlanes(DmdFrame frame)
+		{
+			if (_planes.Length != frame.BitLength || _planes[0]?.Length != frame.BitPlaneLength) {
+				_planes = new byte[frame.BitLength][];
+			}
+			return FrameUtil.Split(frame.Dimensions, frame.BitLength, frame.Data, _planes);
+		}
+
+		internal void Opened(DmdSocket socket)
+		{
+			lock (_clientsLock) {
+				_clients = _clients.Concat(new[] { socket }).ToArray();
+			}
 		}
 
 		public void Closed(DmdSocket socket)
 		{
-			_sockets.Remove(socket);
+			lock (_clientsLock) {
+				_clients = _clients.Where(s => s != socket).ToArray();
+			}
+			socket.Close();
 			Logger.Debug("Socket closed");
 		}
 
@@ -203,66 +259,101 @@ namespace LibDmd.Output.Network
 
 	}
 
+	/// <summary>
+	/// A connected browser.
+	/// </summary>
+	///
+	/// <remarks>
+	/// Every socket has its own send queue and sends one message at a time. If
+	/// a newer frame arrives while the previous one is still waiting, the older
+	/// one is skipped, so a slow client drops frames instead of holding up the
+	/// others. Other messages, like palette changes, are never skipped.
+	/// </remarks>
 	public class DmdSocket : WebSocketBehavior
 	{
 		private readonly BrowserStream _dest;
-		private readonly WebsocketSerializer _serializer;
+		private readonly List<SocketMessage> _queue = new List<SocketMessage>();
+		private bool _sending;
+		private bool _closed;
+		private long _sent;
+		private long _skipped;
 
 		private static readonly NLog.Logger Logger = LogManager.GetCurrentClassLogger();
 
 		public DmdSocket(BrowserStream dest)
 		{
 			_dest = dest;
-			_serializer = new WebsocketSerializer();
 		}
 
-		public void SendGray(byte[] frame, int bitlength)
+		/// <summary>
+		/// Queues a message for sending, and starts sending if idle.
+		/// </summary>
+		internal void Enqueue(SocketMessage message)
 		{
-			if (frame.Length < _serializer.Dimensions.Surface) {
-				Logger.Info("SendGray: invalid frame received frame.length={0} bitlength={1} dim={2}", frame.Length, bitlength, _serializer.Dimensions);
-				return;
+			lock (_queue) {
+				if (_closed) {
+					message.Release();
+					return;
+				}
+				var last = _queue.Count - 1;
+				if (message.IsFrame && last >= 0 && _queue[last].IsFrame) {
+					_queue[last].Release();
+					_queue[last] = message;
+					_skipped++;
+				} else {
+					_queue.Add(message);
+				}
+				if (_sending) {
+					return;
+				}
+				_sending = true;
 			}
-			Send(_serializer.SerializeGray(frame, bitlength));
+			SendNext();
 		}
 
-		public void SendColoredGray2(byte[][] planes, Color[] palette)
+		private void SendNext()
 		{
-			if (planes.Length == 0) {
-				return;
+			SocketMessage message;
+			lock (_queue) {
+				if (_queue.Count == 0 || _closed) {
+					_sending = false;
+					return;
+				}
+				message = _queue[0];
+				_queue.RemoveAt(0);
 			}
-			Send(_serializer.SerializeColoredGray2(planes, palette));
-		}
-
-		public void SendColoredGray4(byte[][] planes, Color[] palette)
-		{
-			if (planes.Length == 0) {
-				return;
+			try {
+				SendAsync(message.Data, completed => {
+					message.Release();
+					_sent++;
+					SendNext();
+				});
+
+			} catch (Exception e) {
+				Logger.Warn("Error sending to browser: {0}", e.Message);
+				message.Release();
+				lock (_queue) {
+					_sending = false;
+				}
 			}
-			Send(_serializer.SerializeColoredGray4(planes, palette));
 		}
 
-		public void SendColoredGray6(byte[][] planes, Color[] palette)
+		/// <summary>
+		/// Drops all waiting messages.
+		/// </summary>
+		internal void Close()
 		{
-			if (planes.Length == 0) {
-				return;
+			lock (_queue) {
+				if (_closed) {
+					return;
+				}
+				_closed = true;
+				_queue.ForEach(m => m.Release());
+				_queue.Clear();
 			}
-			Send(_serializer.SerializeColoredGray6(planes, palette));
+			Logger.Info("Browser disconnected after {0} messages, {1} frame(s) skipped because it was too slow.", _sent, _skipped);
 		}
 
-		public void SendRgb24(byte[] frame) => Send(_serializer.SerializeRgb24(frame));
-
-		public void SendGameName(string gameName) => Send(_serializer.SerializeGameName(gameName));
-
-		public void SendDimensions(Dimensions dim) => Send(_serializer.SerializeDimensions(dim));
-
-		public void SendColor(Color color) => Send(_serializer.SerializeColor(color));
-
-		public void SendPalette(Color[] colors) => Send(_serializer.SerializePalette(colors));
-
-		public void SendClearColor() => Send(_serializer.SerializeClearColor());
-
-		public void SendClearPalette() => Send(_serializer.SerializeClearPalette());
-
 		protected override void OnMessage(MessageEventArgs e)
 		{
 			if (e.Data == "init") {
@@ -280,6 +371,7 @@ namespace LibDmd.Output.Network
 		protected override void OnOpen()
 		{
 			Logger.Info("Websocket opened.");
+			_dest.Opened(this);
 		}
 
 		protected override void OnClose(CloseEventArgs e)
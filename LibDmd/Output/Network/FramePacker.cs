@@ -0,0 +1,109 @@
+﻿using System;
+using System.IO;
+
+namespace LibDmd.Output.Network
+{
+	/// <summary>
+	/// Packs frame data for sending it over the network.
+	/// </summary>
+	///
+	/// <remarks>
+	/// The data is XOR'ed with a reference frame, if given, so unchanged bytes
+	/// become zero, and then run-length encoded:
+	///
+	///   0x00 - 0x7f:  the next (n + 1) bytes are taken as-is
+	///   0x80 - 0xff:  (n - 0x7f) zeros
+	///
+	/// Consecutive frames usually differ by only a few pixels, so a delta ends
+	/// up as a few bytes. In the worst case, the packed data is 1/128 larger.
+	/// </remarks>
+	internal static class FramePacker
+	{
+		private const int MaxRun = 128;
+
+		/// <summary>
+		/// Packs data.
+		/// </summary>
+		/// <param name="data">Data to pack</param>
+		/// <param name="reference">If set, only the difference to this is packed. Must be of the same length.</param>
+		/// <returns>Packed data</returns>
+		public static byte[] Pack(byte[] data, byte[] reference)
+		{
+			var n = data.Length;
+			var dest = new byte[n + n / MaxRun + 1];
+			var pos = 0;
+			var i = 0;
+			while (i < n) {
+
+				// zeros
+				var zeros = 0;
+				while (i + zeros < n && zeros < MaxRun && Get(data, reference, i + zeros) == 0) {
+					zeros++;
+				}
+				if (zeros > 1 || zeros == 1 && i + 1 == n) {
+					dest[pos++] = (byte)(0x80 | (zeros - 1));
+					i += zeros;
+					continue;
+				}
+
+				// literals, until there are at least two zeros in a row.
+				var start = pos++;
+				var count = 0;
+				while (i < n && count < MaxRun) {
+					var value = Get(data, reference, i);
+					if (value == 0 && i + 1 < n && Get(data, reference, i + 1) == 0) {
+						break;
+					}
+					dest[pos++] = value;
+					count++;
+					i++;
+				}
+				dest[start] = (byte)(count - 1);
+			}
+			Array.Resize(ref dest, pos);
+			return dest;
+		}
+
+		/// <summary>
+		/// Unpacks data.
+		/// </summary>
+		/// <param name="packed">Buffer containing the packed data</param>
+		/// <param name="offset">Where the packed data starts</param>
+		/// <param name="length">Length of the packed data</param>
+		/// <param name="reference">If set, the packed data is a difference to this.</param>
+		/// <param name="dest">Buffer of the unpacked size, zeroed if there is no reference</param>
+		public static void Unpack(byte[] packed, int offset, int length, byte[] reference, byte[] dest)
+		{
+			var end = offset + length;
+			var i = 0;
+			while (offset < end) {
+				var control = packed[offset++];
+				var count = (control & 0x7f) + 1;
+				if (i + count > dest.Length) {
+					throw new InvalidDataException("Packed frame is larger than its size.");
+				}
+				if (control >= 0x80) {
+					if (reference != null) {
+						Buffer.BlockCopy(reference, i, dest, i, count);
+					}
+					i += count;
+					continue;
+				}
+				if (offset + count > end) {
+					throw new InvalidDataException("Packed frame is cut off.");
+				}
+				for (var j = 0; j < count; j++, i++) {
+					dest[i] = reference != null ? (byte)(packed[offset++] ^ reference[i]) : packed[offset++];
+				}
+			}
+			if (i != dest.Length) {
+				throw new InvalidDataException("Packed frame is smaller than its size.");
+			}
+		}
+
+		private static byte Get(byte[] data, byte[] reference, int i)
+		{
+			return reference != null ? (byte)(data[i] ^ reference[i]) : data[i];
+		}
+	}
+}
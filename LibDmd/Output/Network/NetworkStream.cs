@@ -70,6 +70,10 @@ namespace LibDmd.Output.Network
 			IsAvailable = true;
 			Logger.Info("Connected to WebSocket at {0}", _uri.ToString());
 
+			// start with the original messages until the server answers.
+			_serializer.Reset();
+			_client.Send(_serializer.SerializeHello(WebsocketSerializer.Version));
+
 			if (_gameName != null) {
 				_client.Send(_serializer.SerializeGameName(_gameName));
 			}
@@ -82,6 +86,11 @@ namespace LibDmd.Output.Network
 
 		private void OnMessage(object sender, MessageEventArgs e)
 		{
+			if (e.IsBinary && WebsocketSerializer.TryReadHello(e.RawData, out var version)) {
+				_serializer.ProtocolVersion = version;
+				Logger.Info("Server speaks protocol version {0}, sending {1}.", version, _serializer.ProtocolVersion > 0 ? "compressed frame deltas" : "full frames");
+				return;
+			}
 			Logger.Info("Message from server: " + e.Data);
 		}
 
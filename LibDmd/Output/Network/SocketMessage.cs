@@ -0,0 +1,97 @@
+﻿using System.Collections.Generic;
+using System.Threading;
+
+namespace LibDmd.Output.Network
+{
+	/// <summary>
+	/// A serialized message that is sent to several sockets.
+	/// </summary>
+	///
+	/// <remarks>
+	/// The data isn't changed after serialization, so all sockets send the same
+	/// buffer. Every socket releases the message when it's sent or skipped, and
+	/// when the last one did, the buffer goes back to the pool.
+	/// </remarks>
+	internal class SocketMessage
+	{
+		/// <summary>
+		/// The serialized message.
+		/// </summary>
+		public byte[] Data { get; }
+
+		/// <summary>
+		/// If true, this is a frame, which can be skipped if a newer frame is waiting.
+		/// </summary>
+		public bool IsFrame { get; }
+
+		private readonly MessagePool _pool;
+		private int _references;
+
+		/// <param name="data">Serialized message</param>
+		/// <param name="isFrame">If true, the message can be skipped for a newer frame</param>
+		/// <param name="references">Number of sockets the message is sent to</param>
+		/// <param name="pool">Where to return the buffer to, or null if it's not pooled</param>
+		public SocketMessage(byte[] data, bool isFrame, int references, MessagePool pool = null)
+		{
+			Data = data;
+			IsFrame = isFrame;
+			_references = references;
+			_pool = pool;
+		}
+
+		/// <summary>
+		/// Marks the message as sent or skipped by one socket.
+		/// </summary>
+		public void Release()
+		{
+			if (Interlocked.Decrement(ref _references) == 0) {
+				_pool?.Return(Data);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Recycles message buffers.
+	/// </summary>
+	///
+	/// <remarks>
+	/// WebSocket messages are sent from arrays of the exact message size, so
+	/// buffers are kept per size. Since all frames of a format have the same
+	/// size, only a few different sizes are in use at a time.
+	/// </remarks>
+	internal class MessagePool
+	{
+		private const int MaxBuffersPerSize = 8;
+
+		private readonly Dictionary<int, Stack<byte[]>> _buffers = new Dictionary<int, Stack<byte[]>>();
+
+		/// <summary>
+		/// Returns a buffer of the given size.
+		/// </summary>
+		public byte[] Rent(int length)
+		{
+			lock (_buffers) {
+				if (_buffers.TryGetValue(length, out var buffers) && buffers.Count > 0) {
+					return buffers.Pop();
+				}
+			}
+			return new byte[length];
+		}
+
+		/// <summary>
+		/// Puts a buffer back into the pool.
+		/// </summary>
+		public void Return(byte[] buffer)
+		{
+			lock (_buffers) {
+				if (!_buffers.TryGetValue(buffer.Length, out var buffers)) {
+					buffers = new Stack<byte[]>();
+					_buffers.Add(buffer.Length, buffers);
+				}
+				if (buffers.Count < MaxBuffersPerSize) {
+					buffers.Push(buffer);
+				}
+			}
+		}
+	}
+}
@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Collections.Generic;
 using System.IO;
 using System.Linq;
 using System.Text;
@@ -27,14 +28,127 @@ namespace LibDmd.Output.Network
 		void OnGray2(uint timestamp, byte[] frame);
 	}
 
+	/// <summary>
+	/// Converts frames and commands to binary WebSocket messages and back.
+	/// </summary>
+	///
+	/// <remarks>
+	/// Every message starts with a zero-terminated name. The client sends a
+	/// "hello" message with the highest protocol version it supports, and if
+	/// the other end answers with a version of at least 1, frames are sent as
+	/// "frame" messages instead of the original ones:
+	///
+	///   format (byte), flags (byte), timestamp (uint),
+	///   for colored frames: palette ID (byte), and if flagged, the palette as
+	///     number of colors (int) and colors (int each),
+	///   unpacked length (int), data packed by <see cref="FramePacker"/>
+	///
+	/// Unless flagged as key frame, the data is the difference to the previous
+	/// frame of the same format. Since WebSockets run over TCP, the previous
+	/// frame is guaranteed to have arrived. Palettes are only sent when they
+	/// weren't sent before, and are referenced by their ID otherwise.
+	///
+	/// Ends that don't answer the "hello" message, like older versions or other
+	/// devices, keep receiving the original messages.
+	/// </remarks>
 	internal class WebsocketSerializer
 	{
+		/// <summary>
+		/// The highest protocol version supported.
+		/// </summary>
+		public const int Version = 1;
+
 		public Dimensions Dimensions = Dimensions.Standard;
 
+		/// <summary>
+		/// If set, messages are written into buffers from this pool.
+		/// </summary>
+		public MessagePool Pool { get; set; }
+
+		/// <summary>
+		/// The protocol version agreed on with the other end. 0 means original messages only.
+		/// </summary>
+		public int ProtocolVersion {
+			get => _protocolVersion;
+			set => _protocolVersion = Math.Min(value, Version);
+		}
+
+		private const byte FlagKeyFrame = 0x1;
+		private const byte FlagPalette = 0x2;
+		private const int MaxPalettes = 16;
+
 		private readonly long _startedAt = DateTime.Now.Ticks / TimeSpan.TicksPerMillisecond;
+		private readonly byte[][][] _planes = new byte[7][][];
+		private volatile int _protocolVersion;
+
+		// sending side
+		private readonly object _sendLock = new object();
+		private readonly Dictionary<FrameCode, byte[]> _sentFrames = new Dictionary<FrameCode, byte[]>();
+		private readonly List<Color[]> _sentPalettes = new List<Color[]>();
+		private int _lastPaletteId;
+		private int _nextPaletteId;
+
+		// receiving side
+		private readonly Dictionary<FrameCode, byte[]> _receivedFrames = new Dictionary<FrameCode, byte[]>();
+		private readonly Color[][] _receivedPalettes = new Color[MaxPalettes][];
 
 		private static readonly Logger Logger = LogManager.GetCurrentClassLogger();
 
+		/// <summary>
+		/// Frame formats of the "frame" message.
+		/// </summary>
+		private enum FrameCode : byte
+		{
+			Gray2 = 1,
+			Gray4 = 2,
+			ColoredGray2 = 3,
+			ColoredGray4 = 4,
+			ColoredGray6 = 5,
+			Rgb24 = 6,
+		}
+
+		/// <summary>
+		/// Forgets previously sent frames and palettes, and falls back to the
+		/// original messages. Call this when (re-)connecting.
+		/// </summary>
+		public void Reset()
+		{
+			lock (_sendLock) {
+				ProtocolVersion = 0;
+				_sentFrames.Clear();
+				_sentPalettes.Clear();
+				_lastPaletteId = 0;
+				_nextPaletteId = 0;
+			}
+		}
+
+		/// <summary>
+		/// Checks whether a message is a "hello" message, and reads its protocol version.
+		/// </summary>
+		public static bool TryReadHello(byte[] data, out int version)
+		{
+			var name = Encoding.ASCII.GetBytes("hello\0");
+			version = 0;
+			if (data.Length < name.Length + 4) {
+				return false;
+			}
+			for (var i = 0; i < name.Length; i++) {
+				if (data[i] != name[i]) {
+					return false;
+				}
+			}
+			version = BitConverter.ToInt32(data, name.Length);
+			return true;
+		}
+
+		public byte[] SerializeHello(int version)
+		{
+			var data = new byte["hello".Length + 1 + 4];
+			var pos = WriteName(data, "hello");
+			WriteInt(data, pos, version);
+			return data;
+		}
+
 		public void Unserialize(byte[] data, ISocketAction action) {
 			var start = 0;
 			using (var memoryStream = new MemoryStream(data))
@@ -71,13 +185,12 @@ namespace LibDmd.Output.Network
 						break;
 					}
 					case "gameName": {
-						char c;
-						var gameName = "";
-						do {
-							c = reader.ReadChar();
-							gameName += c;
-						} while (c != 0x0) ;
-						action.OnGameName(gameName);
+						// zero-terminated, or until the end of the message.
+						var end = start;
+						while (end < data.Length && data[end] != 0x0) {
+							end++;
+						}
+						action.OnGameName(Encoding.ASCII.GetString(data, start, end - start));
 						break;
 					}
 					case "rgb24": {
@@ -151,126 +264,350 @@ namespace LibDmd.Output.Network
 						action.OnGray2(timestamp, FrameUtil.Join(Dimensions, planes));
 						break;
 					}
+					case "frame": {
+						UnserializeFrame(data, reader, action);
+						break;
+					}
+				}
+			}
+		}
+
+		private void UnserializeFrame(byte[] data, BinaryReader reader, ISocketAction action)
+		{
+			var code = (FrameCode)reader.ReadByte();
+			var flags = reader.ReadByte();
+			var timestamp = reader.ReadUInt32();
+
+			Color[] palette = null;
+			if (code >= FrameCode.ColoredGray2 && code <= FrameCode.ColoredGray6) {
+				var paletteId = reader.ReadByte() % MaxPalettes;
+				if ((flags & FlagPalette) != 0) {
+					var numColors = reader.ReadInt32();
+					var colors = new Color[numColors];
+					for (var i = 0; i < numColors; i++) {
+						colors[i] = ColorUtil.FromInt(reader.ReadInt32());
+					}
+					_receivedPalettes[paletteId] = colors;
+				}
+				palette = _receivedPalettes[paletteId];
+				if (palette == null) {
+					Logger.Warn("Dropping {0} frame with unknown palette {1}.", code, paletteId);
+					return;
+				}
+			}
+
+			var length = reader.ReadInt32();
+			var keyFrame = (flags & FlagKeyFrame) != 0;
+			_receivedFrames.TryGetValue(code, out var reference);
+			if (!keyFrame && reference?.Length != length) {
+				Logger.Warn("Dropping {0} delta frame without previous frame.", code);
+				return;
+			}
+			var frame = new byte[length];
+			var pos = (int)reader.BaseStream.Position;
+			FramePacker.Unpack(data, pos, data.Length - pos, keyFrame ? null : reference, frame);
+			_receivedFrames[code] = frame;
+
+			switch (code) {
+				case FrameCode.Gray2:
+					action.OnGray2(timestamp, FrameUtil.Join(Dimensions, SplitPlanes(frame, 2)));
+					break;
+				case FrameCode.Gray4:
+					action.OnGray4(timestamp, FrameUtil.Join(Dimensions, SplitPlanes(frame, 4)));
+					break;
+				case FrameCode.ColoredGray2:
+					action.OnColoredGray2(timestamp, palette, FrameUtil.Join(Dimensions, SplitPlanes(frame, 2)));
+					break;
+				case FrameCode.ColoredGray4:
+					action.OnColoredGray4(timestamp, palette, FrameUtil.Join(Dimensions, SplitPlanes(frame, 4)));
+					break;
+				case FrameCode.ColoredGray6:
+					action.OnColoredGray6(timestamp, palette, FrameUtil.Join(Dimensions, SplitPlanes(frame, 6)));
+					break;
+				case FrameCode.Rgb24:
+					// the received frame is the reference for the next one, so hand out a copy.
+					action.OnRgb24(timestamp, (byte[])frame.Clone());
+					break;
+				default:
+					Logger.Warn("Dropping frame of unknown format {0}.", code);
+					break;
+			}
+		}
+
+		private static byte[][] SplitPlanes(byte[] data, int numPlanes)
+		{
+			var planeSize = data.Length / numPlanes;
+			var planes = new byte[numPlanes][];
+			for (var i = 0; i < numPlanes; i++) {
+				planes[i] = new byte[planeSize];
+				Buffer.BlockCopy(data, i * planeSize, planes[i], 0, planeSize);
+			}
+			return planes;
+		}
+
+		/// <summary>
+		/// Serializes a frame into a "frame" message.
+		/// </summary>
+		/// <param name="code">Frame format</param>
+		/// <param name="planes">Frame data, concatenated</param>
+		/// <param name="palette">Palette for colored frames, null otherwise</param>
+		private byte[] SerializeFrame(FrameCode code, byte[][] planes, Color[] palette)
+		{
+			var timestamp = Timestamp();
+			lock (_sendLock) {
+				var length = Length(planes);
+				var frame = new byte[length];
+				WritePlanes(frame, 0, planes);
+
+				// send a delta, unless there's nothing to diff against, or a key frame is smaller.
+				var flags = (byte)0;
+				_sentFrames.TryGetValue(code, out var reference);
+				byte[] packed;
+				if (reference?.Length == length) {
+					packed = FramePacker.Pack(frame, reference);
+					if (packed.Length > length / 2) {
+						var keyFrame = FramePacker.Pack(frame, null);
+						if (keyFrame.Length < packed.Length) {
+							packed = keyFrame;
+							flags |= FlagKeyFrame;
+						}
+					}
+				} else {
+					packed = FramePacker.Pack(frame, null);
+					flags |= FlagKeyFrame;
+				}
+				_sentFrames[code] = frame;
+
+				var paletteId = 0;
+				if (palette != null && !TryGetPaletteId(palette, out paletteId)) {
+					flags |= FlagPalette;
+				}
+
+				var paletteLength = palette == null ? 0 : (flags & FlagPalette) != 0 ? 1 + 4 + palette.Length * 4 : 1;
+				var data = Allocate("frame".Length + 1 + 1 + 1 + 4 + paletteLength + 4 + packed.Length);
+				var pos = WriteName(data, "frame");
+				data[pos++] = (byte)code;
+				data[pos++] = flags;
+				pos = WriteInt(data, pos, timestamp);
+				if (palette != null) {
+					data[pos++] = (byte)paletteId;
+					if ((flags & FlagPalette) != 0) {
+						pos = WriteColors(data, pos, palette);
+					}
+				}
+				pos = WriteInt(data, pos, length);
+				Buffer.BlockCopy(packed, 0, data, pos, packed.Length);
+				return data;
+			}
+		}
+
+		/// <summary>
+		/// Returns the ID of a palette that was already sent, or assigns a new ID.
+		/// </summary>
+		/// <returns>True if the palette was already sent, false if it needs to be sent.</returns>
+		private bool TryGetPaletteId(Color[] palette, out int paletteId)
+		{
+			// most of the time, it's the same palette as before.
+			if (_lastPaletteId < _sentPalettes.Count && _sentPalettes[_lastPaletteId].SequenceEqual(palette)) {
+				paletteId = _lastPaletteId;
+				return true;
+			}
+			for (var i = 0; i < _sentPalettes.Count; i++) {
+				if (_sentPalettes[i].SequenceEqual(palette)) {
+					paletteId = _lastPaletteId = i;
+					return true;
 				}
 			}
+
+			// not sent yet, so assign the next slot, replacing the oldest if all are used.
+			paletteId = _nextPaletteId;
+			if (paletteId < _sentPalettes.Count) {
+				_sentPalettes[paletteId] = (Color[])palette.Clone();
+			} else {
+				_sentPalettes.Add((Color[])palette.Clone());
+			}
+			_nextPaletteId = (_nextPaletteId + 1) % MaxPalettes;
+			_lastPaletteId = paletteId;
+			return false;
 		}
 
 		public byte[] SerializeGray(byte[] frame, int bitLength)
 		{
-			var timestamp = DateTime.Now.Ticks / TimeSpan.TicksPerMillisecond;
-			var data = Encoding.ASCII
-				.GetBytes("gray" + bitLength + "Planes")
-				.Concat(new byte[] { 0x0 })
-				.Concat(BitConverter.GetBytes((uint)(timestamp - _startedAt)))
-				.Concat(FrameUtil.Split(Dimensions, bitLength, frame).SelectMany(p => p));
-
-			return data.ToArray();
+			var planes = SplitRecycled(frame, bitLength);
+			if (ProtocolVersion >= 1) {
+				return SerializeFrame(bitLength == 2 ? FrameCode.Gray2 : FrameCode.Gray4, planes, null);
+			}
+			var name = bitLength == 2 ? "gray2Planes" : "gray4Planes";
+			var data = Allocate(name.Length + 1 + 4 + Length(planes));
+			var pos = WriteName(data, name);
+			pos = WriteInt(data, pos, Timestamp());
+			WritePlanes(data, pos, planes);
+			return data;
 		}
 
 		public byte[] SerializeColoredGray2(byte[][] planes, Color[] palette)
 		{
-			return SerializeColoredGray("coloredGray2", planes, palette);
+			if (ProtocolVersion >= 1) {
+				return SerializeFrame(FrameCode.ColoredGray2, planes, palette);
+			}
+			return SerializeColoredGray("coloredGray2", planes, palette, 0);
 		}
 
 		public byte[] SerializeColoredGray4(byte[][] planes, Color[] palette)
 		{
-			return SerializeColoredGray("coloredGray4", planes, palette);
+			if (ProtocolVersion >= 1) {
+				return SerializeFrame(FrameCode.ColoredGray4, planes, palette);
+			}
+			return SerializeColoredGray("coloredGray4", planes, palette, 0);
 		}
 
 		public byte[] SerializeColoredGray6(byte[][] planes, Color[] palette)
 		{
-			var timestamp = DateTime.Now.Ticks / TimeSpan.TicksPerMillisecond;
-			var buffer = new byte[24];
-			var data = Encoding.ASCII
-				.GetBytes("coloredGray6")
-				.Concat(new byte[] { 0x0 })
-				.Concat(BitConverter.GetBytes((uint)(timestamp - _startedAt)))
-				.Concat(BitConverter.GetBytes(palette.Length))
-				.Concat(ColorUtil.ToIntArray(palette).SelectMany(BitConverter.GetBytes))
-				.Concat(buffer)
-				.Concat(planes.SelectMany(p => p));
-			return data.ToArray();
+			if (ProtocolVersion >= 1) {
+				return SerializeFrame(FrameCode.ColoredGray6, planes, palette);
+			}
+			// 24 empty bytes for the rotations, which aren't sent.
+			return SerializeColoredGray("coloredGray6", planes, palette, 24);
 		}
 
-		private byte[] SerializeColoredGray(string name, byte[][] planes, Color[] palette)
+		private byte[] SerializeColoredGray(string name, byte[][] planes, Color[] palette, int padding)
 		{
-			var timestamp = DateTime.Now.Ticks / TimeSpan.TicksPerMillisecond;
-			var data = Encoding.ASCII
-				.GetBytes(name)
-				.Concat(new byte[] { 0x0 })
-				.Concat(BitConverter.GetBytes((uint)(timestamp - _startedAt)))
-				.Concat(BitConverter.GetBytes(palette.Length))
-				.Concat(ColorUtil.ToIntArray(palette).SelectMany(BitConverter.GetBytes))
-				.Concat(planes.SelectMany(p => p));
-			return data.ToArray();
+			var data = Allocate(name.Length + 1 + 4 + 4 + palette.Length * 4 + padding + Length(planes));
+			var pos = WriteName(data, name);
+			pos = WriteInt(data, pos, Timestamp());
+			pos = WriteColors(data, pos, palette);
+			Array.Clear(data, pos, padding);
+			WritePlanes(data, pos + padding, planes);
+			return data;
 		}
 
 		public byte[] SerializeRgb24(byte[] frame)
 		{
-			var timestamp = DateTime.Now.Ticks / TimeSpan.TicksPerMillisecond;
-			var data = Encoding.ASCII
-				.GetBytes("rgb24")
-				.Concat(new byte[] { 0x0 })
-				.Concat(BitConverter.GetBytes((uint)(timestamp - _startedAt)))
-				.Concat(frame);
-			return data.ToArray();
+			if (ProtocolVersion >= 1) {
+				return SerializeFrame(FrameCode.Rgb24, new[] { frame }, null);
+			}
+			var data = Allocate("rgb24".Length + 1 + 4 + frame.Length);
+			var pos = WriteName(data, "rgb24");
+			pos = WriteInt(data, pos, Timestamp());
+			Buffer.BlockCopy(frame, 0, data, pos, frame.Length);
+			return data;
 		}
 
 		public byte[] SerializeGameName(string gameName)
 		{
-			var data = Encoding.ASCII
-				.GetBytes("gameName")
-				.Concat(new byte[] { 0x0 })
-				.Concat(Encoding.ASCII.GetBytes(gameName));
+			var data = Allocate("gameName".Length + 1 + gameName.Length);
+			var pos = WriteName(data, "gameName");
+			Encoding.ASCII.GetBytes(gameName, 0, gameName.Length, data, pos);
 			Logger.Info("Sent game name to socket.");
-			return data.ToArray();
+			return data;
 		}
 
 		public byte[] SerializeDimensions(Dimensions dim)
 		{
 			Dimensions = dim;
-			var data = Encoding.ASCII
-				.GetBytes("dimensions")
-				.Concat(new byte[] { 0x0 })
-				.Concat(BitConverter.GetBytes(Dimensions.Width))
-				.Concat(BitConverter.GetBytes(Dimensions.Height));
+			var data = Allocate("dimensions".Length + 1 + 4 + 4);
+			var pos = WriteName(data, "dimensions");
+			pos = WriteInt(data, pos, Dimensions.Width);
+			WriteInt(data, pos, Dimensions.Height);
 			Logger.Info($"Sent dimensions to socket {Dimensions}.");
-			return data.ToArray();
+			return data;
 		}
 
 		public byte[] SerializeColor(Color color)
 		{
-			var data = Encoding.ASCII
-				.GetBytes("color")
-				.Concat(new byte[] { 0x0 })
-				.Concat(BitConverter.GetBytes(ColorUtil.ToInt(color)));
-			return data.ToArray();
+			var data = Allocate("color".Length + 1 + 4);
+			var pos = WriteName(data, "color");
+			WriteInt(data, pos, ColorUtil.ToInt(color));
+			return data;
 		}
 
 		public byte[] SerializePalette(Color[] colors)
 		{
-			var data = Encoding.ASCII
-				.GetBytes("palette")
-				.Concat(new byte[] { 0x0 })
-				.Concat(BitConverter.GetBytes(colors.Length))
-				.Concat(ColorUtil.ToIntArray(colors).SelectMany(BitConverter.GetBytes));
-			return data.ToArray();
+			var data = Allocate("palette".Length + 1 + 4 + colors.Length * 4);
+			var pos = WriteName(data, "palette");
+			WriteColors(data, pos, colors);
+			return data;
 		}
 
 		public byte[] SerializeClearColor()
 		{
-			var data = Encoding.ASCII
-				.GetBytes("clearColor")
-				.Concat(new byte[] { 0x0 });
-			return data.ToArray();
+			var data = Allocate("clearColor".Length + 1);
+			WriteName(data, "clearColor");
+			return data;
 		}
 
 		public byte[] SerializeClearPalette()
 		{
-			var data = Encoding.ASCII
-				.GetBytes("clearPalette")
-				.Concat(new byte[] { 0x0 });
-			return data.ToArray();
+			var data = Allocate("clearPalette".Length + 1);
+			WriteName(data, "clearPalette");
+			return data;
+		}
+
+		/// <summary>
+		/// Returns a buffer for a message, from the pool if set.
+		/// </summary>
+		private byte[] Allocate(int length) => Pool?.Rent(length) ?? new byte[length];
+
+		private int Timestamp() => (int)(DateTime.Now.Ticks / TimeSpan.TicksPerMillisecond - _startedAt);
+
+		/// <summary>
+		/// Splits a frame into bit planes, re-using the planes of the previous frame.
+		/// </summary>
+		private byte[][] SplitRecycled(byte[] frame, int bitLength)
+		{
+			var planeSize = Dimensions.Surface / 8;
+			if (bitLength >= _planes.Length) {
+				return FrameUtil.Split(Dimensions, bitLength, frame);
+			}
+			if (_planes[bitLength]?[0]?.Length != planeSize) {
+				_planes[bitLength] = new byte[bitLength][];
+			}
+			return FrameUtil.Split(Dimensions, bitLength, frame, _planes[bitLength]);
+		}
+
+		private static int Length(byte[][] planes)
+		{
+			var length = 0;
+			foreach (var plane in planes) {
+				length += plane.Length;
+			}
+			return length;
+		}
+
+		private static int WriteName(byte[] data, string name)
+		{
+			for (var i = 0; i < name.Length; i++) {
+				data[i] = (byte)name[i];
+			}
+			data[name.Length] = 0x0;
+			return name.Length + 1;
+		}
+
+		private static int WriteInt(byte[] data, int pos, int value)
+		{
+			data[pos] = (byte)value;
+			data[pos + 1] = (byte)(value >> 8);
+			data[pos + 2] = (byte)(value >> 16);
+			data[pos + 3] = (byte)(value >> 24);
+			return pos + 4;
+		}
+
+		private static int WriteColors(byte[] data, int pos, Color[] colors)
+		{
+			pos = WriteInt(data, pos, colors.Length);
+			foreach (var color in colors) {
+				pos = WriteInt(data, pos, ColorUtil.ToInt(color));
+			}
+			return pos;
+		}
+
+		private static int WritePlanes(byte[] data, int pos, byte[][] planes)
+		{
+			foreach (var plane in planes) {
+				Buffer.BlockCopy(plane, 0, data, pos, plane.Length);
+				pos += plane.Length;
+			}
+			return pos;
 		}
 	}
 }
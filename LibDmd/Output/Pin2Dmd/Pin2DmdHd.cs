@@ -36,7 +36,7 @@ namespace LibDmd.Output.Pin2Dmd
 
 		private static bool CreateRgb24HD(Dimensions dim, byte[] frame, byte[] frameBuffer, int offset, int rgbSequence, int buffermode)
 		{
-			var tmp = new byte[frameBuffer.Length];
+			var tmp = FrameBufferPool.Rent(frameBuffer.Length);
 			var identical = true;
 			CreateRgb24(dim, frame, tmp, offset, rgbSequence);
 			var dest_idx = offset;
@@ -78,6 +78,7 @@ namespace LibDmd.Output.Pin2Dmd
 					}
 				}
 			}
+			FrameBufferPool.Return(tmp);
 			return !identical;
 		}
 
@@ -34,6 +34,9 @@ namespace LibDmd.Output.PinUp
 
 		private readonly Dimensions _size = Dimensions.Standard;
 		private readonly IntPtr _pnt;
+		private Color[] _palette;
+
+		private static readonly byte[] Gray2ToGray4 = { 0x0, 0x1, 0x4, 0xf };
 		private static readonly Logger Logger = LogManager.GetCurrentClassLogger();
 
 		public PinUpOutput(string romName)
@@ -112,14 +115,19 @@ namespace LibDmd.Output.PinUp
 				return;
 			}
 
+			// the rgb data is copied to native memory right away, so it can go back to the pool afterwards.
+			var rgbData = FrameBufferPool.Rent(frame.Data.Length * 3);
 			try {
-				var rgbFrame = frame.CloneFrame().ConvertGrayToRgb24(ColorUtil.GetPalette(new[] { Colors.Black, Colors.OrangeRed }, frame.NumColors));
-				Marshal.Copy(rgbFrame.Data, 0, _pnt, rgbFrame.Data.Length);
+				ColorUtil.ColorizeRgb(frame.Dimensions, frame.Data, GetPalette(frame.NumColors), 3, rgbData);
+				Marshal.Copy(rgbData, 0, _pnt, rgbData.Length);
 				Render_RGB24((ushort) FixedSize.Width, (ushort) FixedSize.Height, _pnt);
 
 			} catch (Exception e) {
 				IsAvailable = false;
 				Logger.Error(e, "[pinup] Error sending frame to PinUp, disabling.");
+
+			} finally {
+				FrameBufferPool.Return(rgbData);
 			}
 		}
 
@@ -131,7 +139,15 @@ namespace LibDmd.Output.PinUp
 			}
 
 			// 2-bit frames are rendered as 4-bit
-			RenderGray4(frame.Update(FrameUtil.ConvertGrayToGray(frame.Data, new byte[] { 0x0, 0x1, 0x4, 0xf }), 4));
+			RenderGray4(frame.Update(FrameUtil.ConvertGrayToGray(frame.Data, Gray2ToGray4), 4));
+		}
+
+		private Color[] GetPalette(int numColors)
+		{
+			if (_palette == null || _palette.Length != numColors) {
+				_palette = ColorUtil.GetPalette(new[] { Colors.Black, Colors.OrangeRed }, numColors);
+			}
+			return _palette;
 		}
 
 		public void OnFrameEventInit(FrameEventInit frameEventInit)
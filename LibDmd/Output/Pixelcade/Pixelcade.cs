@@ -289,11 +289,12 @@ namespace LibDmd.Output.Pixelcade
 			var frame565 = ColorUtil.ConvertRgb24ToRgb565(FixedSize, frameRgb24.Data, new ushort[FixedSize.Surface]);
 
 			// split into planes to send over the wire
-			var newFrame = new byte[FixedSize.Surface * 3 / 2];
+			var newFrame = FrameBufferPool.Rent(FixedSize.Surface * 3 / 2);
 			FrameUtil.SplitIntoRgbPlanes(frame565, FixedSize.Width, 16, newFrame, ColorMatrix);
 
 			// copy to frame buffer
 			var changed = FrameUtil.Copy(newFrame, _frameBuffer, 1);
+			FrameBufferPool.Return(newFrame);
 
 			// send to device if changed
 			if (changed) {
@@ -315,11 +316,12 @@ namespace LibDmd.Output.Pixelcade
 			var frame565 = FrameUtil.CastToUShort(frame.Data);
 
 			// split into planes to send over the wire
-			var newFrame = new byte[FixedSize.Surface * 3 / 2];
+			var newFrame = FrameBufferPool.Rent(FixedSize.Surface * 3 / 2);
 			FrameUtil.SplitIntoRgbPlanes(frame565, FixedSize.Width, 16, newFrame, ColorMatrix);
 
 			// copy to frame buffer
 			var changed = FrameUtil.Copy(newFrame, _frameBuffer, 1);
+			FrameBufferPool.Return(newFrame);
 
 			// send to device if changed
 			if (changed) {
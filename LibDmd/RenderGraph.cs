@@ -107,6 +107,23 @@ namespace LibDmd
 
 		public ScalerMode ScalerMode { get; set; } = ScalerMode.None;
 
+		/// <summary>
+		/// If set, the converter and every destination run on their own thread
+		/// instead of the thread pool.
+		/// </summary>
+		///
+		/// <remarks>
+		/// These threads are shared by all graphs with the same references, so
+		/// a destination connected through several graphs still renders one
+		/// frame at the time, and the converter gets its frames in order.
+		/// </remarks>
+		public bool DedicatedThreads { get; set; }
+
+		/// <summary>
+		/// The queues of the connected destinations, with their drop and latency counters.
+		/// </summary>
+		public IEnumerable<DestinationQueue> DestinationQueues => _destinationQueues.Values;
+
 		#endregion
 
 		#region Constants
@@ -136,6 +153,8 @@ namespace LibDmd
 		private RenderGraph _idleRenderGraph;
 		
 		private readonly CompositeDisposable _activeSources = new CompositeDisposable();
+		private readonly Dictionary<IDestination, DestinationQueue> _destinationQueues = new Dictionary<IDestination, DestinationQueue>();
+		private readonly HashSet<PipelineStage> _stages = new HashSet<PipelineStage>();
 		private readonly bool _runOnMainThread;
 		private readonly UndisposedReferences _refs;
 
@@ -257,6 +276,9 @@ namespace LibDmd
 				_activeRenderer.Dispose();
 				_activeRenderer = null;
 			}
+			foreach (var stage in _stages) {
+				_refs.Dispose(stage);
+			}
 			Converter?.Dispose();
 
 			if (Destinations != null) {
@@ -267,6 +289,10 @@ namespace LibDmd
 			foreach (var source in _activeSources) {
 				source.Dispose();
 			}
+			foreach (var queue in _destinationQueues.Values) {
+				queue.LogStatistics();
+			}
+			FrameBufferPool.LogStatistics();
 		}
 		
 		#endregion
@@ -300,25 +326,35 @@ namespace LibDmd
 				// subscribe converter to incoming frames
 				if (Converter != null) {
 
+					var convertProbe = Profiler.GetProbe($"Convert.{((ISource)Converter).Name}");
+					var convertGray = Measure<DmdFrame>(convertProbe, Converter.Convert);
+					var convertAlphaNumeric = Measure<AlphaNumericFrame>(convertProbe, Converter.Convert);
+
+					if (DedicatedThreads && !_runOnMainThread) {
+						var stage = GetStage(Converter, $"Convert.{((ISource)Converter).Name}");
+						convertGray = Post(stage, convertGray);
+						convertAlphaNumeric = Post(stage, convertAlphaNumeric);
+					}
+
 					// subscribe converter to incoming frames
 					foreach (var from in Converter.From) {
 						switch (from) {
 							case FrameFormat.Gray2:
 								if (sourceGray2 != null) {
 									Logger.Info($"  == Listening to {sourceGray2.Name} for {((ISource)Converter).Name} ({from})");
-									_activeSources.Add(sourceGray2.GetGray2Frames(!Converter.NeedsDuplicateFrames, false).Do(Converter.Convert).Subscribe());
+									_activeSources.Add(sourceGray2.GetGray2Frames(!Converter.NeedsDuplicateFrames, false).Do(convertGray).Subscribe());
 								}
 								break;
 							case FrameFormat.Gray4:
 								if (sourceGray4 != null) {
 									Logger.Info($"  == Listening to {sourceGray4.Name} for {((ISource)Converter).Name} ({from})");
-									_activeSources.Add(sourceGray4.GetGray4Frames(!Converter.NeedsDuplicateFrames, false).Do(Converter.Convert).Subscribe());
+									_activeSources.Add(sourceGray4.GetGray4Frames(!Converter.NeedsDuplicateFrames, false).Do(convertGray).Subscribe());
 								}
 								break;
 							case FrameFormat.AlphaNumeric:
 								if (sourceAlphaNumeric != null) {
 									Logger.Info($"  == Listening to {sourceAlphaNumeric.Name} for {((ISource)Converter).Name} ({from})");
-									_activeSources.Add(sourceAlphaNumeric.GetAlphaNumericFrames().Do(Converter.Convert).Subscribe());
+									_activeSources.Add(sourceAlphaNumeric.GetAlphaNumericFrames().Do(convertAlphaNumeric).Subscribe());
 								}
 								break;
 							default:
@@ -847,12 +883,10 @@ namespace LibDmd
 						// gray2 -> rgb565
 						case FrameFormat.Rgb565:
 							AssertCompatibility(source, sourceGray2, dest, destRgb565, from, to);
+							var gray2ToRgb565 = new GrayToRgbPipeline(this, destFixedSize, destMultiSize, 2);
 							Subscribe(
 								sourceGray2.GetGray2Frames(!dest.NeedsDuplicateFrames, !dest.NeedsIdentificationFrames),
-								frame => frame
-									.TransformHdScaling(destFixedSize, ScalerMode)
-									.ConvertGrayToRgb565(_gray2Palette ?? _gray2Colors)
-									.TransformRgb565(this, destFixedSize, destMultiSize),
+								frame => gray2ToRgb565.Process(frame, _gray2Palette ?? _gray2Colors),
 								destRgb565.RenderRgb565
 							);
 							break;
@@ -860,12 +894,10 @@ namespace LibDmd
 						// gray2 -> rgb24
 						case FrameFormat.Rgb24:
 							AssertCompatibility(source, sourceGray2, dest, destRgb24, from, to);
+							var gray2ToRgb24 = new GrayToRgbPipeline(this, destFixedSize, destMultiSize, 3);
 							Subscribe(
 								sourceGray2.GetGray2Frames(!dest.NeedsDuplicateFrames, !dest.NeedsIdentificationFrames),
-								frame => frame
-									.TransformHdScaling(destFixedSize, ScalerMode)
-									.ConvertGrayToRgb24(_gray2Palette ?? _gray2Colors)
-									.TransformRgb24(this, destFixedSize, destMultiSize),
+								frame => gray2ToRgb24.Process(frame, _gray2Palette ?? _gray2Colors),
 								destRgb24.RenderRgb24
 							);
 							break;
@@ -930,12 +962,10 @@ namespace LibDmd
 						// gray4 -> rgb565
 						case FrameFormat.Rgb565:
 							AssertCompatibility(source, sourceGray4, dest, destRgb565, from, to);
+							var gray4ToRgb565 = new GrayToRgbPipeline(this, destFixedSize, destMultiSize, 2);
 							Subscribe(
 								sourceGray4.GetGray4Frames(!dest.NeedsDuplicateFrames, !dest.NeedsIdentificationFrames),
-								frame => frame
-									.TransformHdScaling(destFixedSize, ScalerMode)
-									.ConvertGrayToRgb565(_gray4Palette ?? _gray4Colors)
-									.TransformRgb565(this, destFixedSize, destMultiSize),
+								frame => gray4ToRgb565.Process(frame, _gray4Palette ?? _gray4Colors),
 								destRgb565.RenderRgb565
 							);
 							break;
@@ -943,12 +973,10 @@ namespace LibDmd
 						// gray4 -> rgb24
 						case FrameFormat.Rgb24:
 							AssertCompatibility(source, sourceGray4, dest, destRgb24, from, to);
+							var gray4ToRgb24 = new GrayToRgbPipeline(this, destFixedSize, destMultiSize, 3);
 							Subscribe(
 								sourceGray4.GetGray4Frames(!dest.NeedsDuplicateFrames, !dest.NeedsIdentificationFrames),
-								frame => frame
-									.TransformHdScaling(destFixedSize, ScalerMode)
-									.ConvertGrayToRgb24(_gray4Palette ?? _gray4Colors)
-									.TransformRgb24(this, destFixedSize, destMultiSize),
+								frame => gray4ToRgb24.Process(frame, _gray4Palette ?? _gray4Colors),
 								destRgb24.RenderRgb24);
 							break;
 
@@ -1038,12 +1066,10 @@ namespace LibDmd
 						// gray8 -> rgb565
 						case FrameFormat.Rgb565:
 							AssertCompatibility(source, sourceGray8, dest, destRgb565, from, to);
+							var gray8ToRgb565 = new GrayToRgbPipeline(this, destFixedSize, destMultiSize, 2);
 							Subscribe(
 								sourceGray8.GetGray8Frames(!dest.NeedsDuplicateFrames),
-								frame => frame
-									.TransformHdScaling(destFixedSize, ScalerMode)
-									.ConvertGrayToRgb565(_gray8Palette ?? _gray8Colors)
-									.TransformRgb565(this, destFixedSize, destMultiSize),
+								frame => gray8ToRgb565.Process(frame, _gray8Palette ?? _gray8Colors),
 								destRgb565.RenderRgb565
 							);
 							break;
@@ -1051,12 +1077,10 @@ namespace LibDmd
 						// gray8 -> rgb24
 						case FrameFormat.Rgb24:
 							AssertCompatibility(source, sourceGray8, dest, destRgb24, from, to);
+							var gray8ToRgb24 = new GrayToRgbPipeline(this, destFixedSize, destMultiSize, 3);
 							Subscribe(
 								sourceGray8.GetGray8Frames(!dest.NeedsDuplicateFrames),
-								frame => frame
-									.TransformHdScaling(destFixedSize, ScalerMode)
-									.ConvertGrayToRgb24(_gray8Palette ?? _gray8Colors)
-									.TransformRgb24(this, destFixedSize, destMultiSize),
+								frame => gray8ToRgb24.Process(frame, _gray8Palette ?? _gray8Colors),
 								destRgb24.RenderRgb24);
 							break;
 
@@ -1627,6 +1651,16 @@ namespace LibDmd
 		/// <remarks>
 		/// This also does all the common stuff, i.e. setting the correct scheduler,
 		/// enabling idle detection, etc.
+		///
+		/// Unless running on the main thread, frames are passed to the destination
+		/// through its <see cref="DestinationQueue"/>, so a destination that can't
+		/// keep up drops stale frames without holding up the others. Other data,
+		/// like palette changes and frame events, is never dropped.
+		///
+		/// Each connection is measured by three <see cref="Profiler"/> probes, named
+		/// after the destination and its render method: "Source" for the time between
+		/// two frames of the source, "Transform" for the processor, and "Render" for
+		/// the destination's render call.
 		/// </remarks>
 		///
 		/// <typeparam name="TIn">Source frame type</typeparam>
@@ -1636,6 +1670,22 @@ namespace LibDmd
 		/// <param name="onNext">Action to run on destination</param>
 		private void Subscribe<TIn, TOut>(IObservable<TIn> src, Func<TIn, TOut> processor, Action<TOut> onNext) where TIn : class, ICloneable
 		{
+			// measure, but keep onNext for the queue lookup.
+			var render = onNext;
+			if (onNext.Target is IDestination destination) {
+				var name = $"{destination.Name}.{onNext.Method.Name}";
+				var sourceProbe = Profiler.GetProbe($"Source.{name}");
+				var transformProbe = Profiler.GetProbe($"Transform.{name}");
+				var process = processor;
+				src = src.Do(_ => sourceProbe.Mark());
+				processor = frame => {
+					using (transformProbe.Start()) {
+						return process(frame);
+					}
+				};
+				render = Measure(Profiler.GetProbe($"Render.{name}"), onNext);
+			}
+
 			// set idle timeout if enabled
 			if (IdleAfter > 0) {
 
@@ -1647,7 +1697,7 @@ namespace LibDmd
 
 				// now render it
 				src = src.Do(_ => StopIdling());
-				var dest = src.Select(frame => (TIn)frame.Clone()).Select(processor).Do(onNext);
+				var dest = Enqueue(src.Select(frame => (TIn)frame.Clone()), onNext).Select(processor).Do(render);
 
 				// but subscribe to a throttled idle action
 				dest = dest.Throttle(TimeSpan.FromMilliseconds(IdleAfter));
@@ -1664,13 +1714,75 @@ namespace LibDmd
 				// subscribe and add to active sources
 				SynchronizationContext.SetSynchronizationContext(new DispatcherSynchronizationContext(Dispatcher.CurrentDispatcher));
 
+				// snapshot the frame before handing it to another thread, since
+				// sources may update the same instance for their next frame.
+				// cloning is shallow, so the data itself is shared between
+				// connections, and only replaced when a stage changes it.
+				var frames = src.Select(frame => (TIn)frame.Clone());
+
 				// run frame processing on separate thread.
-				if (!_runOnMainThread) {
-					src = src.ObserveOn(Scheduler.Default);
+				_activeSources.Add(Enqueue(frames, onNext).Select(processor).Subscribe(render));
+			}
+		}
+
+		/// <summary>
+		/// Wraps an action so its duration is recorded by a probe.
+		/// </summary>
+		private static Action<T> Measure<T>(Probe probe, Action<T> action)
+		{
+			return value => {
+				using (probe.Start()) {
+					action(value);
 				}
+			};
+		}
+
+		/// <summary>
+		/// Wraps an action so it runs on a stage's thread.
+		/// </summary>
+		/// <remarks>
+		/// The action gets a snapshot of the frame, since sources may update the
+		/// same instance for their next frame.
+		/// </remarks>
+		private static Action<T> Post<T>(PipelineStage stage, Action<T> action) where T : ICloneable
+		{
+			return frame => {
+				var snapshot = (T)frame.Clone();
+				stage.Post(() => action(snapshot));
+			};
+		}
 
-				_activeSources.Add(src.Select(frame => (TIn)frame.Clone()).Select(processor).Subscribe(onNext));
+		/// <summary>
+		/// Moves frames onto a separate thread, through the destination's queue if they are frames.
+		/// </summary>
+		/// <param name="frames">Frames to move</param>
+		/// <param name="onNext">Action to run on destination, which is where the destination is retrieved from</param>
+		private IObservable<TIn> Enqueue<TIn, TOut>(IObservable<TIn> frames, Action<TOut> onNext)
+		{
+			if (_runOnMainThread) {
+				return frames;
+			}
+			var isFrame = typeof(BaseFrame).IsAssignableFrom(typeof(TIn)) || typeof(TIn) == typeof(AlphaNumericFrame);
+			var dest = onNext.Target as IDestination;
+			var stage = DedicatedThreads && dest != null ? GetStage(dest, $"Render.{dest.Name}") : null;
+			if (!isFrame || dest == null) {
+				return stage != null ? stage.ObserveOn(frames) : frames.ObserveOn(Scheduler.Default);
+			}
+			if (!_destinationQueues.TryGetValue(dest, out var queue)) {
+				queue = stage != null ? new DestinationQueue(dest.Name, stage) : new DestinationQueue(dest.Name, Scheduler.Default);
+				_destinationQueues.Add(dest, queue);
 			}
+			return queue.Coalesce(frames);
+		}
+
+		/// <summary>
+		/// Returns the thread of a converter or destination, shared with the other graphs.
+		/// </summary>
+		private PipelineStage GetStage(object owner, string name)
+		{
+			var stage = _refs.GetStage(owner, name);
+			_stages.Add(stage);
+			return stage;
 		}
 
 		/// <summary>
@@ -1875,6 +1987,7 @@ namespace LibDmd
 	public class UndisposedReferences
 	{
 		private readonly HashSet<IDisposable> _refs = new HashSet<IDisposable>();
+		private readonly Dictionary<object, PipelineStage> _stages = new Dictionary<object, PipelineStage>();
 
 		public void Add(List<IDestination> destinations)
 		{
@@ -1901,6 +2014,21 @@ namespace LibDmd
 			}
 		}
 
+		/// <summary>
+		/// Returns the thread the given converter or destination runs on, and starts it if necessary.
+		/// </summary>
+		public PipelineStage GetStage(object owner, string name)
+		{
+			lock (_refs) {
+				if (!_stages.TryGetValue(owner, out var stage) || !_refs.Contains(stage)) {
+					stage = new PipelineStage(name);
+					_stages[owner] = stage;
+					_refs.Add(stage);
+				}
+				return stage;
+			}
+		}
+
 		public bool Dispose(IDisposable disposable)
 		{
 			lock (_refs) {
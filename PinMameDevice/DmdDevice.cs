@@ -2,6 +2,7 @@
 using System.Collections.Generic;
 using System.Linq;
 using System.Runtime.InteropServices;
+using System.Threading;
 using System.Windows.Media;
 using LibDmd.Common;
 using LibDmd.DmdDevice;
@@ -17,6 +18,12 @@ namespace PinMameDevice
 	/// <remarks>
 	/// Diä Klass beinhautet fasch kä Logik sondrn tuät fascht auäs diräkt a
 	/// <see cref="LibDmd.DmdDevice.DmdDevice"/> weytrleitä.
+	///
+	/// Frames are called from PinMAME's emulation thread, so they are only
+	/// copied into a <see cref="FrameRing{THeader}"/> and rendered on a
+	/// separate thread per device, so the emulation never waits for the
+	/// render graph. Calls that change the device's state wait until the
+	/// frames before them are rendered, so they keep their order.
 	/// </remarks>
 	/// <see href="https://sourceforge.net/p/pinmame/code/HEAD/tree/trunk/ext/dmddevice/dmddevice.h"/>
 	public static class DmdDevice
@@ -34,6 +41,37 @@ namespace PinMameDevice
 			public DmdFrame DmdIdentifyFrame { get; } = new DmdFrame();
 			public RawFrame RawDmdFrame { get; } = new RawFrame();
 			public LinkedList<char> CData { get; } = new LinkedList<char>();
+			public FrameRing<QueuedFrame> Frames = CreateFrameRing();
+			public Thread Consumer;
+			public CancellationTokenSource ConsumerStop;
+		}
+
+		private enum FrameKind
+		{
+			Gray2, Gray4, Rgb24, Raw2, Raw4, FloatLumRaw, AlphaNumeric
+		}
+
+		/// <summary>
+		/// Describes a frame in the ring. The data is the frame, followed by the raw planes or second segment block, if any.
+		/// </summary>
+		private struct QueuedFrame
+		{
+			public FrameKind Kind;
+			public ushort Width;
+			public ushort Height;
+
+			/// <summary>
+			/// Number of raw planes, raw bit size, or numerical layout, depending on the kind.
+			/// </summary>
+			public int Param;
+
+			public QueuedFrame(FrameKind kind, ushort width, ushort height, int param = 0)
+			{
+				Kind = kind;
+				Width = width;
+				Height = height;
+				Param = param;
+			}
 		}
 
 		static DmdDevice()
@@ -193,6 +231,7 @@ namespace PinMameDevice
 		private static bool InternalCloseDevice(DeviceInstance device)
 		{
 			Logger.Info("[dll] Close({0})", device.Id);
+			StopConsumer(device);
 			device.DmdDevice.Close();
 			if (device != DefaultDevice) {
 				DmdDevices[device.Id] = null;
@@ -204,6 +243,7 @@ namespace PinMameDevice
 		{
 			var opt = (PMoptions)Marshal.PtrToStructure(options, typeof(PMoptions));
 			Logger.Info("[dll] PM_GameSettings({0}, {1}, {2})", device.Id, gameName, opt.Colorize);
+			Flush(device);
 			device.DmdDevice.SetColorize(opt.Colorize != 0);
 			device.DmdDevice.SetGameName(gameName);
 			device.DmdDevice.SetColor(Color.FromRgb((byte)(opt.Red), (byte)(opt.Green), (byte)(opt.Blue)));
@@ -212,6 +252,7 @@ namespace PinMameDevice
 
 		private static void InternalConsoleDataDevice(DeviceInstance device, byte data)
 		{
+			Flush(device);
 			device.DmdDevice.ConsoleData(data);
 
 			// Dä schickt immr eis Byte abr eigentlich wettr Bleck vo viär Bytes,
@@ -243,95 +284,48 @@ namespace PinMameDevice
 
 		private static void InternalRenderRgb24Device(DeviceInstance device, ushort width, ushort height, IntPtr currbuffer)
 		{
-			var frameSize = width * height * 3;
-			var frame = new byte[frameSize];
-			Marshal.Copy(currbuffer, frame, 0, frameSize);
-			device.DmdDevice.RenderRgb24(device.DmdFrame.Update(new Dimensions(width, height), frame, 24));
+			Enqueue(device, new QueuedFrame(FrameKind.Rgb24, width, height), currbuffer, width * height * 3);
 		}
 
 		private static void InternalRenderRawFloatDevice(DeviceInstance device, ushort width, ushort height, IntPtr lumFramePtr, IntPtr rawFramePtr, byte rawBitSize)
 		{
 			var frameSize = width * height;
-			var lumFloatFrame = new float[frameSize];
-			Marshal.Copy(lumFramePtr, lumFloatFrame, 0, frameSize);
-
-			// convert to 8-bit grayscale
-			var lumByteFrame = new byte[frameSize];
-			for (var i = 0; i < frameSize; i++) {
-				var v = lumFloatFrame[i];
-				if (v < 0f) v = 0f;
-				if (v > 1f) v = 1f;
-				lumByteFrame[i] = (byte)(v * 255f);
-			}
-
-			var rawFrame = new byte[frameSize];
-			Marshal.Copy(rawFramePtr, rawFrame, 0, frameSize);
-
-			device.DmdDevice.RenderGray8(
-				device.DmdFrame.Update(new Dimensions(width, height), lumByteFrame, 8),
-				device.DmdIdentifyFrame.Update(new Dimensions(width, height), rawFrame, rawBitSize, true)
-			);
+			Enqueue(device, new QueuedFrame(FrameKind.FloatLumRaw, width, height, rawBitSize), lumFramePtr, frameSize * sizeof(float), rawFramePtr, frameSize);
 		}
 
 		private static void InternalRenderRaw4Device(DeviceInstance device, ushort width, ushort height, IntPtr currbuffer, ushort noOfRawFrames, IntPtr currrawbuffer)
 		{
 			noOfRawFrames = Math.Min(noOfRawFrames, (ushort)4);
 			var frameSize = width * height;
-			var frame = new byte[frameSize];
-			Marshal.Copy(currbuffer, frame, 0, frameSize);
-
-			var rawplanes = new byte[noOfRawFrames][];
-			var planeSize = frameSize / 8;
-			for (int i = 0; i < noOfRawFrames; i++)
-			{
-				rawplanes[i] = new byte[planeSize];
-				Marshal.Copy(new IntPtr(currrawbuffer.ToInt64() + (i * planeSize)), rawplanes[i], 0, planeSize);
-			}
-			device.DmdDevice.RenderGray4(device.RawDmdFrame.Update(new Dimensions(width, height), frame, rawplanes, Array.Empty<byte[]>()));
+			Enqueue(device, new QueuedFrame(FrameKind.Raw4, width, height, noOfRawFrames), currbuffer, frameSize, currrawbuffer, noOfRawFrames * (frameSize / 8));
 		}
 
 		private static void InternalRenderRaw2Device(DeviceInstance device, ushort width, ushort height, IntPtr currBuffer, ushort noOfRawPlanes, IntPtr currrawbuffer)
 		{
 			var frameSize = width * height;
-			var frame = new byte[frameSize];
-			Marshal.Copy(currBuffer, frame, 0, frameSize);
-			var rawPlanes = new byte[2][];
-			var rawExtraPlanes = new byte[noOfRawPlanes - 2][];
-			var planeSize = frameSize / 8;
-			for (int i = 0; i < noOfRawPlanes; i++)
-			{
-				var dest = i > 1 ? rawExtraPlanes : rawPlanes;
-				var pos = i > 1 ? i - 2 : i;
-				dest[pos] = new byte[planeSize];
-				Marshal.Copy(new IntPtr(currrawbuffer.ToInt64() + (i * planeSize)), dest[pos], 0, planeSize);
-			}
-			device.DmdDevice.RenderGray2(device.RawDmdFrame.Update(new Dimensions(width, height), frame, rawPlanes, rawExtraPlanes));
+			Enqueue(device, new QueuedFrame(FrameKind.Raw2, width, height, noOfRawPlanes), currBuffer, frameSize, currrawbuffer, noOfRawPlanes * (frameSize / 8));
 		}
 
 		private static void InternalRenderGray4Device(DeviceInstance device, ushort width, ushort height, IntPtr currbuffer)
 		{
-			var frameSize = width * height;
-			var frame = new byte[frameSize];
-			Marshal.Copy(currbuffer, frame, 0, frameSize);
-			device.DmdDevice.RenderGray4(device.DmdFrame.Update(new Dimensions(width, height), frame, 4));
+			Enqueue(device, new QueuedFrame(FrameKind.Gray4, width, height), currbuffer, width * height);
 		}
 
 		private static void InternalRenderGray2Device(DeviceInstance device, ushort width, ushort height, IntPtr currbuffer)
 		{
-			var frameSize = width * height;
-			var frame = new byte[frameSize];
-			Marshal.Copy(currbuffer, frame, 0, frameSize);
-			device.DmdDevice.RenderGray2(device.DmdFrame.Update(new Dimensions(width, height), frame, 2));
+			Enqueue(device, new QueuedFrame(FrameKind.Gray2, width, height), currbuffer, width * height);
 		}
 
 		private static void InternalRenderAlphaNumDevice(DeviceInstance device, NumericalLayout numericalLayout, IntPtr seg_data, IntPtr seg_data2)
 		{
-			device.DmdDevice.RenderAlphaNumeric(numericalLayout, InteropUtil.ReadUInt16Array(seg_data, 64), InteropUtil.ReadUInt16Array(seg_data2, 64));
+			const int segSize = 64 * sizeof(ushort);
+			Enqueue(device, new QueuedFrame(FrameKind.AlphaNumeric, 0, 0, (int)numericalLayout), seg_data, segSize, seg_data2, seg_data2 == IntPtr.Zero ? 0 : segSize);
 		}
 
 		private static void InternalSetGray2PaletteDevice(DeviceInstance device, Rgb24 color0, Rgb24 color33, Rgb24 color66, Rgb24 color100)
 		{
 			Logger.Info($"[dll] Set_4_Colors_Palette(device: {device.Id}, 0%: {color0}, 33%:{color33}, 66%:{color66}, 100%:{color100})");
+			Flush(device);
 			device.DmdDevice.SetPalette(new[] {
 				ConvertColor(color0),
 				ConvertColor(color33),
@@ -343,6 +337,7 @@ namespace PinMameDevice
 		private static void InternalSetGray4PaletteDevice(DeviceInstance device, IntPtr palette)
 		{
 			Logger.Info("[dll] Set_16_Colors_Palette({0},...)", device.Id);
+			Flush(device);
 
 			byte[] p = new byte[48];
 			Color[] colors = new Color[16];
@@ -355,6 +350,174 @@ namespace PinMameDevice
 
 		#endregion
 
+		#region Frame Queue
+
+		/// <summary>
+		/// Copies a frame into the device's ring and returns. Starts the render thread on the first frame.
+		/// </summary>
+		private static void Enqueue(DeviceInstance device, QueuedFrame header, IntPtr data, int length, IntPtr extraData = default, int extraLength = 0)
+		{
+			if (device.Consumer == null) {
+				StartConsumer(device);
+			}
+			device.Frames.TryWrite(header, data, length, extraData, extraLength);
+		}
+
+		/// <summary>
+		/// Waits until all queued frames are rendered, so calls changing the device's state apply after them.
+		/// </summary>
+		private static void Flush(DeviceInstance device)
+		{
+			if (device.Consumer == null) {
+				return;
+			}
+			if (!SpinWait.SpinUntil(() => device.Frames.Count == 0, 1000)) {
+				Logger.Warn("[dll] Timed out waiting for {0} queued frame(s) of device {1} to render.", device.Frames.Count, device.Id);
+			}
+		}
+
+		private static FrameRing<QueuedFrame> CreateFrameRing() => new FrameRing<QueuedFrame>(8, 256 * 64 * 4);
+
+		private static void StartConsumer(DeviceInstance device)
+		{
+			// the thread gets its own ring and stop signal, so an abandoned one can't be revived by the next start.
+			var frames = device.Frames;
+			var stop = new CancellationTokenSource();
+			device.ConsumerStop = stop;
+			device.Consumer = new Thread(() => Consume(device, frames, stop.Token)) {
+				Name = $"DmdDevice {device.Id} Render",
+				IsBackground = true
+			};
+			device.Consumer.Start();
+		}
+
+		private static void StopConsumer(DeviceInstance device)
+		{
+			if (device.Consumer == null) {
+				return;
+			}
+			device.ConsumerStop.Cancel();
+			device.Frames.Wake();
+			var stopped = device.Consumer.Join(TimeSpan.FromSeconds(2));
+			device.Consumer = null;
+
+			Logger.Info("[dll] Device {0} queued {1} frame(s), {2} dropped because the render thread was behind, at most {3} of {4} waiting.",
+				device.Id, device.Frames.Written, device.Frames.Overruns, device.Frames.MaxCount, device.Frames.Capacity);
+
+			// closing, so what's left isn't worth rendering anymore. if the render thread is
+			// stuck in a frame, leave the ring to it, it's the only one allowed to read, and
+			// give the next render thread a new one.
+			if (stopped) {
+				while (device.Frames.TryRead((header, data, length) => { })) { }
+				device.ConsumerStop.Dispose();
+			} else {
+				Logger.Warn("[dll] Render thread of device {0} didn't stop in time, abandoning it.", device.Id);
+				device.Frames = CreateFrameRing();
+			}
+			device.ConsumerStop = null;
+		}
+
+		private static void Consume(DeviceInstance device, FrameRing<QueuedFrame> frames, CancellationToken stop)
+		{
+			FrameRing<QueuedFrame>.ReadHandler render = (header, data, length) => Render(device, header, data, length);
+			while (!stop.IsCancellationRequested) {
+				frames.WaitForData(-1);
+				while (!stop.IsCancellationRequested) {
+					try {
+						if (!frames.TryRead(render)) {
+							break;
+						}
+					} catch (Exception e) {
+						Logger.Error(e, "[dll] Error rendering frame on device {0}.", device.Id);
+					}
+				}
+			}
+		}
+
+		private static void Render(DeviceInstance device, QueuedFrame header, byte[] data, int length)
+		{
+			var dim = new Dimensions(header.Width, header.Height);
+			var frameSize = header.Width * header.Height;
+			switch (header.Kind) {
+				case FrameKind.Gray2:
+					device.DmdDevice.RenderGray2(device.DmdFrame.Update(dim, Copy(data, 0, frameSize), 2));
+					break;
+
+				case FrameKind.Gray4:
+					device.DmdDevice.RenderGray4(device.DmdFrame.Update(dim, Copy(data, 0, frameSize), 4));
+					break;
+
+				case FrameKind.Rgb24:
+					device.DmdDevice.RenderRgb24(device.DmdFrame.Update(dim, Copy(data, 0, frameSize * 3), 24));
+					break;
+
+				case FrameKind.Raw4: {
+					var planeSize = frameSize / 8;
+					var rawPlanes = new byte[header.Param][];
+					for (var i = 0; i < header.Param; i++) {
+						rawPlanes[i] = Copy(data, frameSize + i * planeSize, planeSize);
+					}
+					device.DmdDevice.RenderGray4(device.RawDmdFrame.Update(dim, Copy(data, 0, frameSize), rawPlanes, Array.Empty<byte[]>()));
+					break;
+				}
+
+				case FrameKind.Raw2: {
+					var planeSize = frameSize / 8;
+					var rawPlanes = new byte[2][];
+					var rawExtraPlanes = new byte[header.Param - 2][];
+					for (var i = 0; i < header.Param; i++) {
+						var dest = i > 1 ? rawExtraPlanes : rawPlanes;
+						dest[i > 1 ? i - 2 : i] = Copy(data, frameSize + i * planeSize, planeSize);
+					}
+					device.DmdDevice.RenderGray2(device.RawDmdFrame.Update(dim, Copy(data, 0, frameSize), rawPlanes, rawExtraPlanes));
+					break;
+				}
+
+				case FrameKind.FloatLumRaw: {
+					var lumFloatFrame = new float[frameSize];
+					Buffer.BlockCopy(data, 0, lumFloatFrame, 0, frameSize * sizeof(float));
+
+					// convert to 8-bit grayscale
+					var lumByteFrame = new byte[frameSize];
+					for (var i = 0; i < frameSize; i++) {
+						var v = lumFloatFrame[i];
+						if (v < 0f) v = 0f;
+						if (v > 1f) v = 1f;
+						lumByteFrame[i] = (byte)(v * 255f);
+					}
+
+					device.DmdDevice.RenderGray8(
+						device.DmdFrame.Update(dim, lumByteFrame, 8),
+						device.DmdIdentifyFrame.Update(dim, Copy(data, frameSize * sizeof(float), frameSize), header.Param, true)
+					);
+					break;
+				}
+
+				case FrameKind.AlphaNumeric: {
+					var segData = new ushort[64];
+					var segData2 = new ushort[64];
+					Buffer.BlockCopy(data, 0, segData, 0, 128);
+					if (length >= 256) {
+						Buffer.BlockCopy(data, 128, segData2, 0, 128);
+					}
+					device.DmdDevice.RenderAlphaNumeric((NumericalLayout)header.Param, segData, segData2);
+					break;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Copies a part of a ring slot, since the slot is reused once the frame is rendered.
+		/// </summary>
+		private static byte[] Copy(byte[] data, int offset, int length)
+		{
+			var copy = new byte[length];
+			Buffer.BlockCopy(data, offset, copy, 0, length);
+			return copy;
+		}
+
+		#endregion
+
 		private static Color ConvertColor(Rgb24 color)
 		{
 			return Color.FromRgb((byte) color.Red, (byte) color.Green, (byte) color.Blue);
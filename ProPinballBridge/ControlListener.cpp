@@ -0,0 +1,157 @@
+#include "ControlListener.h"
+#include "ProPinballProtocol.h"
+#include "FrameStats.h"
+#include "boost/date_time/posix_time/posix_time_types.hpp"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+
+using namespace boost::interprocess;
+
+namespace ProPinballBridge
+{
+	struct PendingMessage
+	{
+		std::vector<unsigned char> data;
+		uint64_t received_at_us;
+	};
+
+	struct ControlListenerState
+	{
+		message_queue* control_queue;
+		unsigned int message_size;
+		FrameRing* frame_ring;
+		message_queue* data_queue;
+
+		std::thread thread;
+		std::atomic<bool> stopped;
+		mutable std::mutex mutex;
+		std::deque<PendingMessage> pending;
+		std::string error;
+	};
+}
+
+using namespace ProPinballBridge;
+
+// Only a safety net so the thread notices when it's stopped. Messages are picked up as soon as they arrive.
+const unsigned int STOP_CHECK_INTERVAL_MS = 1000;
+
+static void wake_up(ControlListenerState* state)
+{
+	if (state->frame_ring)
+	{
+		state->frame_ring->wake_up();
+	}
+	else if (state->data_queue)
+	{
+		try
+		{
+			// if the queue is full, the reader isn't waiting anyway.
+			unsigned char dummy = 0;
+			state->data_queue->try_send(&dummy, WAKE_UP_MESSAGE_SIZE, WAKE_UP_MESSAGE_PRIORITY);
+		}
+		catch (interprocess_exception &exception)
+		{
+			printf("Error waking up frame loop: %s\n", exception.what());
+		}
+	}
+}
+
+static void fail(ControlListenerState* state, const char* error)
+{
+	{
+		std::lock_guard<std::mutex> lock(state->mutex);
+		state->error = error;
+	}
+	state->stopped = true;
+	wake_up(state);
+}
+
+static void listen(ControlListenerState* state)
+{
+	std::vector<unsigned char> buffer(state->message_size);
+
+	while (!state->stopped)
+	{
+		try
+		{
+			unsigned int priority;
+			message_queue::size_type received_size;
+			const boost::posix_time::ptime wait_time = boost::posix_time::microsec_clock::universal_time() + boost::posix_time::milliseconds(STOP_CHECK_INTERVAL_MS);
+
+			if (!state->control_queue->timed_receive(buffer.data(), state->message_size, received_size, priority, wait_time))
+			{
+				continue;
+			}
+
+			if (received_size != state->message_size)
+			{
+				printf("Received message size %d, but expecting size %d\n", (int)received_size, state->message_size);
+				fail(state, "Received control message has wrong size.");
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(state->mutex);
+				state->pending.push_back({ buffer, FrameStats::now_us() });
+			}
+			wake_up(state);
+
+			// nothing comes after the end message, so don't keep the slave waiting for us on shutdown.
+			if (((SLAVE_MESSAGE*)buffer.data())->message_type == MESSAGE_TYPE_END)
+			{
+				return;
+			}
+		}
+		catch (interprocess_exception &exception)
+		{
+			printf("Control message error: %s\n", exception.what());
+			fail(state, "Error receiving control message.");
+			return;
+		}
+	}
+}
+
+ControlListener::ControlListener(message_queue* control_queue, unsigned int message_size, FrameRing* frame_ring, message_queue* data_queue)
+{
+	state = new ControlListenerState();
+	state->control_queue = control_queue;
+	state->message_size = message_size;
+	state->frame_ring = frame_ring;
+	state->data_queue = data_queue;
+	state->stopped = false;
+	state->thread = std::thread(listen, state);
+}
+
+ControlListener::~ControlListener()
+{
+	state->stopped = true;
+	if (state->thread.joinable())
+	{
+		state->thread.join();
+	}
+	delete state;
+}
+
+bool ControlListener::next(unsigned char* message, uint64_t& received_at_us)
+{
+	std::lock_guard<std::mutex> lock(state->mutex);
+	if (state->pending.empty())
+	{
+		return false;
+	}
+	std::copy(state->pending.front().data.begin(), state->pending.front().data.end(), message);
+	received_at_us = state->pending.front().received_at_us;
+	state->pending.pop_front();
+	return true;
+}
+
+const char* ControlListener::error() const
+{
+	std::lock_guard<std::mutex> lock(state->mutex);
+	return state->error.empty() ? nullptr : state->error.c_str();
+}
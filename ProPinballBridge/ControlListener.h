@@ -0,0 +1,41 @@
+#pragma once
+#include "boost/interprocess/ipc/message_queue.hpp"
+#include "FrameRing.h"
+
+namespace ProPinballBridge
+{
+	struct ControlListenerState;
+
+	// Receives control messages from the master on a separate thread.
+	//
+	// The thread blocks on the master-to-slave queue, so nothing is polled.
+	// When a message arrives, it's queued and the frame loop is woken up,
+	// either by posting the frame ring's semaphore or by pushing an empty
+	// message into the data queue. This way, the frame loop only ever waits
+	// on one primitive but still reacts to control messages right away.
+	//
+	// Compiled natively, since managed code can't use std::thread.
+	class ControlListener
+	{
+		public:
+			ControlListener(boost::interprocess::message_queue* control_queue, unsigned int message_size,
+				FrameRing* frame_ring, boost::interprocess::message_queue* data_queue);
+
+			// Stops listening and waits for the thread to end.
+			~ControlListener();
+
+			// Copies the oldest pending control message into the buffer. Returns false if there is none.
+			// The time it was received is in FrameStats::now_us() time.
+			bool next(unsigned char* message, uint64_t& received_at_us);
+
+			// The error that made the listener stop, or null if it's still running.
+			const char* error() const;
+
+		private:
+			ControlListenerState* state;
+	};
+
+	// Messages in the data queue with this size are wake-ups from the control listener, not frames.
+	const unsigned int WAKE_UP_MESSAGE_SIZE = 0;
+	const unsigned int WAKE_UP_MESSAGE_PRIORITY = 1;
+}
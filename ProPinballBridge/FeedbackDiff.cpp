@@ -0,0 +1,101 @@
+#include "FeedbackDiff.h"
+#include <stddef.h>
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FEEDBACK_DIFF_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace ProPinballBridge;
+
+const unsigned int FIELD_COUNT = sizeof(FEEDBACK_MESSAGE_DATA) / sizeof(uint32_t);
+const unsigned int FIELDS_PER_VECTOR = 4;
+
+static_assert(FIELD_COUNT == MAX_FEEDBACK_EVENTS, "Feedback fields must all be 32 bits wide.");
+static_assert(FIELD_COUNT % FIELDS_PER_VECTOR == 0, "Feedback data must be a multiple of 16 bytes.");
+
+const unsigned int FIRST_SOLENOID = offsetof(FEEDBACK_MESSAGE_DATA, solenoid_on) / sizeof(uint32_t);
+const unsigned int FIRST_FLIPPER = offsetof(FEEDBACK_MESSAGE_DATA, flipper_solenoid_on) / sizeof(uint32_t);
+const unsigned int FIRST_BUTTON = offsetof(FEEDBACK_MESSAGE_DATA, button_lit) / sizeof(uint32_t);
+
+// returns a bit for every one of the four fields that differs.
+static unsigned int changed_fields(const uint32_t* current, const uint32_t* previous)
+{
+#if FEEDBACK_DIFF_SSE2
+	const __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)current), _mm_loadu_si128((const __m128i*)previous));
+	return ~_mm_movemask_ps(_mm_castsi128_ps(equal)) & 0xf;
+#else
+	unsigned int changed = 0;
+	for (unsigned int field = 0; field < FIELDS_PER_VECTOR; field++)
+	{
+		changed |= (current[field] != previous[field]) << field;
+	}
+	return changed;
+#endif
+}
+
+static void to_event(const FEEDBACK_MESSAGE_DATA* feedback_data, unsigned int field, FEEDBACK_EVENT& event)
+{
+	if (field < FIRST_SOLENOID)
+	{
+		event.kind = FEEDBACK_KIND_FLASHER;
+		event.id = field;
+		event.value = feedback_data->flasher_intensity[event.id];
+	}
+	else if (field < FIRST_FLIPPER)
+	{
+		event.kind = FEEDBACK_KIND_SOLENOID;
+		event.id = field - FIRST_SOLENOID;
+		event.value = feedback_data->solenoid_on[event.id] ? 1.0f : 0.0f;
+	}
+	else if (field < FIRST_BUTTON)
+	{
+		event.kind = FEEDBACK_KIND_FLIPPER;
+		event.id = field - FIRST_FLIPPER;
+		event.value = feedback_data->flipper_solenoid_on[event.id] ? 1.0f : 0.0f;
+	}
+	else
+	{
+		event.kind = FEEDBACK_KIND_BUTTON;
+		event.id = field - FIRST_BUTTON;
+		event.value = feedback_data->button_lit[event.id] ? 1.0f : 0.0f;
+	}
+}
+
+FeedbackDiff::FeedbackDiff()
+{
+	memset(&previous_feedback_data, 0, sizeof(previous_feedback_data));
+}
+
+unsigned int FeedbackDiff::diff(const FEEDBACK_MESSAGE_DATA* feedback_data, uint64_t timestamp_us, FEEDBACK_EVENT* events)
+{
+	// compared bitwise, so a flasher going from 0.0 to -0.0 counts as a change, which is harmless.
+	const uint32_t* current = (const uint32_t*)feedback_data;
+	const uint32_t* previous = (const uint32_t*)&previous_feedback_data;
+	unsigned int event_count = 0;
+
+	for (unsigned int first_field = 0; first_field < FIELD_COUNT; first_field += FIELDS_PER_VECTOR)
+	{
+		const unsigned int changed = changed_fields(current + first_field, previous + first_field);
+		if (!changed)
+		{
+			continue;
+		}
+		for (unsigned int field = 0; field < FIELDS_PER_VECTOR; field++)
+		{
+			if (changed & (1 << field))
+			{
+				FEEDBACK_EVENT& event = events[event_count++];
+				event.timestamp_us = timestamp_us;
+				to_event(feedback_data, first_field + field, event);
+			}
+		}
+	}
+
+	if (event_count)
+	{
+		previous_feedback_data = *feedback_data;
+	}
+	return event_count;
+}
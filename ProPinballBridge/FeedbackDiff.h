@@ -0,0 +1,45 @@
+#pragma once
+#include "ProPinballProtocol.h"
+
+namespace ProPinballBridge
+{
+	enum FEEDBACK_KIND
+	{
+		FEEDBACK_KIND_FLASHER,
+		FEEDBACK_KIND_SOLENOID,
+		FEEDBACK_KIND_FLIPPER,
+		FEEDBACK_KIND_BUTTON
+	};
+
+	// One field of FEEDBACK_MESSAGE_DATA that changed.
+	struct FEEDBACK_EVENT
+	{
+		uint64_t timestamp_us;
+		uint8_t kind;
+		uint8_t id;
+
+		// the flasher's intensity, or the new on/off state as 1 or 0
+		f32 value;
+	};
+
+	// Every field can change at once.
+	const unsigned int MAX_FEEDBACK_EVENTS = NUM_FLASHERS + NUM_SOLENOIDS + NUM_FLIPPERS + NUM_BUTTONS;
+
+	// Turns the full feedback state the master sends into events for the fields that changed.
+	//
+	// All fields are 32 bits wide, so the struct is compared four fields at
+	// a time with SSE2, and only changed fields are looked at individually.
+	// The previous state starts zeroed, so the first message reports
+	// everything that's on.
+	class FeedbackDiff
+	{
+		public:
+			FeedbackDiff();
+
+			// Writes up to MAX_FEEDBACK_EVENTS events and returns how many.
+			unsigned int diff(const FEEDBACK_MESSAGE_DATA* feedback_data, uint64_t timestamp_us, FEEDBACK_EVENT* events);
+
+		private:
+			FEEDBACK_MESSAGE_DATA previous_feedback_data;
+	};
+}
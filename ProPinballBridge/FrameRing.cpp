@@ -0,0 +1,219 @@
+#include "FrameRing.h"
+#include "FrameStats.h"
+#include "boost/interprocess/managed_shared_memory.hpp"
+#include "boost/interprocess/sync/interprocess_semaphore.hpp"
+#include "boost/date_time/posix_time/posix_time_types.hpp"
+#include <atomic>
+#include <string.h>
+#include <stdio.h>
+
+using namespace boost::interprocess;
+
+namespace ProPinballBridge
+{
+	const uint32_t FRAME_RING_MAGIC = 0x444d4452; // "DMDR"
+	const uint32_t FRAME_RING_VERSION = 2;
+
+	struct FRAME_RING_SLOT
+	{
+		std::atomic<uint64_t> sequence;
+		uint64_t published_at_us;
+		unsigned char data[DMD_FRAME_SIZE];
+	};
+
+	struct FRAME_RING_HEADER
+	{
+		FRAME_RING_HEADER(unsigned int slot_count) :
+			magic(FRAME_RING_MAGIC),
+			version(FRAME_RING_VERSION),
+			slot_count(slot_count),
+			frame_size(DMD_FRAME_SIZE),
+			write_sequence(0),
+			frame_written(0)
+		{
+		}
+
+		uint32_t magic;
+		uint32_t version;
+		uint32_t slot_count;
+		uint32_t frame_size;
+		std::atomic<uint64_t> write_sequence;
+		interprocess_semaphore frame_written;
+	};
+
+	struct FrameRingState
+	{
+		managed_shared_memory segment;
+		FRAME_RING_HEADER* header = nullptr;
+		FRAME_RING_SLOT* slots = nullptr;
+		uint64_t read_sequence = 0;
+		uint64_t dropped = 0;
+		uint64_t torn = 0;
+	};
+}
+
+using namespace ProPinballBridge;
+
+static size_t segment_size(unsigned int slot_count)
+{
+	// room for the segment's own bookkeeping and the named object index
+	return sizeof(FRAME_RING_HEADER) + slot_count * sizeof(FRAME_RING_SLOT) + 4096;
+}
+
+FrameRing* FrameRing::create(const char* name, unsigned int slot_count)
+{
+	FrameRingState* state = new FrameRingState();
+	try
+	{
+		shared_memory_object::remove(name);
+
+		state->segment = managed_shared_memory(create_only, name, segment_size(slot_count));
+		state->slots = state->segment.construct<FRAME_RING_SLOT>("slots")[slot_count]();
+		for (unsigned int slot_index = 0; slot_index < slot_count; slot_index++)
+		{
+			state->slots[slot_index].sequence.store(0, std::memory_order_relaxed);
+		}
+
+		// the header goes last, so a slave never sees a header without slots
+		state->header = state->segment.construct<FRAME_RING_HEADER>("header")(slot_count);
+		return new FrameRing(state);
+	}
+	catch (interprocess_exception &exception)
+	{
+		printf("+++ Failed to create frame ring '%s', error: '%s'\n", name, exception.what());
+		delete state;
+		return nullptr;
+	}
+}
+
+FrameRing* FrameRing::open(const char* name)
+{
+	FrameRingState* state = new FrameRingState();
+	try
+	{
+		state->segment = managed_shared_memory(open_only, name);
+		state->header = state->segment.find<FRAME_RING_HEADER>("header").first;
+		state->slots = state->segment.find<FRAME_RING_SLOT>("slots").first;
+
+		if (!state->header || !state->slots || state->header->magic != FRAME_RING_MAGIC || state->header->version != FRAME_RING_VERSION || state->header->frame_size != DMD_FRAME_SIZE)
+		{
+			printf("+++ Ignoring frame ring '%s', unknown layout.\n", name);
+			delete state;
+			return nullptr;
+		}
+
+		// start at the current frame, we're not interested in what was sent before we arrived
+		state->read_sequence = state->header->write_sequence.load(std::memory_order_acquire);
+		return new FrameRing(state);
+	}
+	catch (interprocess_exception&)
+	{
+		// the master doesn't provide a ring, which is fine.
+		delete state;
+		return nullptr;
+	}
+}
+
+void FrameRing::remove(const char* name)
+{
+	shared_memory_object::remove(name);
+}
+
+FrameRing::FrameRing(FrameRingState* state) : state(state)
+{
+}
+
+FrameRing::~FrameRing()
+{
+	delete state;
+}
+
+void FrameRing::publish(const unsigned char* frame)
+{
+	FRAME_RING_HEADER* header = state->header;
+	const uint64_t sequence = header->write_sequence.load(std::memory_order_relaxed) + 1;
+	FRAME_RING_SLOT& slot = state->slots[sequence % header->slot_count];
+
+	// mark the slot as being written, so a reader still looking at it knows it's gone
+	slot.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.published_at_us = FrameStats::now_us();
+	memcpy(slot.data, frame, DMD_FRAME_SIZE);
+	slot.sequence.store(sequence, std::memory_order_release);
+
+	header->write_sequence.store(sequence, std::memory_order_release);
+	header->frame_written.post();
+}
+
+bool FrameRing::wait_newest(unsigned int timeout_ms, const unsigned char*& frame, uint64_t& sequence)
+{
+	FRAME_RING_HEADER* header = state->header;
+	const boost::posix_time::ptime wait_time = boost::posix_time::microsec_clock::universal_time() + boost::posix_time::milliseconds(timeout_ms);
+
+	while (true)
+	{
+		const uint64_t newest_sequence = header->write_sequence.load(std::memory_order_acquire);
+		if (newest_sequence > state->read_sequence)
+		{
+			const FRAME_RING_SLOT& slot = state->slots[newest_sequence % header->slot_count];
+			if (slot.sequence.load(std::memory_order_acquire) != newest_sequence)
+			{
+				// the master is already writing the next frame into that slot, pick that one up instead.
+				continue;
+			}
+
+			// we only ever look at the newest frame, so drain the pending wake-ups of the skipped ones.
+			while (header->frame_written.try_wait())
+			{
+			}
+
+			state->dropped += newest_sequence - state->read_sequence - 1;
+			state->read_sequence = newest_sequence;
+			frame = slot.data;
+			sequence = newest_sequence;
+			return true;
+		}
+
+		if (!header->frame_written.timed_wait(wait_time))
+		{
+			return false;
+		}
+
+		// woken up without a new frame, so somebody else wants the reader's attention.
+		if (header->write_sequence.load(std::memory_order_acquire) <= state->read_sequence)
+		{
+			return false;
+		}
+	}
+}
+
+void FrameRing::wake_up()
+{
+	state->header->frame_written.post();
+}
+
+bool FrameRing::is_current(uint64_t sequence)
+{
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (state->slots[sequence % state->header->slot_count].sequence.load(std::memory_order_relaxed) == sequence)
+	{
+		return true;
+	}
+	state->torn++;
+	return false;
+}
+
+uint64_t FrameRing::published_at(uint64_t sequence) const
+{
+	return state->slots[sequence % state->header->slot_count].published_at_us;
+}
+
+uint64_t FrameRing::dropped() const
+{
+	return state->dropped;
+}
+
+uint64_t FrameRing::torn() const
+{
+	return state->torn;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <stdint.h>
+
+namespace ProPinballBridge
+{
+	const char* const DMD_DATA_RING_NAME = "dmd_dot_matrix_display_ring";
+	const unsigned int DMD_FRAME_SIZE = 128 * 32;
+	const unsigned int DEFAULT_RING_SLOT_COUNT = 8;
+
+	struct FrameRingState;
+
+	// A ring of DMD frames in shared memory.
+	//
+	// The master writes each frame into the next slot and bumps the ring's
+	// sequence number. The slave always reads the newest slot, so a frame gets
+	// from the master to the slave without going through a message queue. If
+	// the slave falls behind, older frames are skipped and counted as dropped.
+	//
+	// FrameRing.cpp is compiled natively (not with /clr), since the ring
+	// relies on std::atomic which isn't available to managed code.
+	class FrameRing
+	{
+		public:
+			// Creates the ring. Used by the master, or by the test harness emulating it.
+			static FrameRing* create(const char* name, unsigned int slot_count = DEFAULT_RING_SLOT_COUNT);
+
+			// Opens an existing ring. Returns null if the master didn't create one.
+			static FrameRing* open(const char* name);
+
+			// Removes the ring's shared memory segment.
+			static void remove(const char* name);
+
+			~FrameRing();
+
+			// Copies a frame into the next slot and wakes up the reader.
+			void publish(const unsigned char* frame);
+
+			// Waits until a newer frame than the last one read is available and returns a pointer to its slot.
+			// Returns false on timeout or when woken up through wake_up().
+			bool wait_newest(unsigned int timeout_ms, const unsigned char*& frame, uint64_t& sequence);
+
+			// Makes a pending wait_newest() return without a frame.
+			void wake_up();
+
+			// Returns false if the slot of the given frame was overwritten since it was read.
+			bool is_current(uint64_t sequence);
+
+			// When the master published the given frame, in FrameStats::now_us() time. Only valid as long as is_current() is.
+			uint64_t published_at(uint64_t sequence) const;
+
+			// Number of frames the reader skipped because newer ones were available.
+			uint64_t dropped() const;
+
+			// Number of frames that were overwritten while the reader was still using them.
+			uint64_t torn() const;
+
+		private:
+			FrameRing(FrameRingState* state);
+			FrameRingState* state;
+	};
+}
@@ -0,0 +1,197 @@
+#include "FrameStats.h"
+#include <atomic>
+#include <chrono>
+
+namespace ProPinballBridge
+{
+	// Log-linear buckets: values below 16 get their own bucket, everything
+	// above is split into 8 buckets per power of two, up to 2^32.
+	const unsigned int LINEAR_BUCKETS = 16;
+	const unsigned int SUB_BUCKET_BITS = 3;
+	const unsigned int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+	const unsigned int BUCKET_COUNT = LINEAR_BUCKETS + (32 - 4) * SUB_BUCKETS;
+
+	struct Histogram
+	{
+		std::atomic<uint64_t> buckets[BUCKET_COUNT];
+		std::atomic<uint64_t> count;
+		std::atomic<uint64_t> max;
+
+		Histogram() : count(0), max(0)
+		{
+			for (unsigned int i = 0; i < BUCKET_COUNT; i++)
+			{
+				buckets[i].store(0, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	struct FrameStatsState
+	{
+		uint64_t created_at;
+		std::atomic<uint64_t> frames;
+		std::atomic<uint64_t> wakeups;
+		std::atomic<uint64_t> dropped;
+		std::atomic<uint64_t> torn;
+		std::atomic<uint64_t> last_frame_at;
+
+		Histogram interval_us;
+		Histogram callback_us;
+		Histogram age_us;
+		Histogram queue_depth;
+		Histogram frames_per_wakeup;
+	};
+}
+
+using namespace ProPinballBridge;
+
+static unsigned int bucket_index(uint64_t value)
+{
+	if (value < LINEAR_BUCKETS)
+	{
+		return (unsigned int)value;
+	}
+	if (value >= (1ull << 32))
+	{
+		return BUCKET_COUNT - 1;
+	}
+	unsigned int msb = 4;
+	while ((value >> (msb + 1)) != 0)
+	{
+		msb++;
+	}
+	const unsigned int shift = msb - SUB_BUCKET_BITS;
+	return LINEAR_BUCKETS + (msb - 4) * SUB_BUCKETS + (unsigned int)((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+static uint64_t bucket_upper_bound(unsigned int index)
+{
+	if (index < LINEAR_BUCKETS)
+	{
+		return index;
+	}
+	const unsigned int msb = (index - LINEAR_BUCKETS) / SUB_BUCKETS + 4;
+	const unsigned int sub_bucket = (index - LINEAR_BUCKETS) % SUB_BUCKETS;
+	const unsigned int shift = msb - SUB_BUCKET_BITS;
+	return ((uint64_t)(SUB_BUCKETS + sub_bucket + 1) << shift) - 1;
+}
+
+// there's only one writer, so a load followed by a store is enough and saves the locked instruction.
+static void increment(std::atomic<uint64_t>& counter, uint64_t value = 1)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+static void record(Histogram& histogram, uint64_t value)
+{
+	increment(histogram.buckets[bucket_index(value)]);
+	increment(histogram.count);
+	if (value > histogram.max.load(std::memory_order_relaxed))
+	{
+		histogram.max.store(value, std::memory_order_relaxed);
+	}
+}
+
+static uint64_t percentile(const uint64_t* buckets, uint64_t count, uint64_t max, unsigned int percent)
+{
+	// the rank of the requested percentile, rounded up so p99 of 100 values is the 99th one.
+	const uint64_t rank = (count * percent + 99) / 100;
+	uint64_t seen = 0;
+	for (unsigned int i = 0; i < BUCKET_COUNT; i++)
+	{
+		seen += buckets[i];
+		if (seen >= rank && seen > 0)
+		{
+			const uint64_t upper_bound = bucket_upper_bound(i);
+			return upper_bound < max ? upper_bound : max;
+		}
+	}
+	return max;
+}
+
+static void summarize(const Histogram& histogram, FRAME_STATS_PERCENTILES& percentiles)
+{
+	// copy first, so both percentiles are computed from the same counts.
+	uint64_t buckets[BUCKET_COUNT];
+	uint64_t count = 0;
+	for (unsigned int i = 0; i < BUCKET_COUNT; i++)
+	{
+		buckets[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+		count += buckets[i];
+	}
+	percentiles.count = count;
+	percentiles.max = histogram.max.load(std::memory_order_relaxed);
+	percentiles.p50 = count ? percentile(buckets, count, percentiles.max, 50) : 0;
+	percentiles.p99 = count ? percentile(buckets, count, percentiles.max, 99) : 0;
+}
+
+FrameStats::FrameStats()
+{
+	state = new FrameStatsState();
+	state->created_at = now_us();
+	state->frames = 0;
+	state->wakeups = 0;
+	state->dropped = 0;
+	state->torn = 0;
+	state->last_frame_at = 0;
+}
+
+FrameStats::~FrameStats()
+{
+	delete state;
+}
+
+uint64_t FrameStats::now_us()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FrameStats::frame_received(uint64_t received_at_us, uint64_t age_us, uint64_t queue_depth)
+{
+	const uint64_t last_frame_at = state->last_frame_at.load(std::memory_order_relaxed);
+	if (last_frame_at)
+	{
+		record(state->interval_us, received_at_us - last_frame_at);
+	}
+	if (age_us != FRAME_AGE_UNKNOWN)
+	{
+		record(state->age_us, age_us);
+	}
+	record(state->queue_depth, queue_depth);
+	increment(state->frames);
+	state->last_frame_at.store(received_at_us, std::memory_order_relaxed);
+}
+
+void FrameStats::woke_up(uint64_t frames, uint64_t dropped)
+{
+	increment(state->wakeups);
+	increment(state->dropped, dropped);
+	record(state->frames_per_wakeup, frames);
+}
+
+void FrameStats::callback_finished(uint64_t received_at_us)
+{
+	record(state->callback_us, now_us() - received_at_us);
+}
+
+void FrameStats::frame_torn()
+{
+	increment(state->torn);
+}
+
+void FrameStats::snapshot(FRAME_STATS_SNAPSHOT& snapshot) const
+{
+	snapshot.frames = state->frames.load(std::memory_order_relaxed);
+	snapshot.wakeups = state->wakeups.load(std::memory_order_relaxed);
+	snapshot.dropped = state->dropped.load(std::memory_order_relaxed);
+	snapshot.torn = state->torn.load(std::memory_order_relaxed);
+
+	const uint64_t last_frame_at = state->last_frame_at.load(std::memory_order_relaxed);
+	snapshot.idle_us = now_us() - (last_frame_at ? last_frame_at : state->created_at);
+
+	summarize(state->interval_us, snapshot.interval_us);
+	summarize(state->callback_us, snapshot.callback_us);
+	summarize(state->age_us, snapshot.age_us);
+	summarize(state->queue_depth, snapshot.queue_depth);
+	summarize(state->frames_per_wakeup, snapshot.frames_per_wakeup);
+}
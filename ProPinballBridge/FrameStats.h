@@ -0,0 +1,68 @@
+#pragma once
+#include <stdint.h>
+
+namespace ProPinballBridge
+{
+	struct FrameStatsState;
+
+	// Passed as the age of frames whose publish time isn't known.
+	const uint64_t FRAME_AGE_UNKNOWN = UINT64_MAX;
+
+	// Percentiles of a histogram. Values are the upper bound of the bucket, so they're off by up to 12.5%.
+	struct FRAME_STATS_PERCENTILES
+	{
+		uint64_t count;
+		uint64_t p50;
+		uint64_t p99;
+		uint64_t max;
+	};
+
+	struct FRAME_STATS_SNAPSHOT
+	{
+		uint64_t frames;
+		uint64_t wakeups;
+		uint64_t dropped;
+		uint64_t torn;
+
+		// microseconds since the last frame was received, or since the stats were created
+		uint64_t idle_us;
+
+		FRAME_STATS_PERCENTILES interval_us;
+		FRAME_STATS_PERCENTILES callback_us;
+		FRAME_STATS_PERCENTILES age_us;
+		FRAME_STATS_PERCENTILES queue_depth;
+		FRAME_STATS_PERCENTILES frames_per_wakeup;
+	};
+
+	// Timing and drop counters of the frame loop.
+	//
+	// Only the frame loop writes, anybody can read. Counters and histogram
+	// buckets are relaxed atomics, so a snapshot may mix values of two
+	// consecutive frames, but it never blocks the frame loop.
+	//
+	// Compiled natively, since managed code can't use std::atomic.
+	class FrameStats
+	{
+		public:
+			FrameStats();
+			~FrameStats();
+
+			// Monotonic microseconds, comparable between processes on the same machine.
+			static uint64_t now_us();
+
+			// A frame was taken from the transport. The queue depth includes the frame itself.
+			void frame_received(uint64_t received_at_us, uint64_t age_us, uint64_t queue_depth);
+
+			// The frame loop woke up and handed this many frames to the callback.
+			void woke_up(uint64_t frames, uint64_t dropped);
+
+			void callback_finished(uint64_t received_at_us);
+
+			void frame_torn();
+
+			void snapshot(FRAME_STATS_SNAPSHOT& snapshot) const;
+
+		private:
+			FrameStatsState* state;
+	};
+}
@@ -1,105 +1,35 @@
 #include "stdafx.h"
 #include "ProPinballBridge.h"
+#include "ProPinballProtocol.h"
+#include "ControlListener.h"
 #include "boost/interprocess/ipc/message_queue.hpp"
 #include <stdio.h>
 
 using namespace boost::interprocess;
+using namespace ProPinballBridge;
 
-typedef int32_t s32;
-typedef float f32;
+// Frames and control messages wake up the frame loop, so this only bounds how long a lost wake-up can stall it.
+const unsigned int FRAME_WAIT_TIMEOUT_MS = 5000;
 
-enum MESSAGE_TYPE
-{
-	MESSAGE_TYPE_SLAVE_READY,
-	MESSAGE_TYPE_END,
-	MESSAGE_TYPE_FEEDBACK
-};
-
-enum SOLENOID_ID
-{
-	SO_PLUNGER = 0,
-	SO_TROUGH_EJECT,
-	SO_KNOCKER,
-	SO_LEFT_SLINGSHOT,
-	SO_RIGHT_SLINGSHOT,
-	SO_LEFT_JET,
-	SO_RIGHT_JET,
-	SO_BOTTOM_JET,
-	SO_LEFT_DROPS_UP,
-	SO_RIGHT_DROPS_UP,
-	SO_LOCK_RELEASE_1,
-	SO_LOCK_RELEASE_2,
-	SO_LOCK_RELEASE_3,
-	SO_LOCK_RELEASE_A,
-	SO_LOCK_RELEASE_B,
-	SO_LOCK_RELEASE_C,
-	SO_LOCK_RELEASE_D,
-	SO_MIDDLE_EJECT,
-	SO_TOP_EJECT_STRONG,
-	SO_TOP_EJECT_WEAK,
-	SO_MIDDLE_RAMP_DOWN,
-	SO_HIGH_DIVERTOR,
-	SO_LOW_DIVERTOR,
-	SO_SCOOP_RETRACT,
-	SO_MAGNO_SAVE,
-	SO_MAGNO_LOCK,
-	NUM_SOLENOIDS
-};
-
-enum FLASHER_ID
-{
-	FL_LEFT_RETURN_LANE = 0,
-	FL_RIGHT_RETURN_LANE,
-	FL_TIME_MACHINE,
-	FL_LOCK_ALPHA,
-	FL_LOCK_BETA,
-	FL_LOCK_GAMMA,
-	FL_LOCK_DELTA,
-	FL_CRYSTAL,
-	NUM_FLASHERS
-};
-
-enum FLIPPER_ID
-{
-	FLIP_LOW_LEFT = 0,
-	FLIP_LOW_RIGHT,
-	FLIP_HIGH_RIGHT,
-	NUM_FLIPPERS
-};
-
-enum BUTTON_ID
-{
-	BUTTON_ID_START,
-	BUTTON_ID_FIRE,
-	BUTTON_ID_MAGNOSAVE,
-	NUM_BUTTONS
-};
-
-struct FEEDBACK_MESSAGE_DATA
+ProPinballBridge::ProPinballDmd::ProPinballDmd(unsigned int message_size)
 {
-	f32 flasher_intensity[NUM_FLASHERS];
-	s32 solenoid_on[NUM_SOLENOIDS];
-	s32 flipper_solenoid_on[NUM_FLIPPERS];
-	s32 button_lit[NUM_BUTTONS];
-};
+	// masters that support it hand frames over through shared memory, the others through the message queue.
+	dmd_data_frame_ring = FrameRing::open(DMD_DATA_RING_NAME);
+	dmd_data_message_queue = nullptr;
+	SharedMemory = dmd_data_frame_ring != nullptr;
+	frame_stats = new FrameStats();
+	feedback_diff = new FeedbackDiff();
+	feedback_events = new FEEDBACK_EVENT[MAX_FEEDBACK_EVENTS];
+	dot_matrix_data_message_buffer = nullptr;
+	current_sequence = 0;
+	current_frame_torn = false;
 
-struct SLAVE_MESSAGE
-{
-	s32 message_type;
-	union
+	if (!SharedMemory)
 	{
-		FEEDBACK_MESSAGE_DATA feedback_message_data;
-	} message_data;
-};
-
-const int DEFAULT_MESSAGE_PRIORITY = 0;
-
-
-ProPinballBridge::ProPinballDmd::ProPinballDmd(unsigned int message_size)
-{
-	const char* DMD_DATA_QUEUE_NAME = "dmd_dot_matrix_display_data";
-	dmd_data_message_queue = open_message_queue(DMD_DATA_QUEUE_NAME);
-	dot_matrix_data_message_buffer = new unsigned char[128*32];
+		const char* DMD_DATA_QUEUE_NAME = "dmd_dot_matrix_display_data";
+		dmd_data_message_queue = open_message_queue(DMD_DATA_QUEUE_NAME);
+		dot_matrix_data_message_buffer = new unsigned char[DMD_FRAME_SIZE];
+	}
 
 	const char* MASTER_TO_SLAVE_QUEUE_NAME = "dmd_master_to_slave";
 	master_to_slave_message_queue = open_message_queue(MASTER_TO_SLAVE_QUEUE_NAME);
@@ -133,111 +63,237 @@ void ProPinballBridge::ProPinballDmd::Release()
 	delete this;
 }
 
+ProPinballBridge::ProPinballDmd::~ProPinballDmd()
+{
+	this->!ProPinballDmd();
+}
+
+ProPinballBridge::ProPinballDmd::!ProPinballDmd()
+{
+	// runs once through Release() or the finalizer, whichever comes first, so everything is nulled.
+	delete dmd_data_frame_ring;
+	delete dmd_data_message_queue;
+	delete master_to_slave_message_queue;
+	delete slave_to_master_message_queue;
+	delete frame_stats;
+	delete feedback_diff;
+	delete[] feedback_events;
+	delete[] dot_matrix_data_message_buffer;
+	delete[] general_message_buffer;
+	dmd_data_frame_ring = nullptr;
+	dmd_data_message_queue = nullptr;
+	master_to_slave_message_queue = nullptr;
+	slave_to_master_message_queue = nullptr;
+	frame_stats = nullptr;
+	feedback_diff = nullptr;
+	feedback_events = nullptr;
+	dot_matrix_data_message_buffer = nullptr;
+	general_message_buffer = nullptr;
+}
+
+static FramePercentiles to_percentiles(const FRAME_STATS_PERCENTILES& percentiles)
+{
+	FramePercentiles result;
+	result.Count = percentiles.count;
+	result.P50 = percentiles.p50;
+	result.P99 = percentiles.p99;
+	result.Max = percentiles.max;
+	return result;
+}
+
+FrameStatistics ProPinballBridge::ProPinballDmd::GetStatistics()
+{
+	FRAME_STATS_SNAPSHOT snapshot;
+	frame_stats->snapshot(snapshot);
+
+	FrameStatistics statistics;
+	statistics.Frames = snapshot.frames;
+	statistics.Wakeups = snapshot.wakeups;
+	statistics.Dropped = snapshot.dropped;
+	statistics.Torn = snapshot.torn;
+	statistics.IdleMicroseconds = snapshot.idle_us;
+	statistics.Interval = to_percentiles(snapshot.interval_us);
+	statistics.Callback = to_percentiles(snapshot.callback_us);
+	statistics.Age = to_percentiles(snapshot.age_us);
+	statistics.QueueDepth = to_percentiles(snapshot.queue_depth);
+	statistics.FramesPerWakeup = to_percentiles(snapshot.frames_per_wakeup);
+	return statistics;
+}
+
+bool ProPinballBridge::ProPinballDmd::FrameIsCurrent()
+{
+	if (dmd_data_frame_ring && !dmd_data_frame_ring->is_current(current_sequence))
+	{
+		current_frame_torn = true;
+	}
+	return !current_frame_torn;
+}
+
 void ProPinballBridge::ProPinballDmd::GetFrames(OnNext^ onNext, OnError^ onError, OnCompleted^ onCompleted)
+{
+	GetFrames(onNext, onError, onCompleted, nullptr);
+}
+
+void ProPinballBridge::ProPinballDmd::GetFrames(OnNext^ onNext, OnError^ onError, OnCompleted^ onCompleted, OnFeedback^ onFeedback)
 {
 	bool done = false;
 
+	// control messages are received on their own thread, which wakes us up when one arrives.
+	ControlListener* control_listener = master_to_slave_message_queue
+		? new ControlListener(master_to_slave_message_queue, general_message_buffer_size, dmd_data_frame_ring, dmd_data_message_queue)
+		: nullptr;
+
 	while (!done)
 	{
-		if (dmd_data_message_queue)
+		if (dmd_data_frame_ring)
 		{
-			bool received_message = false;
-			do
-			{
-				try
-				{
-					unsigned int priority;
-					message_queue::size_type received_size;
-
-					const boost::posix_time::ptime wait_time = microsec_clock::universal_time() + boost::posix_time::milliseconds(500);
-
-					received_message = dmd_data_message_queue->timed_receive(dot_matrix_data_message_buffer,
-						128 * 32,
-						received_size,
-						priority,
-						wait_time);
-
-					if (received_message)
-					{
-						if (received_size == 128 * 32)
-						{
-							onNext(dot_matrix_data_message_buffer);
-						}
-						else
-						{
-							onError("Received DMD data has wrong size.");
-							received_message = false;
-							done = true;
-						}
-					}
-
-				}
-				catch (interprocess_exception &exception)
-				{
-					onError(exception.what());
-					done = true;
-				}
-			} while (received_message);
+			GetFramesFromRing(onNext);
 		}
 		else
 		{
-			onError("Invalid message queue.");
+			GetFramesFromQueue(onNext, onError, done);
+		}
+
+		if (control_listener && !done)
+		{
+			HandleControlMessages(control_listener, onError, onCompleted, onFeedback, done);
+		}
+	}
+
+	delete control_listener;
+}
+
+void ProPinballBridge::ProPinballDmd::HandleControlMessages(ControlListener* control_listener, OnError^ onError, OnCompleted^ onCompleted, OnFeedback^ onFeedback, bool& done)
+{
+	SLAVE_MESSAGE* message = (SLAVE_MESSAGE*)general_message_buffer;
+	uint64_t received_at;
+
+	while (!done && control_listener->next(general_message_buffer, received_at))
+	{
+		if (message->message_type == MESSAGE_TYPE_END)
+		{
+			onCompleted();
 			done = true;
 		}
+		else if (message->message_type == MESSAGE_TYPE_FEEDBACK && onFeedback)
+		{
+			HandleFeedback(&(message->message_data.feedback_message_data), received_at, onFeedback);
+		}
+	}
+
+	const char* error = control_listener->error();
+	if (!done && error)
+	{
+		onError(error);
+		done = true;
+	}
+}
+
+void ProPinballBridge::ProPinballDmd::HandleFeedback(const FEEDBACK_MESSAGE_DATA* feedback_data, uint64_t received_at_us, OnFeedback^ onFeedback)
+{
+	// the master sends its whole state every time, so only pass on what actually changed.
+	const unsigned int event_count = feedback_diff->diff(feedback_data, received_at_us, feedback_events);
+
+	for (unsigned int event_index = 0; event_index < event_count; event_index++)
+	{
+		FeedbackEvent feedback;
+		feedback.Timestamp = feedback_events[event_index].timestamp_us;
+		feedback.Kind = (FeedbackKind)feedback_events[event_index].kind;
+		feedback.Id = feedback_events[event_index].id;
+		feedback.Value = feedback_events[event_index].value;
+		onFeedback(feedback);
+	}
+}
+
+void ProPinballBridge::ProPinballDmd::GetFramesFromRing(OnNext^ onNext)
+{
+	const unsigned char* frame;
+	uint64_t sequence;
+	const uint64_t dropped = dmd_data_frame_ring->dropped();
+
+	// the callback gets the slot itself, copies it out and then checks FrameIsCurrent(). if the
+	// master lapped the ring during the copy, the copy is a mix of two frames, and is dropped
+	// by the callback and counted as torn here.
+	if (dmd_data_frame_ring->wait_newest(FRAME_WAIT_TIMEOUT_MS, frame, sequence))
+	{
+		const uint64_t received_at = FrameStats::now_us();
+		const uint64_t published_at = dmd_data_frame_ring->published_at(sequence);
+		const uint64_t skipped = dmd_data_frame_ring->dropped() - dropped;
+
+		current_sequence = sequence;
+		current_frame_torn = false;
+		onNext(const_cast<unsigned char*>(frame));
+
+		if (current_frame_torn)
+		{
+			frame_stats->woke_up(0, skipped);
+			frame_stats->frame_torn();
+			return;
+		}
 
-		if (master_to_slave_message_queue)
+		frame_stats->woke_up(1, skipped);
+		frame_stats->frame_received(received_at, received_at > published_at ? received_at - published_at : 0, skipped + 1);
+		frame_stats->callback_finished(received_at);
+	}
+}
+
+void ProPinballBridge::ProPinballDmd::GetFramesFromQueue(OnNext^ onNext, OnError^ onError, bool& done)
+{
+	if (dmd_data_message_queue)
+	{
+		try
 		{
-			SLAVE_MESSAGE* message = (SLAVE_MESSAGE*)general_message_buffer;
-			bool received_message = false;
+			unsigned int priority;
+			message_queue::size_type received_size;
+			uint64_t frames = 0;
+
+			const boost::posix_time::ptime wait_time = microsec_clock::universal_time() + boost::posix_time::milliseconds(FRAME_WAIT_TIMEOUT_MS);
 
-			do
+			bool received_message = dmd_data_message_queue->timed_receive(dot_matrix_data_message_buffer,
+				DMD_FRAME_SIZE,
+				received_size,
+				priority,
+				wait_time);
+
+			// hand over what queued up while we were busy, unless it's the control listener waking us up.
+			while (received_message && received_size != WAKE_UP_MESSAGE_SIZE)
 			{
-				try
-				{
-					unsigned int priority;
-					message_queue::size_type received_size;
-
-					received_message = master_to_slave_message_queue->try_receive(general_message_buffer,
-																									  general_message_buffer_size,
-																									  received_size,
-																									  priority);
-					if (received_message)
-					{
-						if (received_size == general_message_buffer_size)
-						{
-							if (message->message_type == MESSAGE_TYPE_END)
-							{
-								onCompleted();
-								done = true;
-							}
-							/*
-							else if (message->message_type == MESSAGE_TYPE_FEEDBACK)
-							{
-								printf("Ignoring feedback message."); // handle_feedback(&(message->message_data.feedback_message_data));
-							}
-							else
-							{
-								printf("Received message %d\n", message->message_type);
-							}*/
-						}
-						else
-						{
-							printf("Received message size %d, but expecting size %d\n", (int)received_size, general_message_buffer_size);
-							onError("Received DMD data has wrong size.");
-							received_message = false;
-							done = true;
-						}
-					}
-				}
-				catch (interprocess_exception &exception)
+				if (received_size != DMD_FRAME_SIZE)
 				{
-					onError("Error receiving control message.");
-					printf("Control message error: %s\n", exception.what());
+					onError("Received DMD data has wrong size.");
 					done = true;
-					received_message = false;
+					break;
 				}
-			} while (received_message);
+
+				const uint64_t received_at = FrameStats::now_us();
+				frame_stats->frame_received(received_at, FRAME_AGE_UNKNOWN, dmd_data_message_queue->get_num_msg() + 1);
+
+				onNext(dot_matrix_data_message_buffer);
+
+				frame_stats->callback_finished(received_at);
+				frames++;
+
+				received_message = dmd_data_message_queue->try_receive(dot_matrix_data_message_buffer,
+					DMD_FRAME_SIZE,
+					received_size,
+					priority);
+			}
+
+			if (frames)
+			{
+				frame_stats->woke_up(frames, 0);
+			}
 		}
+		catch (interprocess_exception &exception)
+		{
+			onError(exception.what());
+			done = true;
+		}
+	}
+	else
+	{
+		onError("Invalid message queue.");
+		done = true;
 	}
 }
 
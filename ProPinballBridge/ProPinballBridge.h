@@ -1,29 +1,118 @@
 #pragma once
 #include "boost/interprocess/ipc/message_queue.hpp"
+#include "FrameRing.h"
+#include "ControlListener.h"
+#include "FrameStats.h"
+#include "FeedbackDiff.h"
 
 namespace ProPinballBridge
 {
+	// With shared memory, frame points into the master's ring, so it must be copied out and
+	// only used if FrameIsCurrent() returns true afterwards.
 	public delegate void OnNext(unsigned char* frame);
 	public delegate void OnError(const char* message);
 	public delegate void OnCompleted();
 
+	public enum class FeedbackKind
+	{
+		Flasher = FEEDBACK_KIND_FLASHER,
+		Solenoid = FEEDBACK_KIND_SOLENOID,
+		Flipper = FEEDBACK_KIND_FLIPPER,
+		Button = FEEDBACK_KIND_BUTTON
+	};
+
+	// A flasher, solenoid, flipper or button light that changed state.
+	public value struct FeedbackEvent
+	{
+		// When the bridge received the change, in microseconds. Same clock as the statistics.
+		unsigned long long Timestamp;
+		FeedbackKind Kind;
+
+		// Index into the game's FLASHER_ID, SOLENOID_ID, FLIPPER_ID or BUTTON_ID enum.
+		int Id;
+
+		// The flasher's intensity, or 1 for on and 0 for off.
+		float Value;
+	};
+
+	public delegate void OnFeedback(FeedbackEvent feedback);
+
+	// Percentiles of one of the frame loop's histograms, see FrameStats.h.
+	public value struct FramePercentiles
+	{
+		unsigned long long Count;
+		unsigned long long P50;
+		unsigned long long P99;
+		unsigned long long Max;
+	};
+
+	// What the frame loop measured so far. Times are in microseconds.
+	public value struct FrameStatistics
+	{
+		unsigned long long Frames;
+		unsigned long long Wakeups;
+		unsigned long long Dropped;
+		unsigned long long Torn;
+		unsigned long long IdleMicroseconds;
+
+		// Time between two received frames.
+		FramePercentiles Interval;
+
+		// Time spent in OnNext.
+		FramePercentiles Callback;
+
+		// Time between the master publishing a frame and the bridge receiving it. Only known for shared memory.
+		FramePercentiles Age;
+
+		// Frames waiting when a frame was received, including the frame itself.
+		FramePercentiles QueueDepth;
+
+		// Frames handed to OnNext per wake-up of the frame loop.
+		FramePercentiles FramesPerWakeup;
+	};
+
 	public ref class ProPinballDmd
 	{
 		public:
 			ProPinballDmd(unsigned int message_size);
+			~ProPinballDmd();
+			!ProPinballDmd();
 
 			void GetFrames(OnNext^ onNext, OnError^ onError, OnCompleted^ onCompleted);
+
+			// Same as above, but also reports every change of the playfield feedback the master sends.
+			void GetFrames(OnNext^ onNext, OnError^ onError, OnCompleted^ onCompleted, OnFeedback^ onFeedback);
 			void Release();
 
+			// Can be called from any thread while GetFrames is running.
+			FrameStatistics GetStatistics();
+
+			// Called from OnNext after copying the frame. False if the master overwrote it meanwhile, so the copy must be dropped.
+			bool FrameIsCurrent();
+
 			int Status;
 			const char* Error;
 
+			// True if the master provides frames through the shared memory ring instead of the message queue.
+			bool SharedMemory;
+
 		private:
+			void GetFramesFromRing(OnNext^ onNext);
+			void GetFramesFromQueue(OnNext^ onNext, OnError^ onError, bool& done);
+			void HandleControlMessages(ProPinballBridge::ControlListener* control_listener, OnError^ onError, OnCompleted^ onCompleted, OnFeedback^ onFeedback, bool& done);
+			void HandleFeedback(const FEEDBACK_MESSAGE_DATA* feedback_data, uint64_t received_at_us, OnFeedback^ onFeedback);
+
+			ProPinballBridge::FrameRing* dmd_data_frame_ring;
+			ProPinballBridge::FrameStats* frame_stats;
+			ProPinballBridge::FeedbackDiff* feedback_diff;
+			ProPinballBridge::FEEDBACK_EVENT* feedback_events;
 			boost::interprocess::message_queue* dmd_data_message_queue;
 			boost::interprocess::message_queue* master_to_slave_message_queue;
 			boost::interprocess::message_queue* slave_to_master_message_queue;
 			boost::interprocess::message_queue* open_message_queue(const std::string& message_queue_name);
 			unsigned char* dot_matrix_data_message_buffer;
+			uint64_t current_sequence;
+			bool current_frame_torn;
 			unsigned char* general_message_buffer;
 			unsigned int general_message_buffer_size;
 		};
@@ -0,0 +1,93 @@
+#pragma once
+#include <stdint.h>
+
+// Message layout shared between Pro Pinball (the master) and its slaves.
+
+typedef int32_t s32;
+typedef float f32;
+
+enum MESSAGE_TYPE
+{
+	MESSAGE_TYPE_SLAVE_READY,
+	MESSAGE_TYPE_END,
+	MESSAGE_TYPE_FEEDBACK
+};
+
+enum SOLENOID_ID
+{
+	SO_PLUNGER = 0,
+	SO_TROUGH_EJECT,
+	SO_KNOCKER,
+	SO_LEFT_SLINGSHOT,
+	SO_RIGHT_SLINGSHOT,
+	SO_LEFT_JET,
+	SO_RIGHT_JET,
+	SO_BOTTOM_JET,
+	SO_LEFT_DROPS_UP,
+	SO_RIGHT_DROPS_UP,
+	SO_LOCK_RELEASE_1,
+	SO_LOCK_RELEASE_2,
+	SO_LOCK_RELEASE_3,
+	SO_LOCK_RELEASE_A,
+	SO_LOCK_RELEASE_B,
+	SO_LOCK_RELEASE_C,
+	SO_LOCK_RELEASE_D,
+	SO_MIDDLE_EJECT,
+	SO_TOP_EJECT_STRONG,
+	SO_TOP_EJECT_WEAK,
+	SO_MIDDLE_RAMP_DOWN,
+	SO_HIGH_DIVERTOR,
+	SO_LOW_DIVERTOR,
+	SO_SCOOP_RETRACT,
+	SO_MAGNO_SAVE,
+	SO_MAGNO_LOCK,
+	NUM_SOLENOIDS
+};
+
+enum FLASHER_ID
+{
+	FL_LEFT_RETURN_LANE = 0,
+	FL_RIGHT_RETURN_LANE,
+	FL_TIME_MACHINE,
+	FL_LOCK_ALPHA,
+	FL_LOCK_BETA,
+	FL_LOCK_GAMMA,
+	FL_LOCK_DELTA,
+	FL_CRYSTAL,
+	NUM_FLASHERS
+};
+
+enum FLIPPER_ID
+{
+	FLIP_LOW_LEFT = 0,
+	FLIP_LOW_RIGHT,
+	FLIP_HIGH_RIGHT,
+	NUM_FLIPPERS
+};
+
+enum BUTTON_ID
+{
+	BUTTON_ID_START,
+	BUTTON_ID_FIRE,
+	BUTTON_ID_MAGNOSAVE,
+	NUM_BUTTONS
+};
+
+struct FEEDBACK_MESSAGE_DATA
+{
+	f32 flasher_intensity[NUM_FLASHERS];
+	s32 solenoid_on[NUM_SOLENOIDS];
+	s32 flipper_solenoid_on[NUM_FLIPPERS];
+	s32 button_lit[NUM_BUTTONS];
+};
+
+struct SLAVE_MESSAGE
+{
+	s32 message_type;
+	union
+	{
+		FEEDBACK_MESSAGE_DATA feedback_message_data;
+	} message_data;
+};
+
+const int DEFAULT_MESSAGE_PRIORITY = 0;
@@ -0,0 +1,529 @@
+#include "boost/interprocess/ipc/message_queue.hpp"
+#include "boost/date_time/posix_time/posix_time_types.hpp"
+#include "../ProPinballBridge/ProPinballProtocol.h"
+#include "../ProPinballBridge/ControlListener.h"
+#include "../ProPinballBridge/FeedbackDiff.h"
+#include "../ProPinballBridge/FrameRing.h"
+#include "../ProPinballBridge/FrameStats.h"
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Emulates Pro Pinball (the master) so the bridge's transport can be tested
+// without the game. See README.md for usage.
+
+using namespace boost::interprocess;
+using namespace ProPinballBridge;
+
+#define LOG printf
+
+const char* DMD_DATA_QUEUE_NAME = "dmd_dot_matrix_display_data";
+const char* MASTER_TO_SLAVE_QUEUE_NAME = "dmd_master_to_slave";
+const char* SLAVE_TO_MASTER_QUEUE_NAME = "dmd_slave_to_master";
+
+const unsigned int DATA_QUEUE_CAPACITY = 64;
+const unsigned int CONTROL_QUEUE_CAPACITY = 64;
+
+// frames carry their sequence number and send time, so the slave can measure latency and gaps.
+struct FRAME_STAMP
+{
+	uint64_t sequence;
+	uint64_t sent_at_us;
+};
+
+struct OPTIONS
+{
+	unsigned int frame_rate = 60;
+	unsigned int feedback_rate = 0;
+	unsigned int duration_s = 10;
+	unsigned int burst_percent = 0;
+	unsigned int burst_size = 8;
+	unsigned int message_size = 392;
+	unsigned int ready_timeout_s = 30;
+	unsigned int seed = 1;
+	bool ring = false;
+	bool slave = false;
+	bool bench = false;
+};
+
+struct MASTER_REPORT
+{
+	uint64_t frames_sent = 0;
+	uint64_t frames_dropped = 0;
+	uint64_t feedback_sent = 0;
+	uint64_t feedback_dropped = 0;
+	double elapsed_s = 0;
+};
+
+struct SLAVE_REPORT
+{
+	bool ok = false;
+	uint64_t gaps = 0;
+	uint64_t feedback_events = 0;
+	FRAME_STATS_SNAPSHOT stats;
+};
+
+static void print_usage()
+{
+	LOG("Usage: ProPinballMaster [options]\n");
+	LOG("  --frames <hz>       frames per second (default 60)\n");
+	LOG("  --feedback <hz>     feedback messages per second (default 0)\n");
+	LOG("  --duration <s>      how long to send (default 10)\n");
+	LOG("  --burst <percent>   chance per frame of sending a burst (default 0)\n");
+	LOG("  --burst-size <n>    frames per burst (default 8)\n");
+	LOG("  --message-size <n>  control message size, same as Pro Pinball's m<n> (default 392)\n");
+	LOG("  --ring              send frames through the shared memory ring instead of the queue\n");
+	LOG("  --seed <n>          seed for bursts and feedback changes (default 1)\n");
+	LOG("  --slave             act as a slave instead, receiving like the bridge does\n");
+	LOG("  --bench             run master and slave at increasing rates and print a table\n");
+}
+
+static bool parse_options(int argc, char* argv[], OPTIONS& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+		const bool has_value = i + 1 < argc;
+		if (arg == "--ring") options.ring = true;
+		else if (arg == "--slave") options.slave = true;
+		else if (arg == "--bench") options.bench = true;
+		else if (arg == "--frames" && has_value) options.frame_rate = atoi(argv[++i]);
+		else if (arg == "--feedback" && has_value) options.feedback_rate = atoi(argv[++i]);
+		else if (arg == "--duration" && has_value) options.duration_s = atoi(argv[++i]);
+		else if (arg == "--burst" && has_value) options.burst_percent = atoi(argv[++i]);
+		else if (arg == "--burst-size" && has_value) options.burst_size = atoi(argv[++i]);
+		else if (arg == "--message-size" && has_value) options.message_size = atoi(argv[++i]);
+		else if (arg == "--seed" && has_value) options.seed = atoi(argv[++i]);
+		else
+		{
+			LOG("Unknown option '%s'\n", arg.c_str());
+			return false;
+		}
+	}
+	if (options.message_size < sizeof(SLAVE_MESSAGE))
+	{
+		LOG("Message size must be at least %d\n", (int)sizeof(SLAVE_MESSAGE));
+		return false;
+	}
+	return true;
+}
+
+static boost::posix_time::ptime in_ms(unsigned int milliseconds)
+{
+	return boost::posix_time::microsec_clock::universal_time() + boost::posix_time::milliseconds(milliseconds);
+}
+
+// sleeping is too coarse for thousands of frames per second, so only sleep when the deadline is far enough.
+static void wait_until(uint64_t deadline_us)
+{
+	while (true)
+	{
+		const uint64_t now = FrameStats::now_us();
+		if (now >= deadline_us)
+		{
+			return;
+		}
+		if (deadline_us - now > 2000)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+static void remove_queues()
+{
+	message_queue::remove(DMD_DATA_QUEUE_NAME);
+	message_queue::remove(MASTER_TO_SLAVE_QUEUE_NAME);
+	message_queue::remove(SLAVE_TO_MASTER_QUEUE_NAME);
+	FrameRing::remove(DMD_DATA_RING_NAME);
+}
+
+static void toggle_random_field(FEEDBACK_MESSAGE_DATA& feedback_data, std::mt19937& random)
+{
+	const unsigned int field = random() % MAX_FEEDBACK_EVENTS;
+	if (field < NUM_FLASHERS)
+	{
+		feedback_data.flasher_intensity[field] = (random() % 101) / 100.0f;
+	}
+	else
+	{
+		s32& value = ((s32*)&feedback_data)[field];
+		value = !value;
+	}
+}
+
+// Creates the queues, calls the given function so a slave can connect, then sends until the duration is over.
+template<typename OnCreated>
+static bool run_master(const OPTIONS& options, MASTER_REPORT& report, OnCreated on_created)
+{
+	remove_queues();
+
+	try
+	{
+		message_queue data_queue(create_only, DMD_DATA_QUEUE_NAME, DATA_QUEUE_CAPACITY, DMD_FRAME_SIZE);
+		message_queue master_to_slave_queue(create_only, MASTER_TO_SLAVE_QUEUE_NAME, CONTROL_QUEUE_CAPACITY, options.message_size);
+		message_queue slave_to_master_queue(create_only, SLAVE_TO_MASTER_QUEUE_NAME, CONTROL_QUEUE_CAPACITY, options.message_size);
+		FrameRing* frame_ring = options.ring ? FrameRing::create(DMD_DATA_RING_NAME) : nullptr;
+		if (options.ring && !frame_ring)
+		{
+			return false;
+		}
+
+		on_created();
+
+		std::vector<unsigned char> message_buffer(options.message_size);
+		SLAVE_MESSAGE* message = (SLAVE_MESSAGE*)message_buffer.data();
+		unsigned int priority;
+		message_queue::size_type received_size;
+
+		if (!slave_to_master_queue.timed_receive(message, options.message_size, received_size, priority, in_ms(options.ready_timeout_s * 1000)))
+		{
+			LOG("No slave showed up within %d seconds.\n", options.ready_timeout_s);
+			delete frame_ring;
+			return false;
+		}
+		if (received_size != options.message_size || message->message_type != MESSAGE_TYPE_SLAVE_READY)
+		{
+			LOG("Expected a slave ready message, got type %d with size %d.\n", message->message_type, (int)received_size);
+			delete frame_ring;
+			return false;
+		}
+
+		std::mt19937 random(options.seed);
+		std::vector<unsigned char> frame(DMD_FRAME_SIZE);
+		for (unsigned int pixel = 0; pixel < DMD_FRAME_SIZE; pixel++)
+		{
+			frame[pixel] = pixel % 4;
+		}
+		memset(message, 0, options.message_size);
+		message->message_type = MESSAGE_TYPE_FEEDBACK;
+
+		const uint64_t started_at = FrameStats::now_us();
+		const uint64_t ends_at = started_at + (uint64_t)options.duration_s * 1000000;
+		const uint64_t frame_interval = options.frame_rate ? 1000000 / options.frame_rate : 0;
+		const uint64_t feedback_interval = options.feedback_rate ? 1000000 / options.feedback_rate : 0;
+		uint64_t next_frame_at = frame_interval ? started_at : UINT64_MAX;
+		uint64_t next_feedback_at = feedback_interval ? started_at : UINT64_MAX;
+
+		while (true)
+		{
+			const uint64_t next_at = next_frame_at < next_feedback_at ? next_frame_at : next_feedback_at;
+			if (next_at >= ends_at)
+			{
+				break;
+			}
+			wait_until(next_at);
+
+			if (next_at == next_frame_at)
+			{
+				const bool burst = options.burst_percent && random() % 100 < options.burst_percent;
+				const unsigned int frame_count = burst ? options.burst_size : 1;
+
+				for (unsigned int frame_index = 0; frame_index < frame_count; frame_index++)
+				{
+					FRAME_STAMP stamp = { report.frames_sent + report.frames_dropped + 1, FrameStats::now_us() };
+					memcpy(frame.data(), &stamp, sizeof(stamp));
+
+					if (frame_ring)
+					{
+						frame_ring->publish(frame.data());
+						report.frames_sent++;
+					}
+					else if (data_queue.try_send(frame.data(), DMD_FRAME_SIZE, DEFAULT_MESSAGE_PRIORITY))
+					{
+						report.frames_sent++;
+					}
+					else
+					{
+						report.frames_dropped++;
+					}
+				}
+				next_frame_at += frame_interval;
+			}
+			else
+			{
+				toggle_random_field(message->message_data.feedback_message_data, random);
+				if (master_to_slave_queue.try_send(message, options.message_size, DEFAULT_MESSAGE_PRIORITY))
+				{
+					report.feedback_sent++;
+				}
+				else
+				{
+					report.feedback_dropped++;
+				}
+				next_feedback_at += feedback_interval;
+			}
+		}
+		report.elapsed_s = (FrameStats::now_us() - started_at) / 1000000.0;
+
+		message->message_type = MESSAGE_TYPE_END;
+		if (!master_to_slave_queue.timed_send(message, options.message_size, DEFAULT_MESSAGE_PRIORITY, in_ms(5000)))
+		{
+			LOG("Slave isn't reading control messages, couldn't send end message.\n");
+		}
+
+		delete frame_ring;
+	}
+	catch (interprocess_exception &exception)
+	{
+		LOG("Master error: %s\n", exception.what());
+		remove_queues();
+		return false;
+	}
+
+	remove_queues();
+	return true;
+}
+
+// Receives frames the same way ProPinballDmd::GetFrames does, but measures instead of rendering.
+static bool run_slave(const OPTIONS& options, SLAVE_REPORT& report)
+{
+	message_queue* data_queue = nullptr;
+	message_queue* master_to_slave_queue = nullptr;
+	FrameRing* frame_ring = nullptr;
+	bool ok = true;
+
+	try
+	{
+		frame_ring = FrameRing::open(DMD_DATA_RING_NAME);
+		if (!frame_ring)
+		{
+			data_queue = new message_queue(open_only, DMD_DATA_QUEUE_NAME);
+		}
+		master_to_slave_queue = new message_queue(open_only, MASTER_TO_SLAVE_QUEUE_NAME);
+		message_queue slave_to_master_queue(open_only, SLAVE_TO_MASTER_QUEUE_NAME);
+
+		std::vector<unsigned char> message_buffer(options.message_size);
+		SLAVE_MESSAGE* message = (SLAVE_MESSAGE*)message_buffer.data();
+		message->message_type = MESSAGE_TYPE_SLAVE_READY;
+		slave_to_master_queue.send(message, options.message_size, DEFAULT_MESSAGE_PRIORITY);
+	}
+	catch (interprocess_exception &exception)
+	{
+		LOG("Slave couldn't connect: %s\n", exception.what());
+		delete frame_ring;
+		delete data_queue;
+		delete master_to_slave_queue;
+		return false;
+	}
+
+	FrameStats frame_stats;
+	FeedbackDiff feedback_diff;
+	FEEDBACK_EVENT feedback_events[MAX_FEEDBACK_EVENTS];
+	std::vector<unsigned char> frame_buffer(DMD_FRAME_SIZE);
+	std::vector<unsigned char> message_buffer(options.message_size);
+	SLAVE_MESSAGE* message = (SLAVE_MESSAGE*)message_buffer.data();
+	uint64_t last_sequence = 0;
+	bool done = false;
+
+	ControlListener* control_listener = new ControlListener(master_to_slave_queue, options.message_size, frame_ring, data_queue);
+
+	auto on_frame = [&](const FRAME_STAMP& stamp, uint64_t received_at, uint64_t queue_depth)
+	{
+		frame_stats.frame_received(received_at, received_at > stamp.sent_at_us ? received_at - stamp.sent_at_us : 0, queue_depth);
+		if (last_sequence && stamp.sequence > last_sequence + 1)
+		{
+			report.gaps += stamp.sequence - last_sequence - 1;
+		}
+		last_sequence = stamp.sequence;
+		frame_stats.callback_finished(received_at);
+	};
+
+	while (!done)
+	{
+		if (frame_ring)
+		{
+			const unsigned char* frame;
+			uint64_t sequence;
+			const uint64_t dropped = frame_ring->dropped();
+			if (frame_ring->wait_newest(5000, frame, sequence))
+			{
+				const uint64_t skipped = frame_ring->dropped() - dropped;
+
+				// same as the bridge: the consumer copies what it needs straight out of the slot,
+				// then checks that the master didn't overwrite it meanwhile.
+				FRAME_STAMP stamp;
+				memcpy(&stamp, frame, sizeof(stamp));
+				if (frame_ring->is_current(sequence))
+				{
+					frame_stats.woke_up(1, skipped);
+					on_frame(stamp, FrameStats::now_us(), skipped + 1);
+				}
+				else
+				{
+					frame_stats.woke_up(0, skipped);
+					frame_stats.frame_torn();
+				}
+			}
+		}
+		else
+		{
+			try
+			{
+				unsigned int priority;
+				message_queue::size_type received_size;
+				uint64_t frames = 0;
+				bool received_message = data_queue->timed_receive(frame_buffer.data(), DMD_FRAME_SIZE, received_size, priority, in_ms(5000));
+				while (received_message && received_size == DMD_FRAME_SIZE)
+				{
+					FRAME_STAMP stamp;
+					memcpy(&stamp, frame_buffer.data(), sizeof(stamp));
+					on_frame(stamp, FrameStats::now_us(), data_queue->get_num_msg() + 1);
+					frames++;
+					received_message = data_queue->try_receive(frame_buffer.data(), DMD_FRAME_SIZE, received_size, priority);
+				}
+				if (frames)
+				{
+					frame_stats.woke_up(frames, 0);
+				}
+			}
+			catch (interprocess_exception &exception)
+			{
+				LOG("Slave error: %s\n", exception.what());
+				ok = false;
+				done = true;
+			}
+		}
+
+		uint64_t received_at;
+		while (!done && control_listener->next(message_buffer.data(), received_at))
+		{
+			if (message->message_type == MESSAGE_TYPE_END)
+			{
+				done = true;
+			}
+			else if (message->message_type == MESSAGE_TYPE_FEEDBACK)
+			{
+				report.feedback_events += feedback_diff.diff(&message->message_data.feedback_message_data, received_at, feedback_events);
+			}
+		}
+		if (!done && control_listener->error())
+		{
+			LOG("Slave error: %s\n", control_listener->error());
+			ok = false;
+			done = true;
+		}
+	}
+
+	delete control_listener;
+	delete frame_ring;
+	delete data_queue;
+	delete master_to_slave_queue;
+
+	frame_stats.snapshot(report.stats);
+	report.ok = ok;
+	return ok;
+}
+
+static void print_percentiles(const char* name, const FRAME_STATS_PERCENTILES& percentiles, const char* unit)
+{
+	if (!percentiles.count)
+	{
+		LOG("  %-16s n/a\n", name);
+		return;
+	}
+	LOG("  %-16s p50 %llu%s, p99 %llu%s, max %llu%s\n", name,
+		(unsigned long long)percentiles.p50, unit, (unsigned long long)percentiles.p99, unit, (unsigned long long)percentiles.max, unit);
+}
+
+static void print_master_report(const MASTER_REPORT& report)
+{
+	LOG("Master: %llu frames sent, %llu dropped (queue full), %llu feedback messages sent, %llu dropped, in %.2fs.\n",
+		(unsigned long long)report.frames_sent, (unsigned long long)report.frames_dropped,
+		(unsigned long long)report.feedback_sent, (unsigned long long)report.feedback_dropped, report.elapsed_s);
+}
+
+static void print_slave_report(const SLAVE_REPORT& report)
+{
+	LOG("Slave: %llu frames received, %llu missing, %llu skipped in ring, %llu torn, %llu feedback events.\n",
+		(unsigned long long)report.stats.frames, (unsigned long long)report.gaps, (unsigned long long)report.stats.dropped,
+		(unsigned long long)report.stats.torn, (unsigned long long)report.feedback_events);
+	print_percentiles("Latency", report.stats.age_us, "us");
+	print_percentiles("Interval", report.stats.interval_us, "us");
+	print_percentiles("Queue depth", report.stats.queue_depth, "");
+	print_percentiles("Frames/wake-up", report.stats.frames_per_wakeup, "");
+}
+
+// runs master and slave in the same process, each on its own thread.
+static bool run_both(const OPTIONS& options, MASTER_REPORT& master_report, SLAVE_REPORT& slave_report)
+{
+	std::thread slave;
+	const bool ok = run_master(options, master_report, [&]()
+	{
+		slave = std::thread([&]() { run_slave(options, slave_report); });
+	});
+	if (slave.joinable())
+	{
+		slave.join();
+	}
+	return ok && slave_report.ok;
+}
+
+static int run_bench(OPTIONS options)
+{
+	const unsigned int RATES[] = { 60, 240, 1000, 4000 };
+
+	LOG("%-6s %5s %9s %9s %9s %9s %9s %9s %9s %9s\n", "mode", "hz", "sent", "dropped", "received", "missing", "lat p50", "lat p99", "lat max", "per wake");
+	for (int ring = 0; ring <= 1; ring++)
+	{
+		for (unsigned int rate : RATES)
+		{
+			options.ring = ring != 0;
+			options.frame_rate = rate;
+			MASTER_REPORT master_report;
+			SLAVE_REPORT slave_report;
+			if (!run_both(options, master_report, slave_report))
+			{
+				LOG("Run at %d Hz failed.\n", rate);
+				return 1;
+			}
+			const FRAME_STATS_SNAPSHOT& stats = slave_report.stats;
+			LOG("%-6s %5u %9llu %9llu %9llu %9llu %7lluus %7lluus %7lluus %9llu\n", options.ring ? "ring" : "queue", rate,
+				(unsigned long long)master_report.frames_sent, (unsigned long long)master_report.frames_dropped,
+				(unsigned long long)stats.frames, (unsigned long long)slave_report.gaps,
+				(unsigned long long)stats.age_us.p50, (unsigned long long)stats.age_us.p99, (unsigned long long)stats.age_us.max,
+				(unsigned long long)stats.frames_per_wakeup.p99);
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	OPTIONS options;
+	if (!parse_options(argc, argv, options))
+	{
+		print_usage();
+		return 1;
+	}
+
+	if (options.bench)
+	{
+		return run_bench(options);
+	}
+
+	if (options.slave)
+	{
+		SLAVE_REPORT slave_report;
+		const bool ok = run_slave(options, slave_report);
+		print_slave_report(slave_report);
+		return ok ? 0 : 1;
+	}
+
+	MASTER_REPORT master_report;
+	const bool ok = run_master(options, master_report, []()
+	{
+		LOG("Waiting for a slave to connect...\n");
+	});
+	print_master_report(master_report);
+	return ok ? 0 : 1;
+}
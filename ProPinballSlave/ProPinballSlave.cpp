@@ -3,6 +3,11 @@
 
 #include "stdafx.h"
 #include "boost/interprocess/ipc/message_queue.hpp"
+#include "../ProPinballBridge/ProPinballProtocol.h"
+#include "../ProPinballBridge/FeedbackDiff.h"
+#if BUILD_DMD_SLAVE
+#include "../ProPinballBridge/ControlListener.h"
+#endif
 
 using namespace boost::interprocess;
 
@@ -15,95 +20,6 @@ const char* SLAVE_TO_MASTER_MESSAGE_QUEUE_NAME = "feedback_slave_to_master";
 const char* MASTER_TO_SLAVE_MESSAGE_QUEUE_NAME = "feedback_master_to_slave";
 #endif
 
-typedef int32_t s32;
-typedef float f32;
-
-enum MESSAGE_TYPE
-{
-	MESSAGE_TYPE_SLAVE_READY,
-	MESSAGE_TYPE_END,
-	MESSAGE_TYPE_FEEDBACK
-};
-
-enum SOLENOID_ID
-{
-	SO_PLUNGER = 0,
-	SO_TROUGH_EJECT,
-	SO_KNOCKER,
-	SO_LEFT_SLINGSHOT,
-	SO_RIGHT_SLINGSHOT,
-	SO_LEFT_JET,
-	SO_RIGHT_JET,
-	SO_BOTTOM_JET,
-	SO_LEFT_DROPS_UP,
-	SO_RIGHT_DROPS_UP,
-	SO_LOCK_RELEASE_1,
-	SO_LOCK_RELEASE_2,
-	SO_LOCK_RELEASE_3,
-	SO_LOCK_RELEASE_A,
-	SO_LOCK_RELEASE_B,
-	SO_LOCK_RELEASE_C,
-	SO_LOCK_RELEASE_D,
-	SO_MIDDLE_EJECT,
-	SO_TOP_EJECT_STRONG,
-	SO_TOP_EJECT_WEAK,
-	SO_MIDDLE_RAMP_DOWN,
-	SO_HIGH_DIVERTOR,
-	SO_LOW_DIVERTOR,
-	SO_SCOOP_RETRACT,
-	SO_MAGNO_SAVE,
-	SO_MAGNO_LOCK,
-	NUM_SOLENOIDS
-};
-
-enum FLASHER_ID
-{
-	FL_LEFT_RETURN_LANE = 0,
-	FL_RIGHT_RETURN_LANE,
-	FL_TIME_MACHINE,
-	FL_LOCK_ALPHA,
-	FL_LOCK_BETA,
-	FL_LOCK_GAMMA,
-	FL_LOCK_DELTA,
-	FL_CRYSTAL,
-	NUM_FLASHERS
-};
-
-enum FLIPPER_ID
-{
-	FLIP_LOW_LEFT = 0,
-	FLIP_LOW_RIGHT,
-	FLIP_HIGH_RIGHT,
-	NUM_FLIPPERS
-};
-
-enum BUTTON_ID
-{
-	BUTTON_ID_START,
-	BUTTON_ID_FIRE,
-	BUTTON_ID_MAGNOSAVE,
-	NUM_BUTTONS
-};
-
-struct FEEDBACK_MESSAGE_DATA
-{
-	f32 flasher_intensity[NUM_FLASHERS];
-	s32 solenoid_on[NUM_SOLENOIDS];
-	s32 flipper_solenoid_on[NUM_FLIPPERS];
-	s32 button_lit[NUM_BUTTONS];
-};
-
-struct SLAVE_MESSAGE
-{
-	s32 message_type;
-	union
-	{
-		FEEDBACK_MESSAGE_DATA feedback_message_data;
-	} message_data;
-};
-
-const int DEFAULT_MESSAGE_PRIORITY = 0;
-
 #define LOG printf
 
 const char* SOLENOID_NAME[NUM_SOLENOIDS] =
@@ -182,41 +98,48 @@ boost::interprocess::message_queue* open_message_queue(const std::string& messag
 
 void handle_feedback(const FEEDBACK_MESSAGE_DATA* feedback_data)
 {
-	static FEEDBACK_MESSAGE_DATA previous_feedback_data;
+	static ProPinballBridge::FeedbackDiff feedback_diff;
+	ProPinballBridge::FEEDBACK_EVENT events[ProPinballBridge::MAX_FEEDBACK_EVENTS];
+
+	// the log doesn't say when things happened, so there's no need for a timestamp.
+	const unsigned int event_count = feedback_diff.diff(feedback_data, 0, events);
 
-	for (int flasher_index = 0; flasher_index < NUM_FLASHERS; flasher_index++)
+	for (unsigned int event_index = 0; event_index < event_count; event_index++)
 	{
-		if (feedback_data->flasher_intensity[flasher_index] != previous_feedback_data.flasher_intensity[flasher_index])
+		const ProPinballBridge::FEEDBACK_EVENT& event = events[event_index];
+		switch (event.kind)
 		{
-			LOG("Flasher %s: %f\n", FLASHER_NAME[flasher_index], feedback_data->flasher_intensity[flasher_index]);
+			case ProPinballBridge::FEEDBACK_KIND_FLASHER:
+				LOG("Flasher %s: %f\n", FLASHER_NAME[event.id], event.value);
+				break;
+			case ProPinballBridge::FEEDBACK_KIND_SOLENOID:
+				LOG("Solenoid %s: %s\n", SOLENOID_NAME[event.id], event.value ? "ON" : "OFF");
+				break;
+			case ProPinballBridge::FEEDBACK_KIND_FLIPPER:
+				LOG("Flipper %s: %s\n", FLIPPER_NAME[event.id], event.value ? "ON" : "OFF");
+				break;
+			case ProPinballBridge::FEEDBACK_KIND_BUTTON:
+				LOG("Button light %s: %s\n", BUTTON_NAME[event.id], event.value ? "ON" : "OFF");
+				break;
 		}
 	}
+}
 
-	for (int solenoid_index = 0; solenoid_index < NUM_SOLENOIDS; solenoid_index++)
+void handle_message(const SLAVE_MESSAGE* message, bool& done)
+{
+	if (message->message_type == MESSAGE_TYPE_END)
 	{
-		if (feedback_data->solenoid_on[solenoid_index] != previous_feedback_data.solenoid_on[solenoid_index])
-		{
-			LOG("Solenoid %s: %s\n", SOLENOID_NAME[solenoid_index], feedback_data->solenoid_on[solenoid_index] ? "ON" : "OFF");
-		}
+		LOG("Received end message\n");
+		done = true;
 	}
-
-	for (int flipper_index = 0; flipper_index < NUM_FLIPPERS; flipper_index++)
+	else if (message->message_type == MESSAGE_TYPE_FEEDBACK)
 	{
-		if (feedback_data->flipper_solenoid_on[flipper_index] != previous_feedback_data.flipper_solenoid_on[flipper_index])
-		{
-			LOG("Flipper %s: %s\n", FLIPPER_NAME[flipper_index], feedback_data->flipper_solenoid_on[flipper_index] ? "ON" : "OFF");
-		}
+		handle_feedback(&(message->message_data.feedback_message_data));
 	}
-
-	for (int button_index = 0; button_index < NUM_BUTTONS; button_index++)
+	else
 	{
-		if (feedback_data->button_lit[button_index] != previous_feedback_data.button_lit[button_index])
-		{
-			LOG("Button light %s: %s\n", BUTTON_NAME[button_index], feedback_data->button_lit[button_index] ? "ON" : "OFF");
-		}
+		LOG("Received message %d\n", message->message_type);
 	}
-
-	previous_feedback_data = *feedback_data;
 }
 
 int main(int argc, char* argv[])
@@ -273,6 +196,10 @@ int main(int argc, char* argv[])
 	const int DOT_MATRIX_DATA_MESSAGE_SIZE = DOT_MATRIX_WIDTH*DOT_MATRIX_HEIGHT;
 
 	unsigned char* dot_matrix_data_message_buffer = new unsigned char[DOT_MATRIX_DATA_MESSAGE_SIZE];
+
+	// control messages are received on their own thread, which wakes up the wait on the data queue when one
+	// arrives. so the loop only ever blocks on the data queue, same as the bridge, and nothing is polled.
+	ProPinballBridge::ControlListener control_listener(master_to_slave_message_queue, general_message_size, nullptr, dot_matrix_display_data_message_queue);
 #endif
 
 	bool done = false;
@@ -280,96 +207,81 @@ int main(int argc, char* argv[])
 	while (!done)
 	{
 #if BUILD_DMD_SLAVE
-		if (dot_matrix_display_data_message_queue)
+		try
 		{
-			bool received_message = false;
+			unsigned int priority;
+			message_queue::size_type received_size;
+
+			// frames and control messages wake us up, so this only bounds how long a lost wake-up can stall the loop.
+			const boost::posix_time::ptime wait_time = microsec_clock::universal_time() + boost::posix_time::milliseconds(5000);
+
+			bool received_message = dot_matrix_display_data_message_queue->timed_receive(dot_matrix_data_message_buffer,
+				DOT_MATRIX_DATA_MESSAGE_SIZE,
+				received_size,
+				priority,
+				wait_time);
 
-			do
+			if (received_message && received_size != ProPinballBridge::WAKE_UP_MESSAGE_SIZE)
 			{
-				try
+				if (received_size == DOT_MATRIX_DATA_MESSAGE_SIZE)
 				{
-					unsigned int priority;
-					message_queue::size_type received_size;
-
-					const boost::posix_time::ptime wait_time = microsec_clock::universal_time() + boost::posix_time::milliseconds(500);
-
-					received_message = dot_matrix_display_data_message_queue->timed_receive(dot_matrix_data_message_buffer,
-						DOT_MATRIX_DATA_MESSAGE_SIZE,
-						received_size,
-						priority,
-						wait_time);
-
-					if (received_message)
-					{
-						if (received_size == DOT_MATRIX_DATA_MESSAGE_SIZE)
-						{
-							LOG("Received dmd data message!\n");
-						}
-						else
-						{
-							LOG("Received dmd data message size %d, but expecting size %d\n", (int)received_size, DOT_MATRIX_DATA_MESSAGE_SIZE);
-						}
-					}
+					LOG("Received dmd data message!\n");
 				}
-				catch (interprocess_exception &exception)
+				else
 				{
-					LOG("Error receiving dot matrix display data message: '%s'\n", exception.what());
+					LOG("Received dmd data message size %d, but expecting size %d\n", (int)received_size, DOT_MATRIX_DATA_MESSAGE_SIZE);
 				}
-			} while (received_message);
+			}
+		}
+		catch (interprocess_exception &exception)
+		{
+			LOG("Error receiving dot matrix display data message: '%s'\n", exception.what());
+		}
+
+		uint64_t received_at;
+		while (!done && control_listener.next(general_message_buffer, received_at))
+		{
+			handle_message(message, done);
 		}
-#endif
 
-		if (master_to_slave_message_queue)
+		const char* error = control_listener.error();
+		if (!done && error)
+		{
+			LOG("Error receiving message: '%s'\n", error);
+			done = true;
+		}
+#else
+		try
 		{
-			bool received_message = false;
+			unsigned int priority;
+			message_queue::size_type received_size;
+
+			// nothing else to wait for, so block until the master sends something.
+			const boost::posix_time::ptime wait_time = microsec_clock::universal_time() + boost::posix_time::milliseconds(500);
 
-			do
+			bool received_message = master_to_slave_message_queue->timed_receive(general_message_buffer,
+				general_message_size,
+				received_size,
+				priority,
+				wait_time);
+
+			if (received_message)
 			{
-				try
+				if (received_size == general_message_size)
 				{
-					unsigned int priority;
-					message_queue::size_type received_size;
-
-					received_message = master_to_slave_message_queue->try_receive(general_message_buffer,
-						general_message_size,
-						received_size,
-						priority);
-
-					if (received_message)
-					{
-						if (received_size == general_message_size)
-						{
-							if (message->message_type == MESSAGE_TYPE_END)
-							{
-								LOG("Received end message\n");
-								done = true;
-							}
-							else if (message->message_type == MESSAGE_TYPE_FEEDBACK)
-							{
-								handle_feedback(&(message->message_data.feedback_message_data));
-							}
-							else
-							{
-								LOG("Received message %d\n", message->message_type);
-							}
-						}
-						else
-						{
-							LOG("Received message size %d, but expecting size %d\n", (int)received_size, general_message_size);
-						}
-					}
+					handle_message(message, done);
 				}
-				catch (interprocess_exception &exception)
+				else
 				{
-					LOG("Error receiving message: '%s'\n", exception.what());
+					LOG("Received message size %d, but expecting size %d\n", (int)received_size, general_message_size);
 				}
-			} while (received_message);
+			}
 		}
-/*
-#if !BUILD_DMD_SLAVE
-		const DWORD SLEEP_TIME_MILLI_SECONDS = 5;
-		Sleep(SLEEP_TIME_MILLI_SECONDS);
-#endif*/
+		catch (interprocess_exception &exception)
+		{
+			LOG("Error receiving message: '%s'\n", exception.what());
+		}
+#endif
 	}
 
 	return 0;